@@ -39,7 +39,8 @@ void setup() {
 }
 
 void loop() {
-    delay(500);
+    // Sleep until the next sensor is due for an update
+    delay(sensorManager.nextWakeupMs());
     /*
     Data retrieval:
 
@@ -0,0 +1,386 @@
+/*
+ * Microbenchmarks of the SensorManager acquisition cycle on the host build.
+ *
+ * For 1 to N simulated sensors, the stages of the acquisition cycle are timed
+ * separately:
+ *   - SensorManager::executeSensorCommunication()
+ *   - SensorManager::getSensorReadings()
+ *   - SensorManager::getSensorFrame()
+ *   - SensorManager::encodeSensorReadings(), binary and JSON
+ *   - SensorManager::refreshAndGetSensorReadings()
+ * Reported per call are the CPU time spent in the library (driver delays and
+ * bus transfers run on the simulated clock and cost no CPU time), the number
+ * of heap allocations, the number of I2C transactions and the simulated time
+ * the call occupied the bus including driver waits.
+ *
+ * Results are written as CSV to stdout. Passing a previous output with
+ * --baseline compares against it and exits with status 1 on regressions.
+ *
+ * --record writes the I2C traffic of the run to a trace file. --replay runs
+ * against such a trace instead of the simulated sensors, which requires the
+ * same --calls and --max-sensors as the recording, and exits with status 1
+ * if the library deviates from the recorded traffic.
+ *
+ * --profile writes the bus traffic of each run per address, including the
+ * detection and initialization, and the bus occupancy to a report file.
+ *
+ * Usage: benchmark [--calls N] [--max-sensors N] [--baseline FILE]
+ *                  [--tolerance FRACTION] [--record FILE | --replay FILE]
+ *                  [--profile FILE]
+ */
+
+#include "Sensirion_upt_i2c_auto_detection.h"
+#include "BusProfiler.h"
+#include "DefaultDriverConfig.h"
+#include "I2cTrace.h"
+#include "VirtualBoard.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace sensirion::upt::i2c_autodetect;
+
+namespace {
+
+std::atomic<uint64_t> gAllocations{0};
+
+void* countedAllocation(size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return countedAllocation(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAllocation(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+/* Simulated time between two iterations of the application loop */
+constexpr uint64_t LOOP_PERIOD_US = 100 * 1000;
+
+/* Simulated time after which all sensors have finished initialization */
+constexpr uint64_t WARM_UP_US = 15 * 1000 * 1000;
+
+struct Result {
+    std::string operation;
+    size_t numSensors = 0;
+    size_t calls = 0;
+    double cpuNsMean = 0;
+    double cpuNsMax = 0;
+    double allocationsPerCall = 0;
+    double transactionsPerCall = 0;
+    double busTimeUsPerCall = 0;
+};
+
+uint64_t threadCpuTimeNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(ts.tv_nsec);
+}
+
+template <typename F>
+Result measure(const char* operation, const size_t numSensors,
+               const size_t calls, TwoWire& bus, F&& call) {
+    Result result;
+    result.operation = operation;
+    result.numSensors = numSensors;
+    result.calls = calls;
+
+    uint64_t cpuNsTotal = 0;
+    uint64_t cpuNsMax = 0;
+    uint64_t allocations = 0;
+    uint64_t transactions = 0;
+    uint64_t busTimeUs = 0;
+    for (size_t i = 0; i < calls; ++i) {
+        host::advanceMicros(LOOP_PERIOD_US);
+        bus.resetStatistics();
+        const uint64_t allocationsBefore = gAllocations.load();
+        const uint64_t simulatedUsBefore = host::nowMicros();
+        const uint64_t cpuNsBefore = threadCpuTimeNs();
+
+        call();
+
+        const uint64_t cpuNs = threadCpuTimeNs() - cpuNsBefore;
+        busTimeUs += host::nowMicros() - simulatedUsBefore;
+        allocations += gAllocations.load() - allocationsBefore;
+        transactions += bus.getStatistics().transactions;
+        cpuNsTotal += cpuNs;
+        cpuNsMax = std::max(cpuNsMax, cpuNs);
+    }
+    const double n = static_cast<double>(calls);
+    result.cpuNsMean = static_cast<double>(cpuNsTotal) / n;
+    result.cpuNsMax = static_cast<double>(cpuNsMax);
+    result.allocationsPerCall = static_cast<double>(allocations) / n;
+    result.transactionsPerCall = static_cast<double>(transactions) / n;
+    result.busTimeUsPerCall = static_cast<double>(busTimeUs) / n;
+    return result;
+}
+
+std::vector<Result> runSuite(const size_t numSensors, const size_t calls,
+                             TwoWire& bus) {
+    host::resetClock();
+    host::VirtualBoard board(Wire);
+    board.connectSensors(numSensors);
+    DefaultI2cDetector detector(bus);
+    SensorManager manager(detector);
+    const SensorManager::MeasurementList*
+        readings[DefaultI2cDetector::CONFIGURED_SENSORS] = {nullptr};
+    static SensorFrame<DefaultI2cDetector::CONFIGURED_SENSORS> frame;
+    static uint8_t batch[1024];
+    static char text[8192];
+
+    // Bring all sensors to the RUNNING state
+    manager.refreshConnectedSensors();
+    while (host::nowMicros() < WARM_UP_US) {
+        host::advanceMicros(LOOP_PERIOD_US);
+        manager.executeSensorCommunication();
+    }
+
+    std::vector<Result> results;
+    results.push_back(
+        measure("executeSensorCommunication", numSensors, calls, bus,
+                [&manager]() { manager.executeSensorCommunication(); }));
+    results.push_back(
+        measure("getSensorReadings", numSensors, calls, bus,
+                [&manager, &readings]() {
+                    manager.getSensorReadings(readings);
+                }));
+    results.push_back(measure("getSensorFrame", numSensors, calls, bus,
+                              [&manager]() { manager.getSensorFrame(frame); }));
+    results.push_back(
+        measure("encodeSensorReadings", numSensors, calls, bus, [&manager]() {
+            manager.encodeSensorReadings(batch, sizeof(batch));
+        }));
+    results.push_back(measure(
+        "encodeSensorReadingsJson", numSensors, calls, bus, [&manager]() {
+            TextEncoder encoder(TextFormat::JSON, text, sizeof(text));
+            manager.encodeSensorReadings(encoder);
+        }));
+    results.push_back(
+        measure("refreshAndGetSensorReadings", numSensors, calls, bus,
+                [&manager, &readings]() {
+                    manager.refreshAndGetSensorReadings(readings);
+                }));
+    return results;
+}
+
+void printResults(const std::vector<Result>& results) {
+    std::printf("operation,sensors,calls,cpu_ns_mean,cpu_ns_max,"
+                "allocations_per_call,i2c_transactions_per_call,"
+                "bus_time_us_per_call\n");
+    for (const auto& r : results) {
+        std::printf("%s,%zu,%zu,%.1f,%.1f,%.3f,%.3f,%.1f\n",
+                    r.operation.c_str(), r.numSensors, r.calls, r.cpuNsMean,
+                    r.cpuNsMax, r.allocationsPerCall, r.transactionsPerCall,
+                    r.busTimeUsPerCall);
+    }
+}
+
+std::map<std::pair<std::string, size_t>, Result>
+readBaseline(const char* path) {
+    std::map<std::pair<std::string, size_t>, Result> baseline;
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);  // header
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        Result r;
+        std::string field;
+        std::getline(ss, r.operation, ',');
+        std::getline(ss, field, ',');
+        r.numSensors = std::stoul(field);
+        std::getline(ss, field, ',');
+        r.calls = std::stoul(field);
+        std::getline(ss, field, ',');
+        r.cpuNsMean = std::stod(field);
+        std::getline(ss, field, ',');
+        r.cpuNsMax = std::stod(field);
+        std::getline(ss, field, ',');
+        r.allocationsPerCall = std::stod(field);
+        std::getline(ss, field, ',');
+        r.transactionsPerCall = std::stod(field);
+        std::getline(ss, field, ',');
+        r.busTimeUsPerCall = std::stod(field);
+        baseline[{r.operation, r.numSensors}] = r;
+    }
+    return baseline;
+}
+
+/* Returns the number of regressions found */
+int compareWithBaseline(const std::vector<Result>& results,
+                        const char* baselinePath, const double tolerance) {
+    const auto baseline = readBaseline(baselinePath);
+    int regressions = 0;
+    for (const auto& r : results) {
+        const auto it = baseline.find({r.operation, r.numSensors});
+        if (it == baseline.end()) {
+            continue;
+        }
+        const Result& b = it->second;
+        if (r.cpuNsMean > b.cpuNsMean * (1.0 + tolerance)) {
+            std::fprintf(stderr, "REGRESSION %s/%zu: cpu %.1f ns > %.1f ns\n",
+                         r.operation.c_str(), r.numSensors, r.cpuNsMean,
+                         b.cpuNsMean);
+            regressions++;
+        }
+        if (r.allocationsPerCall > b.allocationsPerCall + 1e-3) {
+            std::fprintf(stderr, "REGRESSION %s/%zu: %.3f > %.3f allocations\n",
+                         r.operation.c_str(), r.numSensors,
+                         r.allocationsPerCall, b.allocationsPerCall);
+            regressions++;
+        }
+        if (r.transactionsPerCall > b.transactionsPerCall + 1e-3) {
+            std::fprintf(stderr,
+                         "REGRESSION %s/%zu: %.3f > %.3f I2C transactions\n",
+                         r.operation.c_str(), r.numSensors,
+                         r.transactionsPerCall, b.transactionsPerCall);
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t calls = 1000;
+    size_t maxSensors = host::VirtualBoard::sensorCount();
+    const char* baselinePath = nullptr;
+    double tolerance = 0.25;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* profilePath = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        if (option == "--calls") {
+            calls = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (option == "--max-sensors") {
+            maxSensors = std::min<size_t>(
+                std::strtoul(argv[i + 1], nullptr, 10), maxSensors);
+        } else if (option == "--baseline") {
+            baselinePath = argv[i + 1];
+        } else if (option == "--tolerance") {
+            tolerance = std::strtod(argv[i + 1], nullptr);
+        } else if (option == "--record") {
+            recordPath = argv[i + 1];
+        } else if (option == "--replay") {
+            replayPath = argv[i + 1];
+        } else if (option == "--profile") {
+            profilePath = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return 2;
+        }
+    }
+    if (calls == 0) {
+        calls = 1;
+    }
+
+    host::RecordingWire recorder(Wire);
+    host::ReplayWire replay;
+    TwoWire* bus = &Wire;
+    if (recordPath) {
+        if (!recorder.open(recordPath)) {
+            std::fprintf(stderr, "Cannot create %s\n", recordPath);
+            return 2;
+        }
+        bus = &recorder;
+    } else if (replayPath) {
+        if (!replay.load(replayPath)) {
+            if (!replay.isTruncated()) {
+                std::fprintf(stderr, "Cannot load trace %s\n", replayPath);
+                return 2;
+            }
+            // Replay the transactions recorded before eg. a crash
+            std::fprintf(stderr, "Trace %s is truncated after %zu "
+                         "transactions\n",
+                         replayPath, replay.getNumberOfTransactions());
+        }
+        bus = &replay;
+    }
+
+    host::ProfilingWire profiler(*bus);
+    FILE* profile = nullptr;
+    if (profilePath) {
+        profile = std::fopen(profilePath, "w");
+        if (!profile) {
+            std::fprintf(stderr, "Cannot create %s\n", profilePath);
+            return 2;
+        }
+        bus = &profiler;
+    }
+
+    std::vector<Result> results;
+    for (size_t n = 1; n <= maxSensors; ++n) {
+        host::resetClock();
+        profiler.reset();
+        const auto suite = runSuite(n, calls, *bus);
+        results.insert(results.end(), suite.begin(), suite.end());
+        if (profile) {
+            std::fprintf(profile, "%zu sensors\n", n);
+            profiler.writeReport(profile);
+            std::fprintf(profile, "\n");
+        }
+    }
+    printResults(results);
+    recorder.close();
+    if (profile) {
+        std::fclose(profile);
+    }
+
+    if (replayPath) {
+        std::fprintf(stderr,
+                     "Replayed %zu of %zu transactions, %zu mismatches, "
+                     "max time deviation %llu us\n",
+                     replay.getNumberOfReplayedTransactions(),
+                     replay.getNumberOfTransactions(),
+                     replay.getNumberOfMismatches(),
+                     static_cast<unsigned long long>(
+                         replay.getMaxTimeDeviationUs()));
+        if (replay.getNumberOfMismatches() > 0) {
+            return 1;
+        }
+    }
+
+    if (baselinePath &&
+        compareWithBaseline(results, baselinePath, tolerance) > 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "Arduino.h"
+
+#include <cstdarg>
+#include <random>
+
+namespace {
+
+thread_local uint64_t gNowUs = 0;
+thread_local std::mt19937 gRandomEngine{0};
+
+}  // namespace
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+uint64_t nowMicros() {
+    return gNowUs;
+}
+
+void advanceMicros(const uint64_t us) {
+    gNowUs += us;
+}
+
+void resetClock() {
+    gNowUs = 0;
+}
+
+}  // namespace sensirion::upt::i2c_autodetect::host
+
+unsigned long millis() {
+    return static_cast<unsigned long>(gNowUs / 1000);
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(gNowUs);
+}
+
+void delay(const unsigned long ms) {
+    gNowUs += static_cast<uint64_t>(ms) * 1000;
+}
+
+void delayMicroseconds(const unsigned int us) {
+    gNowUs += us;
+}
+
+long random(const long howBig) {
+    if (howBig <= 0) {
+        return 0;
+    }
+    return std::uniform_int_distribution<long>(0, howBig - 1)(gRandomEngine);
+}
+
+long random(const long howSmall, const long howBig) {
+    if (howSmall >= howBig) {
+        return howSmall;
+    }
+    return howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(const unsigned long seed) {
+    gRandomEngine.seed(seed);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::write(const char* str) {
+    if (str == nullptr) {
+        return 0;
+    }
+    return write(reinterpret_cast<const uint8_t*>(str), std::strlen(str));
+}
+
+size_t Print::print(const char* str) {
+    return write(str);
+}
+
+size_t Print::print(const char c) {
+    return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(const int value, const int base) {
+    return print(static_cast<long long>(value), base);
+}
+
+size_t Print::print(const unsigned int value, const int base) {
+    return print(static_cast<unsigned long long>(value), base);
+}
+
+size_t Print::print(const long value, const int base) {
+    return print(static_cast<long long>(value), base);
+}
+
+size_t Print::print(const unsigned long value, const int base) {
+    return print(static_cast<unsigned long long>(value), base);
+}
+
+size_t Print::print(const long long value, const int base) {
+    if (value < 0 && base == DEC) {
+        return print('-') +
+               print(static_cast<unsigned long long>(-(value + 1)) + 1, base);
+    }
+    return print(static_cast<unsigned long long>(value), base);
+}
+
+size_t Print::print(unsigned long long value, const int base) {
+    char buffer[8 * sizeof(value) + 1];
+    char* str = &buffer[sizeof(buffer) - 1];
+    *str = '\0';
+    const unsigned long long radix = base < 2 ? DEC : base;
+    do {
+        const unsigned digit = value % radix;
+        value /= radix;
+        *--str = static_cast<char>(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    } while (value);
+    return write(str);
+}
+
+size_t Print::print(const double value, const int digits) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return write(buffer);
+}
+
+size_t Print::println() {
+    return write("\r\n");
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    const int len = std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len < 0) {
+        return 0;
+    }
+    return write(reinterpret_cast<const uint8_t*>(buffer),
+                 std::min(static_cast<size_t>(len), sizeof(buffer) - 1));
+}
+
+void HardwareSerial::begin(unsigned long) {
+}
+
+size_t HardwareSerial::write(const uint8_t c) {
+    return std::fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, const size_t size) {
+    return std::fwrite(buffer, 1, size, stdout);
+}
+
+int HardwareSerial::available() {
+    return 0;
+}
+
+int HardwareSerial::read() {
+    return -1;
+}
+
+int HardwareSerial::peek() {
+    return -1;
+}
+
+void HardwareSerial::flush() {
+    std::fflush(stdout);
+}
+
+HardwareSerial Serial;
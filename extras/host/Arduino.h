@@ -0,0 +1,146 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+ * Minimal Arduino API for building the library and the Sensirion drivers on a
+ * Linux host. Time is simulated: millis()/micros() report a virtual clock
+ * which only advances through delay(), delayMicroseconds(), bus transfers on
+ * the simulated TwoWire or explicit calls to host::advanceMicros().
+ *
+ * Each thread runs its own simulated clock, such that threads waiting on
+ * different buses do not add up their waiting times. Threads synchronize
+ * their clocks by waiting with delayMicroseconds() for the time reported by
+ * another thread, like they would on real hardware.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/types.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::max;
+using std::min;
+
+#define HEX 16
+#define DEC 10
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+/**
+ * @brief current time of the simulated clock of the calling thread in
+ * microseconds
+ */
+uint64_t nowMicros();
+
+/**
+ * @brief advance the simulated clock
+ *
+ * @param[in] us number of microseconds to skip
+ */
+void advanceMicros(uint64_t us);
+
+/**
+ * @brief reset the simulated clock to zero. Only meant to be used between
+ * independent simulation runs.
+ */
+void resetClock();
+
+}  // namespace sensirion::upt::i2c_autodetect::host
+
+class Print {
+  public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str);
+
+    size_t print(const char* str);
+    size_t print(char c);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(long long value, int base = DEC);
+    size_t print(unsigned long long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    template <typename T> size_t println(T value) {
+        size_t n = print(value);
+        return n + println();
+    }
+    template <typename T> size_t println(T value, int format) {
+        size_t n = print(value, format);
+        return n + println();
+    }
+
+    size_t printf(const char* format, ...)
+        __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {
+    }
+};
+
+/* Serial port of the host program, forwards to stdout */
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    explicit operator bool() const {
+        return true;
+    }
+};
+
+extern HardwareSerial Serial;
+
+/*
+ * ESP-IDF style logging. As on the ESP32 Arduino core the verbosity is chosen
+ * at compile time through CORE_DEBUG_LEVEL (0: none ... 5: verbose).
+ */
+#ifndef CORE_DEBUG_LEVEL
+#define CORE_DEBUG_LEVEL 0
+#endif
+
+#define HOST_LOG(level, letter, tag, format, ...)                              \
+    do {                                                                       \
+        if (CORE_DEBUG_LEVEL >= level) {                                       \
+            std::fprintf(stderr, "[%6lu][" letter "][%s] " format "\n",        \
+                         millis(), tag, ##__VA_ARGS__);                        \
+        }                                                                      \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG(1, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG(2, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG(3, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG(4, "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) HOST_LOG(5, "V", tag, format, ##__VA_ARGS__)
+
+#endif /* HOST_ARDUINO_H */
@@ -0,0 +1,143 @@
+#include "BusProfiler.h"
+#include <algorithm>
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+namespace {
+
+constexpr uint64_t US_PER_SECOND = 1000000;
+
+double percent(const uint64_t partUs, const uint64_t totalUs) {
+    return totalUs > 0 ? 100.0 * static_cast<double>(partUs) /
+                             static_cast<double>(totalUs)
+                       : 0.0;
+}
+
+}  // namespace
+
+ProfilingWire::ProfilingWire(TwoWire& bus)
+    : TwoWire(bus.getBusNum()), mBus(bus) {
+    reset();
+}
+
+void ProfilingWire::reset() {
+    mStartUs = nowMicros();
+    mAddresses.fill(Counters{});
+    mTotal = Counters{};
+    mSeconds.clear();
+    mStatistics = Statistics{};
+}
+
+const ProfilingWire::Counters&
+ProfilingWire::getCounters(const uint8_t address) const {
+    return mAddresses[address & 0x7F];
+}
+
+uint64_t ProfilingWire::getProfiledUs() const {
+    const uint64_t nowUs = nowMicros();
+    return nowUs > mStartUs ? nowUs - mStartUs : 0;
+}
+
+double ProfilingWire::getOccupancyPercent() const {
+    return percent(mTotal.busyUs, getProfiledUs());
+}
+
+double ProfilingWire::getOccupancyPercent(const uint8_t address) const {
+    return percent(getCounters(address).busyUs, getProfiledUs());
+}
+
+double ProfilingWire::getPeakOccupancyPercent() const {
+    uint64_t peakUs = 0;
+    for (const auto& second : mSeconds) {
+        peakUs = std::max(peakUs, second.busyUs);
+    }
+    return percent(peakUs, US_PER_SECOND);
+}
+
+void ProfilingWire::writeReport(FILE* out) const {
+    const uint64_t profiledUs = getProfiledUs();
+    const double seconds =
+        static_cast<double>(profiledUs) / static_cast<double>(US_PER_SECOND);
+    const auto rate = [seconds](const uint32_t count) {
+        return seconds > 0 ? count / seconds : 0.0;
+    };
+
+    std::fprintf(out,
+                 "Bus %u at %lu Hz, %.1f s profiled: occupancy %.2f %%, "
+                 "peak second %.2f %%\n",
+                 getBusNum(), static_cast<unsigned long>(mBus.getClock()),
+                 seconds, getOccupancyPercent(), getPeakOccupancyPercent());
+    std::fprintf(out, "address  transactions/s  nacks/s  written B/s  "
+                      "read B/s  occupancy %%\n");
+    for (size_t address = 0; address < mAddresses.size(); ++address) {
+        const Counters& c = mAddresses[address];
+        if (c.transactions == 0) {
+            continue;
+        }
+        std::fprintf(out, "0x%02zx     %14.2f  %7.2f  %11.1f  %8.1f  %11.3f\n",
+                     address, rate(c.transactions), rate(c.nacks),
+                     rate(c.bytesWritten), rate(c.bytesRead),
+                     percent(c.busyUs, profiledUs));
+    }
+    std::fprintf(out, "total    %14.2f  %7.2f  %11.1f  %8.1f  %11.3f\n",
+                 rate(mTotal.transactions), rate(mTotal.nacks),
+                 rate(mTotal.bytesWritten), rate(mTotal.bytesRead),
+                 percent(mTotal.busyUs, profiledUs));
+}
+
+uint8_t ProfilingWire::writeTransfer(const uint8_t address,
+                                     const uint8_t* data,
+                                     const size_t length) {
+    const uint64_t startUs = nowMicros();
+    mBus.beginTransmission(address);
+    mBus.write(data, length);
+    const uint8_t code = mBus.endTransmission();
+
+    // An address NACK ends the transaction before the data bytes
+    _account(address, startUs, code == 2 ? 0 : length,
+             code == 0 ? length : 0, 0, code != 0);
+    return code;
+}
+
+size_t ProfilingWire::readTransfer(const uint8_t address, uint8_t* data,
+                                   const size_t length) {
+    const uint64_t startUs = nowMicros();
+    const size_t n = mBus.requestFrom(address, length, true);
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = static_cast<uint8_t>(mBus.read());
+    }
+
+    _account(address, startUs, n, 0, n, n == 0);
+    return n;
+}
+
+void ProfilingWire::_account(const uint8_t address, const uint64_t startUs,
+                             const size_t numBytes, const size_t bytesWritten,
+                             const size_t bytesRead, const bool nack) {
+    // Address byte plus data bytes, each 8 bits and an (N)ACK, plus start and
+    // stop conditions
+    const uint64_t bits = 9 * (numBytes + 1) + 2;
+    const uint64_t clockHz = std::max<uint32_t>(mBus.getClock(), 1);
+    const uint64_t busyUs = (bits * US_PER_SECOND + clockHz - 1) / clockHz;
+
+    const size_t second =
+        startUs > mStartUs ? (startUs - mStartUs) / US_PER_SECOND : 0;
+    if (second >= mSeconds.size()) {
+        mSeconds.resize(second + 1);
+    }
+    for (Counters* c : {&mAddresses[address & 0x7F], &mTotal,
+                        &mSeconds[second]}) {
+        c->transactions++;
+        c->nacks += nack ? 1 : 0;
+        c->bytesWritten += bytesWritten;
+        c->bytesRead += bytesRead;
+        c->busyUs += busyUs;
+    }
+
+    mStatistics.transactions++;
+    mStatistics.nacks += nack ? 1 : 0;
+    mStatistics.bytesWritten += bytesWritten;
+    mStatistics.bytesRead += bytesRead;
+}
+
+}  // namespace sensirion::upt::i2c_autodetect::host
@@ -0,0 +1,129 @@
+#ifndef HOST_BUS_PROFILER_H
+#define HOST_BUS_PROFILER_H
+
+#include "Wire.h"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+/*
+ * TwoWire decorator accounting every transaction issued on it, per address
+ * and per second of simulated time: detection probes, the identity reads of
+ * the initialization and the periodic readouts alike. The bus occupancy is
+ * the time the transactions take on the wire at the clock of the decorated
+ * bus (start condition, address byte, data bytes with their (N)ACK, stop
+ * condition), relative to the profiled time. Sensors are detected and read
+ * through the decorator, eg. DefaultI2cDetector detector(profiler).
+ */
+class ProfilingWire : public TwoWire {
+  public:
+    /* Traffic of an address, a second or the whole bus */
+    struct Counters {
+        uint32_t transactions = 0;
+        uint32_t nacks = 0;
+        uint32_t bytesWritten = 0;
+        uint32_t bytesRead = 0;
+        // Time the transactions occupied the bus
+        uint64_t busyUs = 0;
+    };
+
+    explicit ProfilingWire(TwoWire& bus);
+
+    // The configuration applies to the decorated bus
+    bool begin() override {
+        return mBus.begin();
+    }
+    bool begin(int sda, int scl, uint32_t frequency = 0) override {
+        return mBus.begin(sda, scl, frequency);
+    }
+    bool end() override {
+        return mBus.end();
+    }
+    bool setClock(uint32_t frequency) override {
+        return mBus.setClock(frequency);
+    }
+    uint32_t getClock() const override {
+        return mBus.getClock();
+    }
+
+    /**
+     * @brief discard the counters and restart profiling at the current
+     * simulated time
+     */
+    void reset();
+
+    /**
+     * @brief getter method for the traffic to an address since reset()
+     */
+    const Counters& getCounters(uint8_t address) const;
+
+    /**
+     * @brief getter method for the traffic of the bus since reset()
+     */
+    const Counters& getTotal() const {
+        return mTotal;
+    }
+
+    /**
+     * @brief getter method for the traffic of the bus in each second since
+     * reset(), the first entry covering the first second
+     */
+    const std::vector<Counters>& getSeconds() const {
+        return mSeconds;
+    }
+
+    /**
+     * @brief getter method for the simulated time passed since reset()
+     */
+    uint64_t getProfiledUs() const;
+
+    /**
+     * @brief bus occupancy since reset(), in percent of the capacity at the
+     * configured clock
+     */
+    double getOccupancyPercent() const;
+
+    /**
+     * @brief share of the bus occupied by the transactions to an address
+     * since reset(), in percent of the capacity at the configured clock
+     */
+    double getOccupancyPercent(uint8_t address) const;
+
+    /**
+     * @brief bus occupancy of the busiest second since reset(), in percent
+     */
+    double getPeakOccupancyPercent() const;
+
+    /**
+     * @brief write a table of the traffic per address, in transactions and
+     * bytes per second, and the bus occupancy
+     */
+    void writeReport(FILE* out) const;
+
+  protected:
+    uint8_t writeTransfer(uint8_t address, const uint8_t* data,
+                          size_t length) override;
+    size_t readTransfer(uint8_t address, uint8_t* data,
+                        size_t length) override;
+
+  private:
+    TwoWire& mBus;
+    uint64_t mStartUs = 0;
+    std::array<Counters, 128> mAddresses{};
+    Counters mTotal;
+    std::vector<Counters> mSeconds;
+
+    /**
+     * @brief account a transaction which started at startUs and transferred
+     * numBytes data bytes
+     */
+    void _account(uint8_t address, uint64_t startUs, size_t numBytes,
+                  size_t bytesWritten, size_t bytesRead, bool nack);
+};
+
+}  // namespace sensirion::upt::i2c_autodetect::host
+
+#endif /* HOST_BUS_PROFILER_H */
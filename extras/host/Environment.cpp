@@ -0,0 +1,22 @@
+#include "Environment.h"
+#include <cmath>
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+float Waveform::valueAt(const uint64_t timeUs) const {
+    if (periodMs == 0 || amplitude == 0.0f) {
+        return offset;
+    }
+    const double phase =
+        static_cast<double>(timeUs % (static_cast<uint64_t>(periodMs) * 1000)) /
+        (static_cast<double>(periodMs) * 1000.0);
+    return offset +
+           amplitude * static_cast<float>(std::sin(2.0 * M_PI * phase));
+}
+
+Environment& Environment::defaultEnvironment() {
+    static Environment environment;
+    return environment;
+}
+
+}  // namespace sensirion::upt::i2c_autodetect::host
@@ -0,0 +1,44 @@
+#ifndef HOST_ENVIRONMENT_H
+#define HOST_ENVIRONMENT_H
+
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+/* Slowly varying signal: offset + amplitude * sin(2 * pi * t / period) */
+struct Waveform {
+    float offset = 0.0f;
+    float amplitude = 0.0f;
+    uint32_t periodMs = 0;
+
+    /**
+     * @brief evaluate the waveform at the given simulation time
+     */
+    float valueAt(uint64_t timeUs) const;
+};
+
+/*
+ * Ambient conditions shared by all simulated sensors of a virtual board. The
+ * sensor models sample it whenever they complete a measurement.
+ */
+struct Environment {
+    Waveform temperatureDegC{22.5f, 1.5f, 600000};
+    Waveform humidityPercent{45.0f, 5.0f, 900000};
+    Waveform co2Ppm{650.0f, 150.0f, 1200000};
+    Waveform pm2p5MicroGramPerCubicMeter{8.0f, 4.0f, 300000};
+    Waveform vocIndex{100.0f, 30.0f, 450000};
+    Waveform noxIndex{1.5f, 0.5f, 450000};
+    Waveform hchoPpb{20.0f, 5.0f, 700000};
+    Waveform srawVoc{27000.0f, 500.0f, 450000};
+    Waveform srawNox{15000.0f, 300.0f, 450000};
+
+    /**
+     * @brief environment used by sensor models constructed without an
+     * explicit one
+     */
+    static Environment& defaultEnvironment();
+};
+
+}  // namespace sensirion::upt::i2c_autodetect::host
+
+#endif /* HOST_ENVIRONMENT_H */
@@ -0,0 +1,93 @@
+#include "I2cDeviceModel.h"
+#include "Arduino.h"
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+uint8_t SensirionDeviceModel::crc8(const uint8_t msb, const uint8_t lsb) {
+    uint8_t crc = 0xFF;
+    for (const uint8_t b : {msb, lsb}) {
+        crc ^= b;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31)
+                               : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+bool SensirionDeviceModel::acknowledgesAddress() const {
+    return nowMicros() >= mBusyUntilUs;
+}
+
+bool SensirionDeviceModel::onWrite(const uint8_t* data, const size_t length) {
+    if (length == 0) {
+        // Address probe
+        return true;
+    }
+    if (length < mCommandWidth ||
+        (length - mCommandWidth) % 3 != 0 ||
+        (length - mCommandWidth) / 3 > MAX_ARGUMENT_WORDS) {
+        return false;
+    }
+    uint16_t command = data[0];
+    if (mCommandWidth == 2) {
+        command = static_cast<uint16_t>(command << 8 | data[1]);
+    }
+
+    uint16_t args[MAX_ARGUMENT_WORDS];
+    const size_t numArgs = (length - mCommandWidth) / 3;
+    for (size_t i = 0; i < numArgs; ++i) {
+        const uint8_t* word = data + mCommandWidth + 3 * i;
+        if (crc8(word[0], word[1]) != word[2]) {
+            return false;
+        }
+        args[i] = static_cast<uint16_t>(word[0] << 8 | word[1]);
+    }
+
+    // A new command discards the response of the previous one
+    mResponseLength = 0;
+    return handleCommand(command, args, numArgs);
+}
+
+size_t SensirionDeviceModel::onRead(uint8_t* buffer, const size_t length) {
+    if (mResponseLength == 0) {
+        return 0;
+    }
+    // Bytes beyond the response read as a released bus
+    for (size_t i = 0; i < length; ++i) {
+        buffer[i] = i < mResponseLength ? mResponse[i] : 0xFF;
+    }
+    mResponseLength = 0;
+    return length;
+}
+
+void SensirionDeviceModel::busyFor(const uint32_t executionTimeUs) {
+    mBusyUntilUs = nowMicros() + executionTimeUs;
+}
+
+void SensirionDeviceModel::respond(const uint16_t* words,
+                                   const size_t numWords) {
+    const size_t n = std::min(numWords, MAX_RESPONSE_WORDS);
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t msb = static_cast<uint8_t>(words[i] >> 8);
+        const uint8_t lsb = static_cast<uint8_t>(words[i] & 0xFF);
+        mResponse[3 * i] = msb;
+        mResponse[3 * i + 1] = lsb;
+        mResponse[3 * i + 2] = crc8(msb, lsb);
+    }
+    mResponseLength = 3 * n;
+}
+
+void SensirionDeviceModel::respondString(const char* str,
+                                         const size_t numWords) {
+    uint16_t words[MAX_RESPONSE_WORDS] = {0};
+    const size_t n = std::min(numWords, MAX_RESPONSE_WORDS);
+    const size_t len = std::min(std::strlen(str), 2 * n - 1);
+    for (size_t i = 0; i < len; ++i) {
+        const uint16_t c = static_cast<uint8_t>(str[i]);
+        words[i / 2] |= (i % 2 == 0) ? static_cast<uint16_t>(c << 8) : c;
+    }
+    respond(words, n);
+}
+
+}  // namespace sensirion::upt::i2c_autodetect::host
@@ -0,0 +1,123 @@
+#ifndef HOST_I2C_DEVICE_MODEL_H
+#define HOST_I2C_DEVICE_MODEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+/* Interface of a device listening on the simulated TwoWire bus */
+class I2cDeviceModel {
+  public:
+    explicit I2cDeviceModel(uint8_t address) : mAddress(address){};
+    virtual ~I2cDeviceModel() = default;
+
+    uint8_t getI2cAddress() const {
+        return mAddress;
+    }
+
+    /**
+     * @brief whether the device acknowledges its address right now
+     *
+     * @note Sensirion sensors do not acknowledge their address while they
+     * are busy executing a command.
+     */
+    virtual bool acknowledgesAddress() const = 0;
+
+    /**
+     * @brief handle a write transfer addressed to this device
+     *
+     * @param[in] data bytes written by the bus master, without the address
+     *
+     * @param[in] length number of bytes written. Zero for an address probe.
+     *
+     * @return false if the device does not acknowledge the data
+     */
+    virtual bool onWrite(const uint8_t* data, size_t length) = 0;
+
+    /**
+     * @brief handle a read transfer addressed to this device
+     *
+     * @param[out] buffer location to which write the bytes sent by the device
+     *
+     * @param[in] length number of bytes requested by the bus master
+     *
+     * @return number of bytes sent, 0 if the read is not acknowledged
+     */
+    virtual size_t onRead(uint8_t* buffer, size_t length) = 0;
+
+  private:
+    uint8_t mAddress;
+};
+
+/*
+ * Base class for command based Sensirion sensors. Takes care of command
+ * decoding, CRC handling of arguments and responses and of the command
+ * execution time, during which the sensor does not acknowledge transfers.
+ */
+class SensirionDeviceModel : public I2cDeviceModel {
+  public:
+    static constexpr size_t MAX_RESPONSE_WORDS = 24;
+    static constexpr size_t MAX_ARGUMENT_WORDS = 4;
+
+    /**
+     * @param[in] address i2c address of the device
+     *
+     * @param[in] commandWidth number of bytes of a command code (1 or 2)
+     */
+    SensirionDeviceModel(uint8_t address, uint8_t commandWidth)
+        : I2cDeviceModel(address), mCommandWidth(commandWidth){};
+
+    bool acknowledgesAddress() const override;
+    bool onWrite(const uint8_t* data, size_t length) override;
+    size_t onRead(uint8_t* buffer, size_t length) override;
+
+    /**
+     * @brief Sensirion CRC-8 (polynomial 0x31, init 0xFF) over two bytes
+     */
+    static uint8_t crc8(uint8_t msb, uint8_t lsb);
+
+  protected:
+    /**
+     * @brief execute a command
+     *
+     * @param[in] command command code
+     *
+     * @param[in] args arguments of the command, CRC already verified
+     *
+     * @param[in] numArgs number of arguments
+     *
+     * @return false if the command is unknown or not allowed in the current
+     * device state (it is then not acknowledged)
+     */
+    virtual bool handleCommand(uint16_t command, const uint16_t* args,
+                               size_t numArgs) = 0;
+
+    /**
+     * @brief mark the device busy for the execution time of a command
+     */
+    void busyFor(uint32_t executionTimeUs);
+
+    /**
+     * @brief provide the response of the last command. The words are sent
+     * with CRC once the execution time has passed.
+     */
+    void respond(const uint16_t* words, size_t numWords);
+
+    /**
+     * @brief provide a string response (serial numbers, product names). The
+     * string is zero padded to numWords words.
+     */
+    void respondString(const char* str, size_t numWords);
+
+  private:
+    uint8_t mCommandWidth;
+    uint64_t mBusyUntilUs = 0;
+    std::array<uint8_t, MAX_RESPONSE_WORDS * 3> mResponse{};
+    size_t mResponseLength = 0;
+};
+
+}  // namespace sensirion::upt::i2c_autodetect::host
+
+#endif /* HOST_I2C_DEVICE_MODEL_H */
@@ -0,0 +1,263 @@
+#include "I2cTrace.h"
+#include <cstring>
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+namespace {
+
+constexpr auto TAG = "I2cTrace";
+
+// Mismatches logged before the replay goes quiet
+constexpr size_t MAX_LOGGED_MISMATCHES = 10;
+
+bool readVarint(FILE* file, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        const int byte = fgetc(file);
+        if (byte == EOF) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+RecordingWire::~RecordingWire() {
+    close();
+}
+
+bool RecordingWire::open(const char* path) {
+    close();
+    mFile = fopen(path, "wb");
+    if (!mFile) {
+        return false;
+    }
+    fwrite(I2cTransaction::MAGIC, sizeof(I2cTransaction::MAGIC), 1, mFile);
+    fputc(I2cTransaction::VERSION, mFile);
+    mLastStartUs = 0;
+    mNumberOfTransactions = 0;
+    return true;
+}
+
+void RecordingWire::close() {
+    if (mFile) {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+uint8_t RecordingWire::writeTransfer(const uint8_t address,
+                                     const uint8_t* data,
+                                     const size_t length) {
+    const uint64_t startUs = nowMicros();
+    mBus.beginTransmission(address);
+    mBus.write(data, length);
+    const uint8_t code = mBus.endTransmission();
+
+    _record(I2cTransaction::Type::WRITE, address, startUs, length, code, data,
+            length);
+    mStatistics.transactions++;
+    if (code == 0) {
+        mStatistics.bytesWritten += length;
+    } else {
+        mStatistics.nacks++;
+    }
+    return code;
+}
+
+size_t RecordingWire::readTransfer(const uint8_t address, uint8_t* data,
+                                   const size_t length) {
+    const uint64_t startUs = nowMicros();
+    size_t n = mBus.requestFrom(address, length, true);
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = static_cast<uint8_t>(mBus.read());
+    }
+
+    _record(I2cTransaction::Type::READ, address, startUs, length, n, data, n);
+    mStatistics.transactions++;
+    mStatistics.bytesRead += n;
+    if (n == 0) {
+        mStatistics.nacks++;
+    }
+    return n;
+}
+
+void RecordingWire::_record(const I2cTransaction::Type type,
+                            const uint8_t address, const uint64_t startUs,
+                            const size_t length, const size_t result,
+                            const uint8_t* data, const size_t dataLength) {
+    mNumberOfTransactions++;
+    if (!mFile) {
+        return;
+    }
+    fputc(static_cast<uint8_t>(type), mFile);
+    fputc(address, mFile);
+    _writeVarint(startUs - mLastStartUs);
+    _writeVarint(nowMicros() - startUs);
+    _writeVarint(length);
+    _writeVarint(result);
+    fwrite(data, 1, dataLength, mFile);
+    mLastStartUs = startUs;
+}
+
+void RecordingWire::_writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        fputc(static_cast<uint8_t>(value) | 0x80, mFile);
+        value >>= 7;
+    }
+    fputc(static_cast<uint8_t>(value), mFile);
+}
+
+bool ReplayWire::load(const char* path) {
+    mTransactions.clear();
+    mData.clear();
+    mTruncated = false;
+    rewind();
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t magic[sizeof(I2cTransaction::MAGIC)];
+    if (fread(magic, sizeof(magic), 1, file) != 1 ||
+        memcmp(magic, I2cTransaction::MAGIC, sizeof(magic)) != 0 ||
+        fgetc(file) != I2cTransaction::VERSION) {
+        fclose(file);
+        return false;
+    }
+
+    uint64_t startUs = 0;
+    for (int type = fgetc(file); type != EOF; type = fgetc(file)) {
+        I2cTransaction transaction;
+        uint64_t startDelta = 0;
+        uint64_t length = 0;
+        uint64_t result = 0;
+        const int address = fgetc(file);
+        if (type > static_cast<int>(I2cTransaction::Type::READ) ||
+            address == EOF || !readVarint(file, startDelta) ||
+            !readVarint(file, transaction.durationUs) ||
+            !readVarint(file, length) || !readVarint(file, result)) {
+            mTruncated = true;
+            break;
+        }
+        transaction.type = static_cast<I2cTransaction::Type>(type);
+        transaction.address = static_cast<uint8_t>(address);
+        startUs += startDelta;
+        transaction.startUs = startUs;
+        transaction.length = length;
+        transaction.result = result;
+        transaction.dataOffset = mData.size();
+
+        const size_t dataLength =
+            transaction.type == I2cTransaction::Type::WRITE ? length : result;
+        mData.resize(mData.size() + dataLength);
+        if (fread(mData.data() + transaction.dataOffset, 1, dataLength,
+                  file) != dataLength) {
+            // Keep the data of the complete transactions only
+            mData.resize(transaction.dataOffset);
+            mTruncated = true;
+            break;
+        }
+        mTransactions.push_back(transaction);
+    }
+    fclose(file);
+    if (mTruncated) {
+        ESP_LOGW(TAG, "Trace %s is truncated after %zu transactions", path,
+                 mTransactions.size());
+    }
+    return !mTruncated;
+}
+
+void ReplayWire::rewind() {
+    mNext = 0;
+    mNumberOfMismatches = 0;
+    mMaxTimeDeviationUs = 0;
+}
+
+const I2cTransaction* ReplayWire::_match(const I2cTransaction::Type type,
+                                         const uint8_t address,
+                                         const size_t length) {
+    const I2cTransaction* next =
+        isExhausted() ? nullptr : &mTransactions[mNext];
+    if (!next || next->type != type || next->address != address ||
+        next->length != length) {
+        if (mNumberOfMismatches++ < MAX_LOGGED_MISMATCHES) {
+            ESP_LOGW(TAG,
+                     "Transaction %zu: unexpected %s of %zu bytes at 0x%02x",
+                     mNext,
+                     type == I2cTransaction::Type::WRITE ? "write" : "read",
+                     length, address);
+        }
+        return nullptr;
+    }
+    return next;
+}
+
+void ReplayWire::_replay(const I2cTransaction& transaction) {
+    const uint64_t nowUs = nowMicros();
+    const uint64_t deviationUs = nowUs > transaction.startUs
+                                     ? nowUs - transaction.startUs
+                                     : transaction.startUs - nowUs;
+    mMaxTimeDeviationUs = std::max(mMaxTimeDeviationUs, deviationUs);
+    advanceMicros(transaction.durationUs);
+    mNext++;
+}
+
+uint8_t ReplayWire::writeTransfer(const uint8_t address, const uint8_t* data,
+                                  const size_t length) {
+    mStatistics.transactions++;
+    const I2cTransaction* transaction =
+        _match(I2cTransaction::Type::WRITE, address, length);
+    if (transaction && length > 0 &&
+        memcmp(mData.data() + transaction->dataOffset, data, length) != 0) {
+        if (mNumberOfMismatches++ < MAX_LOGGED_MISMATCHES) {
+            ESP_LOGW(TAG, "Transaction %zu: unexpected data written to 0x%02x",
+                     mNext, address);
+        }
+        transaction = nullptr;
+    }
+    if (!transaction) {
+        mStatistics.nacks++;
+        return 2;
+    }
+
+    _replay(*transaction);
+
+    const uint8_t code = static_cast<uint8_t>(transaction->result);
+    if (code == 0) {
+        mStatistics.bytesWritten += length;
+    } else {
+        mStatistics.nacks++;
+    }
+    return code;
+}
+
+size_t ReplayWire::readTransfer(const uint8_t address, uint8_t* data,
+                                const size_t length) {
+    mStatistics.transactions++;
+    const I2cTransaction* transaction =
+        _match(I2cTransaction::Type::READ, address, length);
+    if (!transaction) {
+        mStatistics.nacks++;
+        return 0;
+    }
+
+    _replay(*transaction);
+
+    const size_t n = std::min(transaction->result, length);
+    if (n > 0) {
+        memcpy(data, mData.data() + transaction->dataOffset, n);
+    }
+    mStatistics.bytesRead += n;
+    if (n == 0) {
+        mStatistics.nacks++;
+    }
+    return n;
+}
+
+}  // namespace sensirion::upt::i2c_autodetect::host
@@ -0,0 +1,200 @@
+#ifndef HOST_I2C_TRACE_H
+#define HOST_I2C_TRACE_H
+
+#include "Wire.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+/*
+ * Trace of the transactions on an I2C bus, written by RecordingWire and
+ * replayed by ReplayWire.
+ *
+ * File format (varint: unsigned LEB128):
+ *
+ *   trace       := MAGIC ("I2CT") VERSION transaction*
+ *   transaction := uint8 type (0: write, 1: read)
+ *                  uint8 7 bit address
+ *                  varint start time minus the start time of the previous
+ *                         transaction (0 for the first), in us
+ *                  varint duration in us
+ *                  varint number of bytes written or requested
+ *                  varint result: endTransmission() code for writes, number
+ *                         of bytes received for reads
+ *                  bytes written, or bytes received
+ */
+struct I2cTransaction {
+    enum class Type : uint8_t { WRITE = 0, READ = 1 };
+
+    Type type = Type::WRITE;
+    uint8_t address = 0;
+    // Simulated time at the start of the transaction
+    uint64_t startUs = 0;
+    uint64_t durationUs = 0;
+    size_t length = 0;
+    size_t result = 0;
+    // Offset of the written or received bytes in the data of the trace
+    size_t dataOffset = 0;
+
+    static constexpr uint8_t MAGIC[4] = {'I', '2', 'C', 'T'};
+    static constexpr uint8_t VERSION = 1;
+};
+
+/*
+ * TwoWire decorator recording every transaction issued on it to a trace
+ * file, and forwarding it to the decorated bus. Sensors are detected and
+ * read through the decorator, eg. DefaultI2cDetector detector(recorder).
+ */
+class RecordingWire : public TwoWire {
+  public:
+    explicit RecordingWire(TwoWire& bus)
+        : TwoWire(bus.getBusNum()), mBus(bus){};
+    ~RecordingWire() override;
+
+    // The configuration applies to the decorated bus
+    bool begin() override {
+        return mBus.begin();
+    }
+    bool begin(int sda, int scl, uint32_t frequency = 0) override {
+        return mBus.begin(sda, scl, frequency);
+    }
+    bool end() override {
+        return mBus.end();
+    }
+    bool setClock(uint32_t frequency) override {
+        return mBus.setClock(frequency);
+    }
+    uint32_t getClock() const override {
+        return mBus.getClock();
+    }
+
+    /**
+     * @brief start recording to a trace file, which is overwritten
+     *
+     * @returns False if the file cannot be created
+     */
+    bool open(const char* path);
+
+    /**
+     * @brief stop recording and close the trace file
+     */
+    void close();
+
+    size_t getNumberOfTransactions() const {
+        return mNumberOfTransactions;
+    }
+
+  protected:
+    uint8_t writeTransfer(uint8_t address, const uint8_t* data,
+                          size_t length) override;
+    size_t readTransfer(uint8_t address, uint8_t* data,
+                        size_t length) override;
+
+  private:
+    TwoWire& mBus;
+    FILE* mFile = nullptr;
+    uint64_t mLastStartUs = 0;
+    size_t mNumberOfTransactions = 0;
+
+    void _record(I2cTransaction::Type type, uint8_t address, uint64_t startUs,
+                 size_t length, size_t result, const uint8_t* data,
+                 size_t dataLength);
+    void _writeVarint(uint64_t value);
+};
+
+/*
+ * Bus answering the transactions of the library from a trace instead of
+ * simulated devices. As long as the library issues the recorded
+ * transactions, the recorded responses are returned and the simulated clock
+ * advances by the recorded durations, such that a recorded session is
+ * reproduced exactly, at simulation speed.
+ *
+ * A transaction which differs from the next recorded one (type, address,
+ * length or written bytes) is counted as mismatch and not acknowledged,
+ * without consuming the recorded transaction.
+ */
+class ReplayWire : public TwoWire {
+  public:
+    explicit ReplayWire(uint8_t busNum = 0) : TwoWire(busNum){};
+
+    /**
+     * @brief load a trace and restart the replay from its beginning
+     *
+     * @note The transactions before the end of a truncated trace, eg. of a
+     * session which crashed, are loaded and can be replayed
+     *
+     * @returns False if the file cannot be read, is no valid trace or is
+     * truncated, see isTruncated()
+     */
+    bool load(const char* path);
+
+    /**
+     * @brief getter method for whether the last loaded trace ended within a
+     * transaction
+     */
+    bool isTruncated() const {
+        return mTruncated;
+    }
+
+    /**
+     * @brief restart the replay from the beginning of the trace
+     */
+    void rewind();
+
+    size_t getNumberOfTransactions() const {
+        return mTransactions.size();
+    }
+
+    size_t getNumberOfReplayedTransactions() const {
+        return mNext;
+    }
+
+    size_t getNumberOfMismatches() const {
+        return mNumberOfMismatches;
+    }
+
+    /**
+     * @brief getter method for the largest difference between the time at
+     * which a transaction was recorded and replayed, in us
+     */
+    uint64_t getMaxTimeDeviationUs() const {
+        return mMaxTimeDeviationUs;
+    }
+
+    bool isExhausted() const {
+        return mNext >= mTransactions.size();
+    }
+
+  protected:
+    uint8_t writeTransfer(uint8_t address, const uint8_t* data,
+                          size_t length) override;
+    size_t readTransfer(uint8_t address, uint8_t* data,
+                        size_t length) override;
+
+  private:
+    std::vector<I2cTransaction> mTransactions;
+    std::vector<uint8_t> mData;
+    bool mTruncated = false;
+    size_t mNext = 0;
+    size_t mNumberOfMismatches = 0;
+    uint64_t mMaxTimeDeviationUs = 0;
+
+    /**
+     * @brief get the next recorded transaction if it matches the issued one
+     *
+     * @returns nullptr on a mismatch
+     */
+    const I2cTransaction* _match(I2cTransaction::Type type, uint8_t address,
+                                 size_t length);
+
+    /**
+     * @brief consume a matched transaction, taking the recorded time
+     */
+    void _replay(const I2cTransaction& transaction);
+};
+
+}  // namespace sensirion::upt::i2c_autodetect::host
+
+#endif /* HOST_I2C_TRACE_H */
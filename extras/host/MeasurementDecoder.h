@@ -0,0 +1,139 @@
+#ifndef HOST_MEASUREMENT_DECODER_H
+#define HOST_MEASUREMENT_DECODER_H
+
+#include "MeasurementEncoder.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+/* Sensor of a batch decoded by MeasurementDecoder. The DeviceType is given
+ * by its label, since the receiving side does not need to know the types. */
+struct DecodedSensor {
+    SensorKey key;
+    std::string deviceLabel;
+};
+
+/*
+ * Decoder of the binary batches written by MeasurementEncoder, see there for
+ * the format.
+ */
+class MeasurementDecoder {
+  public:
+    /**
+     * @brief decode a batch
+     *
+     * @param[in] data batch as written by MeasurementEncoder
+     *
+     * @param[in] size size of the batch in bytes
+     *
+     * @param[in] visitor callable invoked with (const DecodedSensor&,
+     * core::SignalType, const core::DataPoint&) for each signal of the batch
+     *
+     * @returns False if the batch is truncated or malformed. The signals up
+     * to the error have been visited.
+     */
+    template <typename Visitor>
+    static bool decode(const uint8_t* data, const size_t size,
+                       Visitor&& visitor) {
+        Reader reader{data, size};
+        uint64_t magic = 0;
+        uint64_t version = 0;
+        if (!reader.readByte(magic) || !reader.readByte(version) ||
+            magic != MeasurementEncoder::FORMAT_MAGIC ||
+            version != MeasurementEncoder::FORMAT_VERSION) {
+            return false;
+        }
+
+        uint32_t timeStamp = 0;
+        DecodedSensor sensor;
+        while (true) {
+            uint64_t numberOfSignals = 0;
+            if (!reader.readVarint(numberOfSignals)) {
+                return false;
+            }
+            if (numberOfSignals == MeasurementEncoder::END_OF_BATCH) {
+                return reader.position == size;
+            }
+
+            uint64_t busId = 0;
+            uint64_t i2cAddress = 0;
+            uint64_t labelLength = 0;
+            if (!reader.readByte(busId) || !reader.readByte(i2cAddress) ||
+                !reader.readVarint(sensor.key.deviceID) ||
+                !reader.readByte(labelLength) ||
+                size - reader.position < labelLength) {
+                return false;
+            }
+            sensor.key.busId = static_cast<uint8_t>(busId);
+            sensor.key.i2cAddress = static_cast<uint8_t>(i2cAddress);
+            sensor.deviceLabel.assign(
+                reinterpret_cast<const char*>(data + reader.position),
+                labelLength);
+            reader.position += labelLength;
+
+            for (uint64_t i = 0; i < numberOfSignals; ++i) {
+                uint64_t signalType = 0;
+                uint64_t zigzag = 0;
+                float value = 0.0f;
+                if (!reader.readVarint(signalType) ||
+                    !reader.readVarint(zigzag) || !reader.readFloat(value)) {
+                    return false;
+                }
+                const int32_t delta =
+                    static_cast<int32_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+                timeStamp += static_cast<uint32_t>(delta);
+                const core::DataPoint dataPoint{timeStamp, value};
+                visitor(static_cast<const DecodedSensor&>(sensor),
+                        static_cast<core::SignalType>(signalType), dataPoint);
+            }
+        }
+    }
+
+  private:
+    struct Reader {
+        const uint8_t* data;
+        size_t size;
+        size_t position = 0;
+
+        bool readByte(uint64_t& value) {
+            if (position >= size) {
+                return false;
+            }
+            value = data[position++];
+            return true;
+        }
+
+        bool readVarint(uint64_t& value) {
+            value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                uint64_t byte = 0;
+                if (!readByte(byte)) {
+                    return false;
+                }
+                value |= (byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool readFloat(float& value) {
+            if (size - position < sizeof(uint32_t)) {
+                return false;
+            }
+            uint32_t bits = 0;
+            for (size_t i = 0; i < sizeof(bits); ++i) {
+                bits |= static_cast<uint32_t>(data[position++]) << (8 * i);
+            }
+            memcpy(&value, &bits, sizeof(value));
+            return true;
+        }
+    };
+};
+} // namespace sensirion::upt::i2c_autodetect::host
+
+#endif /* HOST_MEASUREMENT_DECODER_H */
@@ -0,0 +1,616 @@
+#include "SensorModels.h"
+#include "Arduino.h"
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+namespace {
+
+constexpr uint32_t MS = 1000;
+
+uint16_t toUnsignedWord(const double value) {
+    if (value <= 0.0) {
+        return 0;
+    }
+    if (value >= 65535.0) {
+        return 0xFFFF;
+    }
+    return static_cast<uint16_t>(std::lround(value));
+}
+
+uint16_t toSignedWord(const double value) {
+    const double clamped = std::min(32767.0, std::max(-32768.0, value));
+    return static_cast<uint16_t>(static_cast<int16_t>(std::lround(clamped)));
+}
+
+/* Splits value into numWords big endian words */
+void splitWords(const uint64_t value, uint16_t* words, const size_t numWords) {
+    for (size_t i = 0; i < numWords; ++i) {
+        words[i] = static_cast<uint16_t>(value >> (16 * (numWords - 1 - i)));
+    }
+}
+
+/* SHT4x and STCC4 temperature and humidity tick encoding */
+uint16_t temperatureTicks(const float degC) {
+    return toUnsignedWord((degC + 45.0) * 65535.0 / 175.0);
+}
+
+uint16_t humidityTicks(const float percent) {
+    return toUnsignedWord((percent + 6.0) * 65535.0 / 125.0);
+}
+
+}  // namespace
+
+void PeriodicMeasurement::start() {
+    mStartUs = nowMicros();
+    mConsumed = 0;
+    mRunning = true;
+}
+
+void PeriodicMeasurement::stop() {
+    mRunning = false;
+}
+
+bool PeriodicMeasurement::isRunning() const {
+    return mRunning;
+}
+
+uint64_t PeriodicMeasurement::samplesProduced() const {
+    if (!mRunning) {
+        return 0;
+    }
+    return (nowMicros() - mStartUs) / mIntervalUs;
+}
+
+bool PeriodicMeasurement::hasNewSample() const {
+    return samplesProduced() > mConsumed;
+}
+
+void PeriodicMeasurement::consume() {
+    mConsumed = samplesProduced();
+}
+
+/* SHT4x */
+
+Sht4xModel::Sht4xModel(const uint8_t address, const uint32_t serialNumber,
+                       const Environment& env)
+    : SensirionDeviceModel(address, 1), mSerialNumber(serialNumber),
+      mEnv(env){};
+
+bool Sht4xModel::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    if (numArgs) {
+        return false;
+    }
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0xFD: {  // measure T & RH, high precision
+            const uint16_t words[] = {
+                temperatureTicks(mEnv.temperatureDegC.valueAt(now)),
+                humidityTicks(mEnv.humidityPercent.valueAt(now))};
+            respond(words, 2);
+            busyFor(8300);
+            return true;
+        }
+        case 0x89: {  // read serial number
+            uint16_t words[2];
+            splitWords(mSerialNumber, words, 2);
+            respond(words, 2);
+            busyFor(1 * MS);
+            return true;
+        }
+        case 0x94:  // soft reset
+            busyFor(1 * MS);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* SCD4x */
+
+Scd4xModel::Scd4xModel(const uint8_t address, const uint64_t serialNumber,
+                       const Environment& env)
+    : SensirionDeviceModel(address, 2), mSerialNumber(serialNumber),
+      mEnv(env){};
+
+bool Scd4xModel::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0x21B1:  // start_periodic_measurement
+            if (mMeasurement.isRunning()) {
+                return false;
+            }
+            mMeasurement.start();
+            return true;
+        case 0x3F86:  // stop_periodic_measurement
+            mMeasurement.stop();
+            busyFor(500 * MS);
+            return true;
+        case 0xEC05: {  // read_measurement
+            busyFor(1 * MS);
+            if (!mMeasurement.hasNewSample()) {
+                // Empty buffer, the read header is not acknowledged
+                return true;
+            }
+            mMeasurement.consume();
+            const uint16_t words[] = {
+                toUnsignedWord(mEnv.co2Ppm.valueAt(now)),
+                temperatureTicks(mEnv.temperatureDegC.valueAt(now)),
+                toUnsignedWord(mEnv.humidityPercent.valueAt(now) * 65535.0 /
+                               100.0)};
+            respond(words, 3);
+            return true;
+        }
+        case 0xE4B8: {  // get_data_ready_status
+            const uint16_t status =
+                mMeasurement.hasNewSample() ? 0x8006 : 0x8000;
+            respond(&status, 1);
+            busyFor(1 * MS);
+            return true;
+        }
+        case 0xE000:  // set_ambient_pressure, allowed while measuring
+            if (numArgs != 1) {
+                return false;
+            }
+            busyFor(1 * MS);
+            return true;
+        case 0x3682: {  // get_serial_number
+            if (mMeasurement.isRunning() || numArgs) {
+                return false;
+            }
+            uint16_t words[3];
+            splitWords(mSerialNumber, words, 3);
+            respond(words, 3);
+            busyFor(1 * MS);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/* SCD30 */
+
+Scd30Model::Scd30Model(const uint8_t address, const Environment& env)
+    : SensirionDeviceModel(address, 2), mEnv(env){};
+
+bool Scd30Model::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0x0010:  // trigger continuous measurement (ambient pressure)
+            if (numArgs != 1) {
+                return false;
+            }
+            if (!mMeasurement.isRunning()) {
+                mMeasurement.start();
+            }
+            busyFor(3 * MS);
+            return true;
+        case 0x0104:  // stop continuous measurement
+            mMeasurement.stop();
+            busyFor(3 * MS);
+            return true;
+        case 0x0202: {  // get data ready status
+            const uint16_t ready = mMeasurement.hasNewSample() ? 1 : 0;
+            respond(&ready, 1);
+            busyFor(3 * MS);
+            return true;
+        }
+        case 0x0300: {  // read measurement, IEEE754 floats
+            if (!mMeasurement.isRunning()) {
+                return false;
+            }
+            mMeasurement.consume();
+            const float values[] = {mEnv.co2Ppm.valueAt(now),
+                                    mEnv.temperatureDegC.valueAt(now),
+                                    mEnv.humidityPercent.valueAt(now)};
+            uint16_t words[6];
+            for (size_t i = 0; i < 3; ++i) {
+                uint32_t bits;
+                std::memcpy(&bits, &values[i], sizeof(bits));
+                splitWords(bits, &words[2 * i], 2);
+            }
+            respond(words, 6);
+            busyFor(3 * MS);
+            return true;
+        }
+        case 0x4600:  // set measurement interval
+        case 0x5306:  // (de-)activate automatic self-calibration
+            busyFor(3 * MS);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* SEN5x */
+
+Sen5xModel::Sen5xModel(const uint8_t address, const char* productName,
+                       const char* serialNumber, const Environment& env)
+    : SensirionDeviceModel(address, 2), mProductName(productName),
+      mSerialNumber(serialNumber), mEnv(env){};
+
+bool Sen5xModel::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    if (numArgs) {
+        return false;
+    }
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0x0021:  // start measurement
+            if (!mMeasurement.isRunning()) {
+                mMeasurement.start();
+            }
+            busyFor(50 * MS);
+            return true;
+        case 0x0104:  // stop measurement
+            mMeasurement.stop();
+            busyFor(200 * MS);
+            return true;
+        case 0x0202: {  // read data-ready flag
+            const uint16_t ready = mMeasurement.hasNewSample() ? 1 : 0;
+            respond(&ready, 1);
+            busyFor(20 * MS);
+            return true;
+        }
+        case 0x03C4: {  // read measured values
+            if (!mMeasurement.isRunning()) {
+                return false;
+            }
+            busyFor(20 * MS);
+            if (mMeasurement.samplesProduced() == 0) {
+                // No measurement available yet
+                const uint16_t unknown[] = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+                                            0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF};
+                respond(unknown, 8);
+                return true;
+            }
+            mMeasurement.consume();
+            const double pm = mEnv.pm2p5MicroGramPerCubicMeter.valueAt(now);
+            const uint16_t words[] = {
+                toUnsignedWord(0.7 * pm * 10.0),
+                toUnsignedWord(pm * 10.0),
+                toUnsignedWord(1.1 * pm * 10.0),
+                toUnsignedWord(1.2 * pm * 10.0),
+                toSignedWord(mEnv.humidityPercent.valueAt(now) * 100.0),
+                toSignedWord(mEnv.temperatureDegC.valueAt(now) * 200.0),
+                toSignedWord(mEnv.vocIndex.valueAt(now) * 10.0),
+                toSignedWord(mEnv.noxIndex.valueAt(now) * 10.0)};
+            respond(words, 8);
+            return true;
+        }
+        case 0xD033:  // read serial number
+            respondString(mSerialNumber, 16);
+            busyFor(50 * MS);
+            return true;
+        case 0xD014:  // read product name
+            respondString(mProductName, 16);
+            busyFor(50 * MS);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* SEN66 */
+
+Sen66Model::Sen66Model(const uint8_t address, const char* serialNumber,
+                       const Environment& env)
+    : SensirionDeviceModel(address, 2), mSerialNumber(serialNumber),
+      mEnv(env){};
+
+bool Sen66Model::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    if (numArgs) {
+        return false;
+    }
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0xD304:  // device reset
+            mMeasurement.stop();
+            busyFor(1200 * MS);
+            return true;
+        case 0x0021:  // start continuous measurement
+            if (mMeasurement.isRunning()) {
+                return false;
+            }
+            mMeasurement.start();
+            busyFor(50 * MS);
+            return true;
+        case 0x0104:  // stop measurement
+            mMeasurement.stop();
+            busyFor(1000 * MS);
+            return true;
+        case 0x0202: {  // get data ready
+            const uint16_t ready = mMeasurement.hasNewSample() ? 1 : 0;
+            respond(&ready, 1);
+            busyFor(20 * MS);
+            return true;
+        }
+        case 0x0300: {  // read measured values
+            if (!mMeasurement.isRunning()) {
+                return false;
+            }
+            busyFor(20 * MS);
+            mMeasurement.consume();
+            const double pm = mEnv.pm2p5MicroGramPerCubicMeter.valueAt(now);
+            // The CO2 signal is only available about 5s after start
+            const uint16_t co2 = mMeasurement.samplesProduced() < 5
+                                     ? 0xFFFF
+                                     : toUnsignedWord(mEnv.co2Ppm.valueAt(now));
+            const uint16_t words[] = {
+                toUnsignedWord(0.7 * pm * 10.0),
+                toUnsignedWord(pm * 10.0),
+                toUnsignedWord(1.1 * pm * 10.0),
+                toUnsignedWord(1.2 * pm * 10.0),
+                toSignedWord(mEnv.humidityPercent.valueAt(now) * 100.0),
+                toSignedWord(mEnv.temperatureDegC.valueAt(now) * 200.0),
+                toSignedWord(mEnv.vocIndex.valueAt(now) * 10.0),
+                toSignedWord(mEnv.noxIndex.valueAt(now) * 10.0),
+                co2};
+            respond(words, 9);
+            return true;
+        }
+        case 0xD033:  // get serial number
+            respondString(mSerialNumber, 16);
+            busyFor(20 * MS);
+            return true;
+        case 0xD014:  // get product name
+            respondString("SEN66", 16);
+            busyFor(20 * MS);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* SFA3x */
+
+Sfa3xModel::Sfa3xModel(const uint8_t address, const char* deviceMarking,
+                       const Environment& env)
+    : SensirionDeviceModel(address, 2), mDeviceMarking(deviceMarking),
+      mEnv(env){};
+
+bool Sfa3xModel::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    if (numArgs) {
+        return false;
+    }
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0x0006:  // start continuous measurement
+            if (mMeasurement.isRunning()) {
+                return false;
+            }
+            mMeasurement.start();
+            busyFor(1 * MS);
+            return true;
+        case 0x0104:  // stop measurement
+            mMeasurement.stop();
+            busyFor(50 * MS);
+            return true;
+        case 0x0327: {  // read measured values
+            if (!mMeasurement.isRunning()) {
+                return false;
+            }
+            mMeasurement.consume();
+            const uint16_t words[] = {
+                toSignedWord(mEnv.hchoPpb.valueAt(now) * 5.0),
+                toSignedWord(mEnv.humidityPercent.valueAt(now) * 100.0),
+                toSignedWord(mEnv.temperatureDegC.valueAt(now) * 200.0)};
+            respond(words, 3);
+            busyFor(5 * MS);
+            return true;
+        }
+        case 0xD060:  // get device marking
+            respondString(mDeviceMarking, 16);
+            busyFor(2 * MS);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* SGP41 */
+
+Sgp41Model::Sgp41Model(const uint8_t address, const uint64_t serialNumber,
+                       const Environment& env)
+    : SensirionDeviceModel(address, 2), mSerialNumber(serialNumber),
+      mEnv(env){};
+
+bool Sgp41Model::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0x2612: {  // execute conditioning (RH, T compensation)
+            if (numArgs != 2) {
+                return false;
+            }
+            const uint16_t srawVoc = toUnsignedWord(mEnv.srawVoc.valueAt(now));
+            respond(&srawVoc, 1);
+            busyFor(50 * MS);
+            return true;
+        }
+        case 0x2619: {  // measure raw signals (RH, T compensation)
+            if (numArgs != 2) {
+                return false;
+            }
+            const uint16_t words[] = {toUnsignedWord(mEnv.srawVoc.valueAt(now)),
+                                      toUnsignedWord(mEnv.srawNox.valueAt(now))};
+            respond(words, 2);
+            busyFor(50 * MS);
+            return true;
+        }
+        case 0x3682: {  // get serial number
+            uint16_t words[3];
+            splitWords(mSerialNumber, words, 3);
+            respond(words, 3);
+            busyFor(1 * MS);
+            return true;
+        }
+        case 0x280E: {  // execute self test
+            const uint16_t result = 0xD400;
+            respond(&result, 1);
+            busyFor(320 * MS);
+            return true;
+        }
+        case 0x3615:  // turn heater off
+            busyFor(1 * MS);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* STC3x */
+
+Stc3xModel::Stc3xModel(const uint8_t address, const uint64_t serialNumber,
+                       const Environment& env)
+    : SensirionDeviceModel(address, 2), mSerialNumber(serialNumber),
+      mEnv(env){};
+
+bool Stc3xModel::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0x3615:  // set binary gas
+        case 0x3624:  // set relative humidity
+        case 0x361E:  // set temperature
+            return numArgs == 1;
+        case 0x3639: {  // measure gas concentration
+            if (numArgs) {
+                return false;
+            }
+            // CO2 in air, volume percent
+            const double gasPercent = mEnv.co2Ppm.valueAt(now) / 10000.0;
+            const uint16_t words[] = {
+                toUnsignedWord(gasPercent * 32768.0 / 100.0 + 16384.0),
+                toSignedWord(mEnv.temperatureDegC.valueAt(now) * 200.0)};
+            respond(words, 2);
+            busyFor(66 * MS);
+            return true;
+        }
+        case 0x367C:  // prepare product identifier
+            mProductIdentifierPrepared = true;
+            return numArgs == 0;
+        case 0xE102: {  // read product identifier
+            if (!mProductIdentifierPrepared || numArgs) {
+                return false;
+            }
+            mProductIdentifierPrepared = false;
+            uint16_t words[6];
+            splitWords(0x08010301, words, 2);  // STC31
+            splitWords(mSerialNumber, &words[2], 4);
+            respond(words, 6);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/* SVM41 */
+
+Svm41Model::Svm41Model(const uint8_t address, const char* serialNumber,
+                       const Environment& env)
+    : SensirionDeviceModel(address, 2), mSerialNumber(serialNumber),
+      mEnv(env){};
+
+bool Svm41Model::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    if (numArgs) {
+        return false;
+    }
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0x0010:  // start measurement
+            if (mMeasurement.isRunning()) {
+                return false;
+            }
+            mMeasurement.start();
+            busyFor(1 * MS);
+            return true;
+        case 0x0104:  // stop measurement
+            mMeasurement.stop();
+            busyFor(50 * MS);
+            return true;
+        case 0x0405: {  // read measured values
+            if (!mMeasurement.isRunning()) {
+                return false;
+            }
+            mMeasurement.consume();
+            const uint16_t words[] = {
+                toSignedWord(mEnv.humidityPercent.valueAt(now) * 100.0),
+                toSignedWord(mEnv.temperatureDegC.valueAt(now) * 200.0),
+                toSignedWord(mEnv.vocIndex.valueAt(now) * 10.0),
+                toSignedWord(mEnv.noxIndex.valueAt(now) * 10.0)};
+            respond(words, 4);
+            busyFor(50 * MS);
+            return true;
+        }
+        case 0xD033:  // get serial number
+            respondString(mSerialNumber, 16);
+            busyFor(1 * MS);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* STCC4 */
+
+Stcc4Model::Stcc4Model(const uint8_t address, const uint64_t serialNumber,
+                       const Environment& env)
+    : SensirionDeviceModel(address, 2), mSerialNumber(serialNumber),
+      mEnv(env){};
+
+bool Stcc4Model::handleCommand(const uint16_t command, const uint16_t*,
+                               const size_t numArgs) {
+    if (numArgs) {
+        return false;
+    }
+    const uint64_t now = nowMicros();
+    switch (command) {
+        case 0x218B:  // start continuous measurement
+            if (mMeasurement.isRunning()) {
+                return false;
+            }
+            mMeasurement.start();
+            return true;
+        case 0x3F86:  // stop continuous measurement
+            mMeasurement.stop();
+            busyFor(1200 * MS);
+            return true;
+        case 0x365B: {  // get product id
+            if (mMeasurement.isRunning()) {
+                return false;
+            }
+            uint16_t words[6];
+            splitWords(0x0901018A, words, 2);
+            splitWords(mSerialNumber, &words[2], 4);
+            respond(words, 6);
+            busyFor(1 * MS);
+            return true;
+        }
+        case 0xEC05: {  // read measurement
+            if (!mMeasurement.isRunning()) {
+                return false;
+            }
+            mMeasurement.consume();
+            const uint16_t words[] = {
+                toSignedWord(mEnv.co2Ppm.valueAt(now)),
+                temperatureTicks(mEnv.temperatureDegC.valueAt(now)),
+                humidityTicks(mEnv.humidityPercent.valueAt(now)),
+                0x0000};  // sensor status
+            respond(words, 4);
+            busyFor(1 * MS);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+}  // namespace sensirion::upt::i2c_autodetect::host
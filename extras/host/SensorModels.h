@@ -0,0 +1,206 @@
+#ifndef HOST_SENSOR_MODELS_H
+#define HOST_SENSOR_MODELS_H
+
+#include "Environment.h"
+#include "I2cDeviceModel.h"
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+/*
+ * Command level models of the sensors configured in DefaultDriverConfig.h.
+ * Command codes, data encodings and execution times follow the respective
+ * datasheets. Sensors only acknowledge commands that are allowed in their
+ * current mode (idle or measuring) and refuse transfers while executing a
+ * command, like the real devices do.
+ */
+
+/* Tracks the sample clock of a sensor in periodic measurement mode */
+class PeriodicMeasurement {
+  public:
+    explicit PeriodicMeasurement(uint32_t intervalMs)
+        : mIntervalUs(static_cast<uint64_t>(intervalMs) * 1000){};
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * @brief number of samples produced since the measurement was started
+     */
+    uint64_t samplesProduced() const;
+
+    /**
+     * @brief whether a sample was produced since the last call to consume()
+     */
+    bool hasNewSample() const;
+    void consume();
+
+  private:
+    uint64_t mIntervalUs;
+    uint64_t mStartUs = 0;
+    uint64_t mConsumed = 0;
+    bool mRunning = false;
+};
+
+class Sht4xModel : public SensirionDeviceModel {
+  public:
+    explicit Sht4xModel(uint8_t address = 0x44, uint32_t serialNumber = 0x12345678,
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    uint32_t mSerialNumber;
+    const Environment& mEnv;
+};
+
+class Scd4xModel : public SensirionDeviceModel {
+  public:
+    explicit Scd4xModel(uint8_t address = 0x62,
+                        uint64_t serialNumber = 0x1A2B3C4D5E6F,
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    uint64_t mSerialNumber;
+    const Environment& mEnv;
+    PeriodicMeasurement mMeasurement{5000};
+};
+
+class Scd30Model : public SensirionDeviceModel {
+  public:
+    explicit Scd30Model(uint8_t address = 0x61,
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    const Environment& mEnv;
+    PeriodicMeasurement mMeasurement{2000};
+};
+
+class Sen5xModel : public SensirionDeviceModel {
+  public:
+    /**
+     * @param[in] productName one of "SEN50", "SEN54" or "SEN55"
+     */
+    explicit Sen5xModel(uint8_t address = 0x69, const char* productName = "SEN55",
+                        const char* serialNumber = "5A3C1F0E2D4B6A78",
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    const char* mProductName;
+    const char* mSerialNumber;
+    const Environment& mEnv;
+    PeriodicMeasurement mMeasurement{1000};
+};
+
+class Sen66Model : public SensirionDeviceModel {
+  public:
+    explicit Sen66Model(uint8_t address = 0x6B,
+                        const char* serialNumber = "9B7D5F3E1C2A4B6D",
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    const char* mSerialNumber;
+    const Environment& mEnv;
+    PeriodicMeasurement mMeasurement{1000};
+};
+
+class Sfa3xModel : public SensirionDeviceModel {
+  public:
+    explicit Sfa3xModel(uint8_t address = 0x5D,
+                        const char* deviceMarking = "211020C0F4A3B1C9",
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    const char* mDeviceMarking;
+    const Environment& mEnv;
+    PeriodicMeasurement mMeasurement{500};
+};
+
+class Sgp41Model : public SensirionDeviceModel {
+  public:
+    explicit Sgp41Model(uint8_t address = 0x59,
+                        uint64_t serialNumber = 0x0000A1B2C3D4E5F6,
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    uint64_t mSerialNumber;
+    const Environment& mEnv;
+};
+
+class Stc3xModel : public SensirionDeviceModel {
+  public:
+    explicit Stc3xModel(uint8_t address = 0x29,
+                        uint64_t serialNumber = 0x0102030405060708,
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    uint64_t mSerialNumber;
+    const Environment& mEnv;
+    bool mProductIdentifierPrepared = false;
+};
+
+class Svm41Model : public SensirionDeviceModel {
+  public:
+    explicit Svm41Model(uint8_t address = 0x6A,
+                        const char* serialNumber = "F2E4C6A8B0D1E3F5",
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    const char* mSerialNumber;
+    const Environment& mEnv;
+    PeriodicMeasurement mMeasurement{1000};
+};
+
+class Stcc4Model : public SensirionDeviceModel {
+  public:
+    explicit Stcc4Model(uint8_t address = 0x64,
+                        uint64_t serialNumber = 0x0011223344556677,
+                        const Environment& env = Environment::defaultEnvironment());
+
+  protected:
+    bool handleCommand(uint16_t command, const uint16_t* args,
+                       size_t numArgs) override;
+
+  private:
+    uint64_t mSerialNumber;
+    const Environment& mEnv;
+    PeriodicMeasurement mMeasurement{1000};
+};
+
+}  // namespace sensirion::upt::i2c_autodetect::host
+
+#endif /* HOST_SENSOR_MODELS_H */
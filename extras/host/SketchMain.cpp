@@ -0,0 +1,32 @@
+/*
+ * Entry point running an Arduino sketch on the host, against a virtual board
+ * carrying one simulated sensor of every supported type on Wire. The number
+ * of loop() iterations may be given as first program argument.
+ */
+
+#include "Arduino.h"
+#include "VirtualBoard.h"
+
+#ifndef HOST_LOOP_ITERATIONS
+#define HOST_LOOP_ITERATIONS 100
+#endif
+
+void setup();
+void loop();
+
+int main(int argc, char** argv) {
+    using sensirion::upt::i2c_autodetect::host::VirtualBoard;
+
+    unsigned long iterations = HOST_LOOP_ITERATIONS;
+    if (argc > 1) {
+        iterations = std::strtoul(argv[1], nullptr, 10);
+    }
+
+    VirtualBoard board(Wire);
+    setup();
+    for (unsigned long i = 0; i < iterations; ++i) {
+        loop();
+    }
+    Serial.flush();
+    return 0;
+}
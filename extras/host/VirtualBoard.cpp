@@ -0,0 +1,34 @@
+#include "VirtualBoard.h"
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+VirtualBoard::VirtualBoard(TwoWire& wire, const Environment& env)
+    : mWire(wire), mScd30(0x61, env), mScd4x(0x62, 0x1A2B3C4D5E6F, env),
+      mSen5x(0x69, "SEN55", "5A3C1F0E2D4B6A78", env),
+      mSen66(0x6B, "9B7D5F3E1C2A4B6D", env),
+      mSfa3x(0x5D, "211020C0F4A3B1C9", env),
+      mSgp41(0x59, 0x0000A1B2C3D4E5F6, env), mSht4x(0x44, 0x12345678, env),
+      mStc3x(0x29, 0x0102030405060708, env),
+      mSvm41(0x6A, "F2E4C6A8B0D1E3F5", env),
+      mStcc4(0x64, 0x0011223344556677, env),
+      mDevices{&mScd30, &mScd4x, &mSen5x, &mSen66, &mSfa3x,
+               &mSgp41, &mSht4x, &mStc3x, &mSvm41, &mStcc4} {
+    connectSensors(NUM_SENSORS);
+}
+
+VirtualBoard::~VirtualBoard() {
+    connectSensors(0);
+}
+
+void VirtualBoard::connectSensors(const size_t numSensors) {
+    for (size_t i = 0; i < NUM_SENSORS; ++i) {
+        if (i < numSensors) {
+            mWire.attachDevice(*mDevices[i]);
+        } else if (mWire.getDevice(mDevices[i]->getI2cAddress()) ==
+                   mDevices[i]) {
+            mWire.detachDevice(mDevices[i]->getI2cAddress());
+        }
+    }
+}
+
+}  // namespace sensirion::upt::i2c_autodetect::host
@@ -0,0 +1,62 @@
+#ifndef HOST_VIRTUAL_BOARD_H
+#define HOST_VIRTUAL_BOARD_H
+
+#include "SensorModels.h"
+#include <Wire.h>
+
+namespace sensirion::upt::i2c_autodetect::host {
+
+/*
+ * One simulated sensor of every type configured in DefaultDriverConfig.h, at
+ * its default address. Sensors can be (dis-)connected individually to
+ * exercise hot-plug handling.
+ */
+class VirtualBoard {
+  public:
+    /**
+     * @brief constructor, attaches all sensors to the given bus
+     */
+    explicit VirtualBoard(TwoWire& wire,
+                          const Environment& env = Environment::defaultEnvironment());
+
+    ~VirtualBoard();
+
+    VirtualBoard(const VirtualBoard&) = delete;
+    VirtualBoard& operator=(const VirtualBoard&) = delete;
+
+    /**
+     * @brief attach the first numSensors sensors and detach the others
+     */
+    void connectSensors(size_t numSensors);
+
+    /**
+     * @brief number of sensors on the board
+     */
+    static constexpr size_t sensorCount() {
+        return NUM_SENSORS;
+    }
+
+    TwoWire& getWire() const {
+        return mWire;
+    }
+
+  private:
+    static constexpr size_t NUM_SENSORS = 10;
+
+    TwoWire& mWire;
+    Scd30Model mScd30;
+    Scd4xModel mScd4x;
+    Sen5xModel mSen5x;
+    Sen66Model mSen66;
+    Sfa3xModel mSfa3x;
+    Sgp41Model mSgp41;
+    Sht4xModel mSht4x;
+    Stc3xModel mStc3x;
+    Svm41Model mSvm41;
+    Stcc4Model mStcc4;
+    I2cDeviceModel* mDevices[NUM_SENSORS];
+};
+
+}  // namespace sensirion::upt::i2c_autodetect::host
+
+#endif /* HOST_VIRTUAL_BOARD_H */
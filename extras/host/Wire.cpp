@@ -0,0 +1,216 @@
+#include "Wire.h"
+
+namespace host = sensirion::upt::i2c_autodetect::host;
+
+bool TwoWire::begin() {
+    return true;
+}
+
+bool TwoWire::begin(int, int, const uint32_t frequency) {
+    if (frequency) {
+        mClockHz = frequency;
+    }
+    return true;
+}
+
+bool TwoWire::end() {
+    return true;
+}
+
+bool TwoWire::setClock(const uint32_t frequency) {
+    if (frequency == 0) {
+        return false;
+    }
+    mClockHz = frequency;
+    return true;
+}
+
+uint32_t TwoWire::getClock() const {
+    return mClockHz;
+}
+
+uint8_t TwoWire::getBusNum() const {
+    return mBusNum;
+}
+
+void TwoWire::beginTransmission(const uint16_t address) {
+    mTxAddress = static_cast<uint8_t>(address & 0x7F);
+    mTxLength = 0;
+    mTransmitting = true;
+}
+
+void TwoWire::beginTransmission(const uint8_t address) {
+    beginTransmission(static_cast<uint16_t>(address));
+}
+
+void TwoWire::beginTransmission(const int address) {
+    beginTransmission(static_cast<uint16_t>(address));
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+    if (!mTransmitting) {
+        return 4;
+    }
+    mTransmitting = false;
+    return writeTransfer(mTxAddress, mTxBuffer.data(), mTxLength);
+}
+
+uint8_t TwoWire::endTransmission() {
+    return endTransmission(true);
+}
+
+size_t TwoWire::requestFrom(const uint16_t address, size_t size, bool) {
+    size = std::min(size, mRxBuffer.size());
+    mRxIndex = 0;
+    mRxLength = readTransfer(static_cast<uint8_t>(address & 0x7F),
+                             mRxBuffer.data(), size);
+    return mRxLength;
+}
+
+uint8_t TwoWire::requestFrom(const uint16_t address, const uint8_t size,
+                             const bool sendStop) {
+    return static_cast<uint8_t>(
+        requestFrom(address, static_cast<size_t>(size), sendStop));
+}
+
+uint8_t TwoWire::requestFrom(const uint16_t address, const uint8_t size,
+                             const uint8_t sendStop) {
+    return requestFrom(address, size, static_cast<bool>(sendStop));
+}
+
+size_t TwoWire::requestFrom(const uint8_t address, const size_t len,
+                            const bool stopBit) {
+    return requestFrom(static_cast<uint16_t>(address), len, stopBit);
+}
+
+uint8_t TwoWire::requestFrom(const uint16_t address, const uint8_t size) {
+    return requestFrom(address, size, true);
+}
+
+uint8_t TwoWire::requestFrom(const uint8_t address, const uint8_t size,
+                             const uint8_t sendStop) {
+    return requestFrom(static_cast<uint16_t>(address), size,
+                       static_cast<bool>(sendStop));
+}
+
+uint8_t TwoWire::requestFrom(const uint8_t address, const uint8_t size) {
+    return requestFrom(static_cast<uint16_t>(address), size, true);
+}
+
+uint8_t TwoWire::requestFrom(const int address, const int size,
+                             const int sendStop) {
+    return static_cast<uint8_t>(
+        requestFrom(static_cast<uint16_t>(address), static_cast<size_t>(size),
+                    static_cast<bool>(sendStop)));
+}
+
+uint8_t TwoWire::requestFrom(const int address, const int size) {
+    return requestFrom(address, size, 1);
+}
+
+size_t TwoWire::write(const uint8_t data) {
+    if (!mTransmitting || mTxLength >= mTxBuffer.size()) {
+        return 0;
+    }
+    mTxBuffer[mTxLength++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, const size_t quantity) {
+    size_t n = 0;
+    while (n < quantity && write(data[n])) {
+        ++n;
+    }
+    return n;
+}
+
+int TwoWire::available() {
+    return static_cast<int>(mRxLength - mRxIndex);
+}
+
+int TwoWire::read() {
+    if (mRxIndex >= mRxLength) {
+        return -1;
+    }
+    return mRxBuffer[mRxIndex++];
+}
+
+int TwoWire::peek() {
+    if (mRxIndex >= mRxLength) {
+        return -1;
+    }
+    return mRxBuffer[mRxIndex];
+}
+
+void TwoWire::flush() {
+    mRxIndex = 0;
+    mRxLength = 0;
+    mTxLength = 0;
+}
+
+void TwoWire::attachDevice(I2cDeviceModel& device) {
+    mDevices[device.getI2cAddress() & 0x7F] = &device;
+}
+
+void TwoWire::detachDevice(const uint8_t address) {
+    mDevices[address & 0x7F] = nullptr;
+}
+
+TwoWire::I2cDeviceModel* TwoWire::getDevice(const uint8_t address) const {
+    return mDevices[address & 0x7F];
+}
+
+const TwoWire::Statistics& TwoWire::getStatistics() const {
+    return mStatistics;
+}
+
+void TwoWire::resetStatistics() {
+    mStatistics = Statistics{};
+}
+
+uint8_t TwoWire::writeTransfer(const uint8_t address, const uint8_t* data,
+                               const size_t length) {
+    mStatistics.transactions++;
+    I2cDeviceModel* device = mDevices[address];
+    if (!device || !device->acknowledgesAddress()) {
+        // Start condition and address byte only
+        _advanceClock(0);
+        mStatistics.nacks++;
+        return 2;
+    }
+    _advanceClock(length);
+    mStatistics.bytesWritten += length;
+    if (!device->onWrite(data, length)) {
+        mStatistics.nacks++;
+        return 3;
+    }
+    return 0;
+}
+
+size_t TwoWire::readTransfer(const uint8_t address, uint8_t* data,
+                             const size_t length) {
+    mStatistics.transactions++;
+    I2cDeviceModel* device = mDevices[address];
+    if (!device || !device->acknowledgesAddress()) {
+        _advanceClock(0);
+        mStatistics.nacks++;
+        return 0;
+    }
+    const size_t n = device->onRead(data, length);
+    _advanceClock(n);
+    mStatistics.bytesRead += n;
+    if (n == 0) {
+        mStatistics.nacks++;
+    }
+    return n;
+}
+
+void TwoWire::_advanceClock(const size_t numBytes) const {
+    // Address byte plus data bytes, each 8 bits and an (N)ACK, plus start and
+    // stop conditions
+    const uint64_t bits = 9 * (numBytes + 1) + 2;
+    host::advanceMicros((bits * 1000000 + mClockHz - 1) / mClockHz);
+}
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
@@ -0,0 +1,129 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+#include "I2cDeviceModel.h"
+#include <array>
+
+#ifndef I2C_BUFFER_LENGTH
+#define I2C_BUFFER_LENGTH 128
+#endif
+
+/*
+ * Simulated I2C bus with the interface of the ESP32 Arduino TwoWire. Devices
+ * are attached as host::I2cDeviceModel instances. Every transfer advances the
+ * simulated clock by the time it takes on the wire at the configured clock.
+ */
+class TwoWire : public Stream {
+  public:
+    using I2cDeviceModel = sensirion::upt::i2c_autodetect::host::I2cDeviceModel;
+
+    /* Counters of the traffic on the bus since the last reset */
+    struct Statistics {
+        uint32_t transactions = 0;
+        uint32_t nacks = 0;
+        uint32_t bytesWritten = 0;
+        uint32_t bytesRead = 0;
+    };
+
+    static constexpr uint32_t DEFAULT_CLOCK_HZ = 100000;
+
+    explicit TwoWire(uint8_t busNum = 0) : mBusNum(busNum){};
+    ~TwoWire() override = default;
+
+    // Virtual, unlike on the ESP32, such that decorators of the bus can
+    // forward the configuration to the decorated bus
+    virtual bool begin();
+    virtual bool begin(int sda, int scl, uint32_t frequency = 0);
+    virtual bool end();
+    virtual bool setClock(uint32_t frequency);
+    virtual uint32_t getClock() const;
+    uint8_t getBusNum() const;
+
+    void beginTransmission(uint16_t address);
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address);
+    uint8_t endTransmission(bool sendStop);
+    uint8_t endTransmission();
+
+    size_t requestFrom(uint16_t address, size_t size, bool sendStop);
+    uint8_t requestFrom(uint16_t address, uint8_t size, bool sendStop);
+    uint8_t requestFrom(uint16_t address, uint8_t size, uint8_t sendStop);
+    size_t requestFrom(uint8_t address, size_t len, bool stopBit);
+    uint8_t requestFrom(uint16_t address, uint8_t size);
+    uint8_t requestFrom(uint8_t address, uint8_t size, uint8_t sendStop);
+    uint8_t requestFrom(uint8_t address, uint8_t size);
+    uint8_t requestFrom(int address, int size, int sendStop);
+    uint8_t requestFrom(int address, int size);
+
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* data, size_t quantity) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+
+    /**
+     * @brief attach a device model to the bus. A device already attached at
+     * the same address is replaced.
+     */
+    void attachDevice(I2cDeviceModel& device);
+
+    /**
+     * @brief detach the device listening at the given address, if any
+     */
+    void detachDevice(uint8_t address);
+
+    /**
+     * @brief getter method for the device listening at the given address
+     *
+     * @note returns a nullptr if no device is attached at that address
+     */
+    I2cDeviceModel* getDevice(uint8_t address) const;
+
+    /**
+     * @brief getter method for the traffic counters
+     */
+    const Statistics& getStatistics() const;
+
+    void resetStatistics();
+
+  protected:
+    /**
+     * @brief write transfer on the bus, returns an endTransmission() code
+     * (0: success, 2: address NACK, 3: data NACK)
+     */
+    virtual uint8_t writeTransfer(uint8_t address, const uint8_t* data,
+                                  size_t length);
+
+    /**
+     * @brief read transfer on the bus, returns the number of bytes read
+     */
+    virtual size_t readTransfer(uint8_t address, uint8_t* data,
+                                size_t length);
+
+    // Updated by the transfers, also by those of derived buses
+    Statistics mStatistics{};
+
+  private:
+    uint8_t mBusNum;
+    uint32_t mClockHz = DEFAULT_CLOCK_HZ;
+    std::array<I2cDeviceModel*, 128> mDevices{};
+
+    uint8_t mTxAddress = 0;
+    bool mTransmitting = false;
+    std::array<uint8_t, I2C_BUFFER_LENGTH> mTxBuffer{};
+    size_t mTxLength = 0;
+
+    std::array<uint8_t, I2C_BUFFER_LENGTH> mRxBuffer{};
+    size_t mRxLength = 0;
+    size_t mRxIndex = 0;
+
+    void _advanceClock(size_t numBytes) const;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif /* HOST_WIRE_H */
@@ -0,0 +1,74 @@
+#ifndef ADAPTIVE_INTERVAL_H
+#define ADAPTIVE_INTERVAL_H
+
+#include "FixedCapacityList.h"
+#include "ISensor.h"
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Configuration of a measurement interval which adapts to the dynamics of
+ * the signals: the interval doubles with every reading in which no signal
+ * changed by more than its threshold, up to maxIntervalMs, and returns to
+ * minIntervalMs as soon as one did. Changes are measured against the last
+ * reading which returned the interval to the minimum, such that slow drifts
+ * are caught as well. Signals without threshold do not affect the interval.
+ *
+ * Eg. for an SCD4x polled every 5 s on activity and every minute otherwise:
+ *
+ *   AdaptiveInterval adaptive;
+ *   adaptive.minIntervalMs = 5000;
+ *   adaptive.maxIntervalMs = 60000;
+ *   adaptive.setThreshold(core::SignalType::CO2_PARTS_PER_MILLION, 20.0f);
+ *   sensorManager.setAdaptiveInterval(adaptive, core::SCD4X());
+ */
+struct AdaptiveInterval {
+    /* Change of a signal from its reference value which counts as event */
+    struct SignalThreshold {
+        core::SignalType signalType = core::SignalType::UNDEFINED;
+        float threshold = 0.0f;
+    };
+
+    // Interval after a change, raised to the minimum measurement interval of
+    // the sensor if shorter
+    uint32_t minIntervalMs = 0;
+    // Interval reached while the signals are stable, lowered to 90% of the
+    // ready state decay time of the sensor if longer
+    uint32_t maxIntervalMs = 0;
+    FixedCapacityList<SignalThreshold, ISensor::MAX_NUMBER_OF_DATA_POINTS>
+        thresholds;
+
+    /**
+     * @brief set the change threshold of a signal, replacing a previous one
+     *
+     * @returns False if MAX_NUMBER_OF_DATA_POINTS thresholds are set already
+     */
+    bool setThreshold(const core::SignalType signalType,
+                      const float threshold) {
+        for (auto& entry : thresholds) {
+            if (entry.signalType == signalType) {
+                entry.threshold = threshold;
+                return true;
+            }
+        }
+        return thresholds.emplace_back(SignalThreshold{signalType, threshold});
+    }
+
+    /**
+     * @brief getter method for the change threshold of a signal
+     *
+     * @note returns a nullptr if the signal has no threshold
+     */
+    const SignalThreshold* findThreshold(
+        const core::SignalType signalType) const {
+        for (const auto& entry : thresholds) {
+            if (entry.signalType == signalType) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* ADAPTIVE_INTERVAL_H */
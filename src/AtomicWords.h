@@ -0,0 +1,55 @@
+#ifndef ATOMIC_WORDS_H
+#define ATOMIC_WORDS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Storage for a value which is written by one task and copied by others
+ * without locking. The value is stored word by word with relaxed atomic
+ * accesses, such that a copy racing with a write is torn instead of being a
+ * data race. Readers detect torn copies with a sequence counter, see
+ * SharedSensorFrame and SensorHistory.
+ *
+ * @tparam T type of the value */
+template <class T>
+class AtomicWords {
+  public:
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "The value is copied word by word");
+
+    void store(const T& value) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < NUMBER_OF_WORDS; ++i) {
+            uint32_t word = 0;
+            std::memcpy(&word, bytes + i * sizeof(word), _wordSize(i));
+            mWords[i].store(word, std::memory_order_relaxed);
+        }
+    }
+
+    void load(T& value) const {
+        auto* bytes = reinterpret_cast<uint8_t*>(&value);
+        for (size_t i = 0; i < NUMBER_OF_WORDS; ++i) {
+            const uint32_t word = mWords[i].load(std::memory_order_relaxed);
+            std::memcpy(bytes + i * sizeof(word), &word, _wordSize(i));
+        }
+    }
+
+  private:
+    static constexpr size_t NUMBER_OF_WORDS =
+        (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> mWords[NUMBER_OF_WORDS] = {};
+
+    // Number of bytes of the value in word i, less in the last word
+    static constexpr size_t _wordSize(const size_t i) {
+        return i + 1 < NUMBER_OF_WORDS ? sizeof(uint32_t)
+                                       : sizeof(T) - i * sizeof(uint32_t);
+    }
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* ATOMIC_WORDS_H */
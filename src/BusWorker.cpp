@@ -0,0 +1,132 @@
+#include "BusWorker.h"
+
+namespace sensirion::upt::i2c_autodetect{
+
+constexpr auto TAG = "BusWorker";
+
+void BusWorker::dispatch(const Job job, void* context) {
+    mJob = job;
+    mContext = context;
+    if (!mStarted && !begin()) {
+        mJob(mContext);
+        return;
+    }
+#if defined(ARDUINO_ARCH_ESP32)
+    xSemaphoreGive(mJobReady);
+#else
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mDispatchTimeStampUs = micros();
+        mJobPending = true;
+    }
+    mCondition.notify_all();
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+bool BusWorker::begin() {
+    if (mStarted) {
+        return true;
+    }
+    mJobReady = xSemaphoreCreateBinary();
+    mJobDone = xSemaphoreCreateBinary();
+    if (!mJobReady || !mJobDone ||
+        xTaskCreate(&BusWorker::_taskEntry, "BusWorker", STACK_SIZE, this, 1,
+                    &mTask) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create worker task, running jobs inline");
+        return false;
+    }
+    mStarted = true;
+    return true;
+}
+
+void BusWorker::_taskEntry(void* pWorker) {
+    auto* worker = static_cast<BusWorker*>(pWorker);
+    while (true) {
+        xSemaphoreTake(worker->mJobReady, portMAX_DELAY);
+        if (worker->mStopRequested) {
+            break;
+        }
+        worker->mJob(worker->mContext);
+        xSemaphoreGive(worker->mJobDone);
+    }
+    xSemaphoreGive(worker->mJobDone);
+    vTaskDelete(nullptr);
+}
+
+void BusWorker::join() {
+    if (mStarted) {
+        xSemaphoreTake(mJobDone, portMAX_DELAY);
+    }
+}
+
+BusWorker::~BusWorker() {
+    if (mStarted) {
+        mStopRequested = true;
+        xSemaphoreGive(mJobReady);
+        xSemaphoreTake(mJobDone, portMAX_DELAY);
+    }
+    if (mJobReady) {
+        vSemaphoreDelete(mJobReady);
+    }
+    if (mJobDone) {
+        vSemaphoreDelete(mJobDone);
+    }
+}
+
+#else
+
+bool BusWorker::begin() {
+    if (!mStarted) {
+        mThread = std::thread(&BusWorker::_threadEntry, this);
+        mStarted = true;
+    }
+    return true;
+}
+
+void BusWorker::_threadEntry() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mCondition.wait(lock, [this]() { return mJobPending || mStopRequested; });
+        if (mStopRequested) {
+            break;
+        }
+        lock.unlock();
+        _catchUp(mDispatchTimeStampUs);
+        mJob(mContext);
+        mCompletionTimeStampUs = micros();
+        lock.lock();
+        mJobPending = false;
+        mCondition.notify_all();
+    }
+}
+
+void BusWorker::join() {
+    if (mStarted) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this]() { return !mJobPending; });
+        _catchUp(mCompletionTimeStampUs);
+    }
+}
+
+void BusWorker::_catchUp(const unsigned long timeStampUs) {
+    const long lagUs = static_cast<long>(timeStampUs - micros());
+    if (lagUs > 0) {
+        delayMicroseconds(static_cast<unsigned int>(lagUs));
+    }
+}
+
+BusWorker::~BusWorker() {
+    if (mStarted) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopRequested = true;
+        }
+        mCondition.notify_all();
+        mThread.join();
+    }
+}
+
+#endif
+} // namespace sensirion::upt::i2c_autodetect
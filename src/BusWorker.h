@@ -0,0 +1,91 @@
+#ifndef BUS_WORKER_H
+#define BUS_WORKER_H
+
+#include "Arduino.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Class executing jobs on a dedicated FreeRTOS task (ESP32) or std::thread
+ * (other platforms), such that the sensors on different buses can be attended
+ * in parallel */
+class BusWorker {
+  public:
+    using Job = void (*)(void* context);
+
+    BusWorker() = default;
+
+    BusWorker(const BusWorker&) = delete;  // Illegal operation
+    BusWorker& operator=(const BusWorker&) = delete;  // Illegal operation
+
+    ~BusWorker();
+
+    /**
+     * @brief start the task executing the jobs
+     *
+     * @note Called by dispatch() if needed. Starting the task from the
+     * constructor of a global object is not possible on ESP32.
+     *
+     * @returns False if the task could not be created, in which case
+     * dispatch() executes the jobs on the calling task.
+     */
+    bool begin();
+
+    /**
+     * @brief execute job(context) on the worker task, without waiting for
+     * its completion
+     *
+     * @note The previously dispatched job must have been joined
+     */
+    void dispatch(Job job, void* context);
+
+    /**
+     * @brief wait for the completion of the dispatched job
+     */
+    void join();
+
+  private:
+    // Stack size of the worker task in bytes
+    static constexpr uint32_t STACK_SIZE = 6144;
+
+    Job mJob = nullptr;
+    void* mContext = nullptr;
+    bool mStarted = false;
+    bool mStopRequested = false;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t mTask = nullptr;
+    SemaphoreHandle_t mJobReady = nullptr;
+    SemaphoreHandle_t mJobDone = nullptr;
+
+    static void _taskEntry(void* pWorker);
+#else
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mJobPending = false;
+    unsigned long mDispatchTimeStampUs = 0;
+    unsigned long mCompletionTimeStampUs = 0;
+
+    void _threadEntry();
+
+    /**
+     * @brief wait until micros() reaches the given time stamp of another
+     * thread, which synchronizes the per thread clocks of the host
+     * simulation, see extras/host/Arduino.h
+     */
+    static void _catchUp(unsigned long timeStampUs);
+#endif
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* BUS_WORKER_H */
@@ -21,8 +21,8 @@ using Sen5xMapping = SensorToAddressMapping<0x69, Sen5x>;
 using Sen66Mapping = SensorToAddressMapping<0x6b, Sen66>;
 using Sfa3xMapping = SensorToAddressMapping<0x5d, Sfa3x>;
 using Sgp41Mapping = SensorToAddressMapping<0x59, Sgp41>;
-using Sht4xMapping = SensorToAddressMapping<0x44, Sht4x>;
-using Stc3xMapping = SensorToAddressMapping<0x29, Stc3x>;
+using Sht4xMapping = SensorToAddressesMapping<Sht4x, 0x44, 0x45, 0x46>;
+using Stc3xMapping = SensorToAddressesMapping<Stc3x, 0x29, 0x2a, 0x2b, 0x2c>;
 using Svm4xMapping = SensorToAddressMapping<0x6a, Svm4x>;
 using Stcc4Mapping = SensorToAddressMapping<0x64, Stcc4>;
 
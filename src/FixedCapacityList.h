@@ -0,0 +1,118 @@
+#ifndef FIXED_CAPACITY_LIST_H
+#define FIXED_CAPACITY_LIST_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Sequence container storing up to CAPACITY elements inline, such that no
+ * heap memory is used. Provides the subset of the std::vector interface used
+ * by the library and its examples. */
+template <typename T, size_t CAPACITY>
+class FixedCapacityList {
+  public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    FixedCapacityList() = default;
+
+    FixedCapacityList(const FixedCapacityList& other) {
+        for (const T& item : other) {
+            emplace_back(item);
+        }
+    }
+
+    FixedCapacityList& operator=(const FixedCapacityList& other) {
+        if (this != &other) {
+            clear();
+            for (const T& item : other) {
+                emplace_back(item);
+            }
+        }
+        return *this;
+    }
+
+    ~FixedCapacityList() {
+        clear();
+    }
+
+    /**
+     * @brief construct an element at the end of the list
+     *
+     * @returns False if the list is full, in which case the element is
+     * discarded
+     */
+    template <typename... Args>
+    bool emplace_back(Args&&... args) {
+        if (mSize >= CAPACITY) {
+            return false;
+        }
+        new (&_data()[mSize]) T(std::forward<Args>(args)...);
+        ++mSize;
+        return true;
+    }
+
+    /**
+     * @brief remove all elements, keeping the storage
+     */
+    void clear() {
+        while (mSize > 0) {
+            _data()[--mSize].~T();
+        }
+    }
+
+    size_t size() const {
+        return mSize;
+    }
+
+    static constexpr size_t capacity() {
+        return CAPACITY;
+    }
+
+    bool empty() const {
+        return mSize == 0;
+    }
+
+    T& operator[](const size_t i) {
+        return _data()[i];
+    }
+
+    const T& operator[](const size_t i) const {
+        return _data()[i];
+    }
+
+    iterator begin() {
+        return _data();
+    }
+
+    iterator end() {
+        return _data() + mSize;
+    }
+
+    const_iterator begin() const {
+        return _data();
+    }
+
+    const_iterator end() const {
+        return _data() + mSize;
+    }
+
+  private:
+    // Raw storage, such that T needs not be default constructible
+    alignas(T) unsigned char mStorage[sizeof(T) * CAPACITY];
+    size_t mSize = 0;
+
+    T* _data() {
+        return std::launder(reinterpret_cast<T*>(mStorage));
+    }
+
+    const T* _data() const {
+        return std::launder(reinterpret_cast<const T*>(mStorage));
+    }
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* FIXED_CAPACITY_LIST_H */
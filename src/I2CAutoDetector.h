@@ -4,13 +4,34 @@
 #include "IAutoDetector.h"
 #include "I2cSensorMapping.h"
 #include <Wire.h>
+#include <algorithm>
 #include <array>
+#include <bitset>
+#include <tuple>
+#include <utility>
 
 namespace sensirion::upt::i2c_autodetect{
 
+/// Concatenate the candidate addresses (I2C_ADDRESSES) of the mappings, in
+/// order of the mappings
+template<typename...SensorMappingT>
+constexpr std::array<uint8_t, (SensorMappingT::I2C_ADDRESSES.size() + ... + 0)>
+collectCandidateAddresses(){
+  std::array<uint8_t, (SensorMappingT::I2C_ADDRESSES.size() + ... + 0)>
+    addresses{};
+  size_t i = 0;
+  ([&](){
+    for (const uint8_t address : SensorMappingT::I2C_ADDRESSES) {
+      addresses[i++] = address;
+    }
+  }(), ...);
+  return addresses;
+}
+
 /// Class to search registered sensors on the i2c bus
 ///
-/// @tparam ...SensorMappingT Address to sensor type mapping
+/// @tparam ...SensorMappingT Address to sensor type mapping, eg.
+/// SensorToAddressMapping or SensorToAddressesMapping
 template<typename...SensorMappingT>
 class I2CAutoDetector : public IAutoDetector {
 
@@ -18,16 +39,30 @@ class I2CAutoDetector : public IAutoDetector {
     /// defines the number of configured sensors
     static constexpr size_t CONFIGURED_SENSORS = sizeof...(SensorMappingT);
 
+    /// largest number of signal DataPoints delivered by a configured sensor
+    static constexpr size_t MAX_DATA_POINTS_PER_SENSOR = std::max(
+      {size_t(0),
+       MappingNumberOfDataPoints<SensorMappingT>::value...});
 
-    explicit I2CAutoDetector(TwoWire& wire):
-      _wire(wire),
-      mDetectionTable{createMappingInstance<SensorMappingT>(wire)...}{};
+    static_assert(MAX_DATA_POINTS_PER_SENSOR <=
+                    ISensor::MeasurementList::capacity(),
+                  "A configured sensor delivers more DataPoints than "
+                  "ISensor::MAX_NUMBER_OF_DATA_POINTS");
 
-    virtual ~I2CAutoDetector() {
-      for( auto entry : mDetectionTable){
-        delete entry;
-      }
-    }
+    /// candidate addresses of all configured sensors, in order of the
+    /// mappings
+    static constexpr auto CANDIDATE_ADDRESSES =
+      collectCandidateAddresses<SensorMappingT...>();
+
+    /**
+     * @param wire bus on which to search for sensors
+     *
+     * @param busId identifier of the bus, which is part of the SensorKey of
+     * the detected sensors. Must be unique among the detectors of a program.
+     */
+    explicit I2CAutoDetector(TwoWire& wire, uint8_t busId = 0):
+      _wire(wire), mBusId(busId),
+      mDetectionTable(wireFor<SensorMappingT>(wire)...){};
 
     /** 
      * Get the number of configured sensors
@@ -41,38 +76,135 @@ class I2CAutoDetector : public IAutoDetector {
     /**
      * @brief scan i2c bus for available sensors
      *
+     * The sensor of each mapping is stored in the slot of sensorList given by
+     * the index of the mapping. The candidate addresses of all sensors whose
+     * slot is free are collected into a bitmap, such that each
+     * address is probed once, even if several sensors map to it. The sensors
+     * are then matched against the addresses which acknowledged, by order of
+     * their candidate addresses. Addresses without a sensor are probed at
+     * most once per rescan interval (see setRescanInterval()).
+     *
      * @param sensorList SensorList to which add the found sensors
      */
     virtual void findSensors(SensorList& sensorList) override {
-      for (auto tableEntry:mDetectionTable){      
-        _wire.beginTransmission(tableEntry->getI2cAddress());
+      const uint32_t nowMs = millis();
+      const bool rescanDue = !mRescanned ||
+          nowMs - mLastRescanTimeStampMs >= mRescanIntervalMs;
+      if (rescanDue) {
+        mRescanned = true;
+        mLastRescanTimeStampMs = nowMs;
+      }
+
+      // Addresses to probe, excluding those occupied by handled sensors
+      AddressBitmap candidates;
+      AddressBitmap occupied;
+      forEachMapping([&](auto& mapping, const size_t slot){
+        if (sensorList.getSlot(slot)) {
+          occupied.set(mapping.getI2cAddress() & 0x7F);
+          return;
+        }
+        for (const uint8_t address : mapping.I2C_ADDRESSES) {
+          candidates.set(address & 0x7F);
+        }
+      });
+      candidates &= ~occupied;
+      if (!rescanDue) {
+        candidates.reset();
+      }
+
+      // Single sweep over the candidate addresses
+      AddressBitmap present;
+      for (uint8_t address = 0; address < candidates.size(); ++address) {
+        if (!candidates.test(address)) {
+          continue;
+        }
+        _wire.beginTransmission(address);
         const byte error = _wire.endTransmission();
-        if (error){
-            continue;
+        if (!error) {
+          present.set(address);
         }
-        sensorList.addSensor(&tableEntry->getSensor());
       }
+      mSkippedProbesCount = CANDIDATE_ADDRESSES.size() - candidates.count();
+
+      // Assign the responding addresses to the sensors
+      forEachMapping([&](auto& mapping, const size_t slot){
+        if (present.none() || sensorList.getSlot(slot)) {
+          return;
+        }
+        for (const uint8_t candidate : mapping.I2C_ADDRESSES) {
+          const uint8_t address = candidate & 0x7F;
+          if (!present.test(address)) {
+            continue;
+          }
+          mapping.bindI2cAddress(address);
+          sensorList.addSensor(&mapping.getSensor(),
+                               SensorKey{mBusId, address}, slot);
+          // A device may only be claimed by one sensor
+          present.reset(address);
+          break;
+        }
+      });
+    }
+
+    /**
+     * @brief Set the interval at which findSensors() probes the addresses
+     * without a sensor. Hot-plugged sensors are detected with at most this
+     * delay.
+     *
+     * @param[in] intervalMs rescan interval, 0 (default) probes on every
+     * call of findSensors()
+     */
+    void setRescanInterval(const uint32_t intervalMs) {
+      mRescanIntervalMs = intervalMs;
+    }
+
+    /**
+     * @brief getter method for the number of candidate address probes saved
+     * by the last call of findSensors(), because the sensor was already
+     * handled, the address was shared with another sensor or the rescan was
+     * not yet due
+     */
+    size_t getSkippedProbesCount() const {
+      return mSkippedProbesCount;
     }
   
 
   private:
-    using DetectableSensorsT = std::array<ISensorToAddressMapping*, 
-          sizeof...(SensorMappingT)>;
+    // The mappings are stored in place, such that their sensors are
+    // accessed without heap memory and virtual calls
+    using DetectableSensorsT = std::tuple<SensorMappingT...>;
+    using AddressBitmap = std::bitset<128>;
 
     TwoWire& _wire;
+    uint8_t mBusId;
     DetectableSensorsT mDetectionTable;
+    uint32_t mRescanIntervalMs = 0;
+    uint32_t mLastRescanTimeStampMs = 0;
+    bool mRescanned = false;
+    size_t mSkippedProbesCount = 0;
 
-    
-
-    /// Helper funciton to implement the initialisation of the detection table
+    /// Helper function to pass the bus to the constructor of each mapping
     ///
-    /// Required for fold expression
+    /// Required for pack expansion
     /// @tparam T The type of the SensorMapping to be constructed.
     /// @param wire Parameter to the constructor of T
-    /// @return A pointer of type ISensorToAddressMapping
+    /// @return wire
     template<typename T>
-    ISensorToAddressMapping* createMappingInstance(TwoWire& wire){
-      return new T(wire);
+    static TwoWire& wireFor(TwoWire& wire){
+      return wire;
+    }
+
+    /// Call f with each mapping of the detection table and its index, which
+    /// is also the slot of its sensor in the SensorList
+    template<typename F>
+    void forEachMapping(F&& f){
+      forEachMapping(std::forward<F>(f),
+                     std::index_sequence_for<SensorMappingT...>{});
+    }
+
+    template<typename F, size_t... I>
+    void forEachMapping(F&& f, std::index_sequence<I...>){
+      (f(std::get<I>(mDetectionTable), I), ...);
     }
 };
 } // namespace sensirion::upt::i2c_autodetect 
@@ -0,0 +1,68 @@
+#include "I2cCommand.h"
+#include "SensirionCore.h"
+
+namespace sensirion::upt::i2c_autodetect {
+
+namespace {
+
+constexpr size_t MAX_WORDS = 16;
+
+uint8_t crc8(const uint8_t* data) {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < 2; ++i) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31)
+                               : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+} // namespace
+
+uint16_t sendI2cCommand(TwoWire& wire, const uint8_t address,
+                        const uint16_t command, const uint8_t commandWidth,
+                        const uint16_t* args, const size_t numArgs) {
+    wire.beginTransmission(address);
+    if (commandWidth == 2) {
+        wire.write(static_cast<uint8_t>(command >> 8));
+    }
+    wire.write(static_cast<uint8_t>(command & 0xFF));
+    for (size_t i = 0; i < numArgs; ++i) {
+        const uint8_t word[2] = {static_cast<uint8_t>(args[i] >> 8),
+                                 static_cast<uint8_t>(args[i] & 0xFF)};
+        wire.write(word[0]);
+        wire.write(word[1]);
+        wire.write(crc8(word));
+    }
+    const uint8_t error = wire.endTransmission();
+    if (error) {
+        return HighLevelError::WriteError | error;
+    }
+    return HighLevelError::NoError;
+}
+
+uint16_t readI2cWords(TwoWire& wire, const uint8_t address, uint16_t* words,
+                      const size_t numWords) {
+    if (numWords > MAX_WORDS) {
+        return HighLevelError::ReadError | LowLevelError::BufferSizeError;
+    }
+    const uint8_t numBytes = static_cast<uint8_t>(3 * numWords);
+    if (wire.requestFrom(address, numBytes) < numBytes) {
+        return HighLevelError::ReadError | LowLevelError::NotEnoughDataError;
+    }
+    for (size_t i = 0; i < numWords; ++i) {
+        uint8_t word[3];
+        for (uint8_t& b : word) {
+            b = static_cast<uint8_t>(wire.read());
+        }
+        if (crc8(word) != word[2]) {
+            return HighLevelError::ReadError | LowLevelError::CRCError;
+        }
+        words[i] = static_cast<uint16_t>(word[0] << 8 | word[1]);
+    }
+    return HighLevelError::NoError;
+}
+
+} // namespace sensirion::upt::i2c_autodetect
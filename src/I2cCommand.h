@@ -0,0 +1,53 @@
+#ifndef I2C_COMMAND_H
+#define I2C_COMMAND_H
+
+#include <Wire.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect {
+
+/*
+ * Raw access to the Sensirion I2C command protocol, for the (rare) cases in
+ * which the sensor drivers only offer blocking calls. Words are transferred
+ * big endian, each followed by a CRC-8 (polynomial 0x31, init 0xFF).
+ */
+
+/**
+ * @brief send a command, without waiting for its execution
+ *
+ * @param[in] wire bus the sensor is connected to
+ *
+ * @param[in] address i2c address of the sensor
+ *
+ * @param[in] command command code
+ *
+ * @param[in] commandWidth number of bytes of the command code (1 or 2)
+ *
+ * @param[in] args command arguments, may be nullptr if numArgs is 0
+ *
+ * @param[in] numArgs number of arguments
+ *
+ * @return A uint16_t error corresponding to SensirionErrors.h of
+ * SensirionCore, where 0 value corresponds to no error.
+ */
+uint16_t sendI2cCommand(TwoWire& wire, uint8_t address, uint16_t command,
+                        uint8_t commandWidth, const uint16_t* args = nullptr,
+                        size_t numArgs = 0);
+
+/**
+ * @brief read the response of a previously sent command
+ *
+ * @param[out] words location to which write the received words
+ *
+ * @param[in] numWords number of words to read (at most 16)
+ *
+ * @return A uint16_t error corresponding to SensirionErrors.h of
+ * SensirionCore, where 0 value corresponds to no error.
+ */
+uint16_t readI2cWords(TwoWire& wire, uint8_t address, uint16_t* words,
+                      size_t numWords);
+
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* I2C_COMMAND_H */
@@ -4,29 +4,51 @@
 #include "IAutoDetector.h"
 #include <Wire.h>
 #include <array>
+#include <type_traits>
 #include <vector>
 
 namespace sensirion::upt::i2c_autodetect{
 
-/// This is the interface of an entry in the registration table
-/// that allows to map sensors to i2c addresses.
-/// We define this interface in order to allow type erasure.
-struct ISensorToAddressMapping{
-  using SensorRef = ISensor&;
+/// An entry of the registration table maps a sensor to its i2c addresses.
+/// I2CAutoDetector stores its mappings by their concrete types, such that no
+/// common base class is needed. Each mapping provides the constexpr array
+/// I2C_ADDRESSES of candidate addresses, getI2cAddress(), getSensor() and
+/// bindI2cAddress().
 
-  virtual uint8_t getI2cAddress() const = 0;
-  virtual SensorRef getSensor() = 0;
-  virtual ~ISensorToAddressMapping(){}
-};
+/// Number of signal DataPoints delivered by SensorT at most. Sensor classes
+/// which do not declare NUMBER_OF_DATA_POINTS are assumed to fill the whole
+/// ISensor::MeasurementList.
+template<typename SensorT, typename = void>
+struct NumberOfDataPoints
+    : std::integral_constant<size_t, ISensor::MAX_NUMBER_OF_DATA_POINTS>{};
+
+template<typename SensorT>
+struct NumberOfDataPoints<SensorT,
+                          std::void_t<decltype(SensorT::NUMBER_OF_DATA_POINTS)>>
+    : std::integral_constant<size_t, SensorT::NUMBER_OF_DATA_POINTS>{};
+
+/// Number of signal DataPoints delivered at most by the sensor of a mapping
+/// which declares its SensorType
+template<typename MappingT, typename = void>
+struct MappingNumberOfDataPoints
+    : std::integral_constant<size_t, ISensor::MAX_NUMBER_OF_DATA_POINTS>{};
+
+template<typename MappingT>
+struct MappingNumberOfDataPoints<MappingT,
+                                 std::void_t<typename MappingT::SensorType>>
+    : NumberOfDataPoints<typename MappingT::SensorType>{};
 
 /// Defines an entry int the sensor registation table.
 ///
 /// @tparam address The i2c address
 /// @tparam SensorT The sensor classe that lists on the specified i2c address
 template<uint8_t address, typename SensorT>
-struct SensorToAddressMapping: ISensorToAddressMapping{
+struct SensorToAddressMapping final{
 
+  using SensorType = SensorT;
+  using SensorRef = ISensor&;
   static constexpr uint8_t I2C_ADDRESS = address;
+  static constexpr std::array<uint8_t, 1> I2C_ADDRESSES{address};
 
   explicit SensorToAddressMapping(TwoWire& wire):
     mSensor(wire, I2C_ADDRESS){}
@@ -36,18 +58,68 @@ struct SensorToAddressMapping: ISensorToAddressMapping{
   SensorToAddressMapping(const SensorToAddressMapping&& other) = delete;
   SensorToAddressMapping& operator=(const SensorToAddressMapping& other) = delete;
 
-  
-  virtual uint8_t getI2cAddress()  const override{
+  uint8_t getI2cAddress() const{
     return I2C_ADDRESS;
   }
 
-  virtual SensorRef getSensor() override{
+  SensorRef getSensor(){
+    return mSensor;
+  }
+
+  /// The sensor only listens on I2C_ADDRESS
+  void bindI2cAddress(uint8_t){}
+
+  private:
+
+    SensorT mSensor;
+};
+
+/// Defines an entry in the sensor registration table for sensors which may
+/// respond at one of several i2c addresses (eg. product variants or address
+/// pins).
+///
+/// @tparam SensorT The sensor class that listens on one of the addresses. It
+/// must provide setI2cAddress(), taking effect at its next start().
+/// @tparam addresses The candidate i2c addresses, in order of preference
+template<typename SensorT, uint8_t... addresses>
+struct SensorToAddressesMapping final{
+  static_assert(sizeof...(addresses) > 0,
+                "At least one candidate address is required");
+
+  using SensorType = SensorT;
+  using SensorRef = ISensor&;
+  static constexpr std::array<uint8_t, sizeof...(addresses)> I2C_ADDRESSES{
+    addresses...};
+
+  explicit SensorToAddressesMapping(TwoWire& wire):
+    mSensor(wire, I2C_ADDRESSES[0]), mAddress(I2C_ADDRESSES[0]){}
+
+  /// No copy, assign, move
+  SensorToAddressesMapping(const SensorToAddressesMapping& other) = delete;
+  SensorToAddressesMapping(const SensorToAddressesMapping&& other) = delete;
+  SensorToAddressesMapping& operator=(
+    const SensorToAddressesMapping& other) = delete;
+
+  uint8_t getI2cAddress() const{
+    return mAddress;
+  }
+
+  SensorRef getSensor(){
     return mSensor;
   }
 
+  /// Bind the sensor to one of its candidate addresses, before it is added
+  /// to the SensorList, whose state machine starts it. The sensor is not
+  /// reconstructed, such that pointers to it and its driver stay valid.
+  void bindI2cAddress(const uint8_t address){
+    mSensor.setI2cAddress(address);
+    mAddress = address;
+  }
+
   private:
 
     SensorT mSensor;
+    uint8_t mAddress;
 };
 } // namespace sensirion::upt::i2c_autodetect 
 
@@ -12,9 +12,9 @@ class IAutoDetector {
      * @brief Scans bus for Sensirion sensors, initializes them and
      * adds them to the passed sensor list.
      *
-     * @note As the sensor list has a fixed length it might be that
-     * not all detected sensors get registered. Adapt the LENGTH
-     * in SensorList implementation in this case.
+     * @note As the sensor list has a fixed capacity it might be that
+     * not all detected sensors get registered. SensorManager sizes it
+     * with configuredSensorsCount().
      *
      * @param sensorList list to add detected sensors
      */
@@ -2,8 +2,8 @@
 #define I_SENSOR_H
 
 #include "Arduino.h"
+#include "FixedCapacityList.h"
 #include "Sensirion_UPT_Core.h"
-#include <vector>
 
 namespace sensirion::upt::i2c_autodetect{
 
@@ -14,9 +14,13 @@ class ISensor {
     static constexpr uint16_t NUMBER_OF_ALLOWED_CONSECUTIVE_ERRORS = 3;
 
   public:
+    // Largest number of signal DataPoints delivered by a sensor (SEN66). The
+    // I2CAutoDetector checks its sensor mappings against this bound.
+    static constexpr size_t MAX_NUMBER_OF_DATA_POINTS = 9;
 
     using DeviceType = core::DeviceType;
-    using MeasurementList = std::vector<core::Measurement>;
+    using MeasurementList =
+        FixedCapacityList<core::Measurement, MAX_NUMBER_OF_DATA_POINTS>;
 
     virtual ~ISensor() = default;
 
@@ -34,6 +38,26 @@ class ISensor {
      */
     virtual uint16_t initializationStep() = 0;
 
+    /**
+     * @brief Perform the next step of the sensor initialization
+     *
+     * Sensors which need to wait in between initialization commands (eg. after
+     * a reset) split initializationStep() into several steps, such that other
+     * sensors may be attended in the meantime. The default implementation
+     * performs initializationStep() in one go.
+     *
+     * @param[out] nextStepInMs 0 if the initialization is complete, else the
+     * time after which this method must be called again. A failed step
+     * restarts the initialization at the first step.
+     *
+     * @return A uint16_t error corresponding to SensirionErrors.h of
+     * SensirionCore, where 0 value corresponds to no error.
+     */
+    virtual uint16_t resumeInitialization(unsigned long& nextStepInMs) {
+        nextStepInMs = 0;
+        return initializationStep();
+    }
+
     /**
      * @brief Get the duration of the conditioning period
      *
@@ -53,8 +77,8 @@ class ISensor {
     /**
      * @brief Call driver methods to perform measurement and update DataPoints
      *
-     * @param measurements argument must be at least getNumberOfDataPoints()
-     * long
+     * @param measurements list to which append the DataPoints. Its capacity
+     * of MAX_NUMBER_OF_DATA_POINTS must not be exceeded.
      *
      * @param timeStamp at time of function call, represents milliseconds
      * passed since program startup.
@@ -65,6 +89,43 @@ class ISensor {
     virtual uint16_t measureAndWrite(MeasurementList& measurements,
                                      unsigned long timeStamp) = 0;
 
+    /**
+     * @brief Start a measurement without waiting for its result
+     *
+     * Together with fetchResult(), this splits measureAndWrite() in two
+     * phases, such that the conversion times of several sensors on the bus
+     * overlap. Sensors which do not support it keep the default
+     * implementation, which leaves the whole measurement to fetchResult().
+     *
+     * @param[out] readyInMs time after which the result may be fetched. 0 if
+     * fetchResult() may be called right away.
+     *
+     * @return A uint16_t error corresponding to SensirionErrors.h of
+     * SensirionCore, where 0 value corresponds to no error.
+     */
+    virtual uint16_t triggerMeasurement(unsigned long& readyInMs) {
+        readyInMs = 0;
+        return 0;
+    }
+
+    /**
+     * @brief Read out the measurement started with triggerMeasurement() and
+     * update DataPoints
+     *
+     * @param measurements list to which append the DataPoints. Its capacity
+     * of MAX_NUMBER_OF_DATA_POINTS must not be exceeded.
+     *
+     * @param timeStamp at time of the call of triggerMeasurement(),
+     * represents milliseconds passed since program startup.
+     *
+     * @return A uint16_t error corresponding to SensirionErrors.h of
+     * SensirionCore, where 0 value corresponds to no error.
+     */
+    virtual uint16_t fetchResult(MeasurementList& measurements,
+                                 unsigned long timeStamp) {
+        return measureAndWrite(measurements, timeStamp);
+    }
+
     /**
      * @brief Get the minimum measurement interval of the sensor. This must be
      * larger than the longest possible measurement duration.
@@ -118,6 +179,24 @@ class ISensor {
      * @return void*
      */
     virtual void* getDriver() = 0;
+
+  protected:
+    /**
+     * @brief Perform all steps of resumeInitialization(), waiting in between.
+     * Allows sensors overriding resumeInitialization() to implement
+     * initializationStep().
+     */
+    uint16_t initializeBlocking() {
+        unsigned long nextStepInMs = 0;
+        do {
+            delay(nextStepInMs);
+            const uint16_t error = resumeInitialization(nextStepInMs);
+            if (error) {
+                return error;
+            }
+        } while (nextStepInMs > 0);
+        return 0;
+    }
 };
 } // namespace sensirion::upt::i2c_autodetect 
 
@@ -0,0 +1,29 @@
+#ifndef I_SENSOR_HISTORY_H
+#define I_SENSOR_HISTORY_H
+
+#include "ISensor.h"
+#include "SensorKey.h"
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Interface of the storage to which SensorManager records every new set of
+ * sensor readings, see SensorManager::setHistory() */
+class ISensorHistory {
+  public:
+    virtual ~ISensorHistory() = default;
+
+    /**
+     * @brief record a new set of readings of a sensor
+     *
+     * @note Called on the acquisition path, must neither block nor allocate
+     *
+     * @param[in] key identity of the sensor
+     *
+     * @param[in] measurements readings of the sensor
+     */
+    virtual void record(const SensorKey& key,
+                        const ISensor::MeasurementList& measurements) = 0;
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* I_SENSOR_HISTORY_H */
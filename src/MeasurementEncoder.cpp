@@ -0,0 +1,104 @@
+#include "MeasurementEncoder.h"
+#include <cstring>
+
+namespace sensirion::upt::i2c_autodetect{
+
+MeasurementEncoder::MeasurementEncoder(uint8_t* buffer, const size_t capacity)
+    : mBuffer(buffer), mCapacity(capacity) {
+    // Header and end of batch
+    if (!mBuffer || mCapacity < 3) {
+        mCapacity = 0;
+        mFinished = true;
+        return;
+    }
+    _writeByte(FORMAT_MAGIC);
+    _writeByte(FORMAT_VERSION);
+}
+
+bool MeasurementEncoder::append(const SensorKey& key,
+                                const ISensor::MeasurementList& measurements) {
+    if (mFinished || measurements.empty()) {
+        return false;
+    }
+    const size_t size = mSize;
+    const uint32_t lastTimeStamp = mLastTimeStamp;
+
+    const core::MetaData& metaData = measurements[0].metaData;
+    const char* label = core::deviceLabel(metaData.deviceType);
+    const size_t labelLength = label ? strnlen(label, UINT8_MAX) : 0;
+    bool fits = _writeVarint(measurements.size()) &&
+                _writeByte(key.busId) && _writeByte(key.i2cAddress) &&
+                _writeVarint(metaData.deviceID) &&
+                _writeByte(static_cast<uint8_t>(labelLength));
+    for (size_t i = 0; fits && i < labelLength; ++i) {
+        fits = _writeByte(static_cast<uint8_t>(label[i]));
+    }
+
+    for (size_t i = 0; fits && i < measurements.size(); ++i) {
+        const core::Measurement& measurement = measurements[i];
+        const uint32_t timeStamp =
+            static_cast<uint32_t>(measurement.dataPoint.t_offset);
+        // Wraps around like the time stamps themselves
+        const int32_t delta = static_cast<int32_t>(timeStamp - mLastTimeStamp);
+        mLastTimeStamp = timeStamp;
+        fits = _writeVarint(static_cast<uint32_t>(measurement.signalType)) &&
+               _writeZigzag(delta) && _writeFloat(measurement.dataPoint.value);
+    }
+
+    if (!fits) {
+        mSize = size;
+        mLastTimeStamp = lastTimeStamp;
+        mNumberOfDroppedSensors++;
+        return false;
+    }
+    mNumberOfSensors++;
+    return true;
+}
+
+size_t MeasurementEncoder::finish() {
+    if (mCapacity == 0) {
+        return 0;
+    }
+    if (!mFinished) {
+        // The last byte of the buffer is reserved for the end of the batch
+        mBuffer[mSize++] = END_OF_BATCH;
+        mFinished = true;
+    }
+    return mSize;
+}
+
+bool MeasurementEncoder::_writeByte(const uint8_t byte) {
+    if (mSize + 1 >= mCapacity) {
+        return false;
+    }
+    mBuffer[mSize++] = byte;
+    return true;
+}
+
+bool MeasurementEncoder::_writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        if (!_writeByte(static_cast<uint8_t>(value) | 0x80)) {
+            return false;
+        }
+        value >>= 7;
+    }
+    return _writeByte(static_cast<uint8_t>(value));
+}
+
+bool MeasurementEncoder::_writeZigzag(const int32_t value) {
+    const uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^
+                            static_cast<uint32_t>(value >> 31);
+    return _writeVarint(zigzag);
+}
+
+bool MeasurementEncoder::_writeFloat(const float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (size_t i = 0; i < sizeof(bits); ++i) {
+        if (!_writeByte(static_cast<uint8_t>(bits >> (8 * i)))) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace sensirion::upt::i2c_autodetect
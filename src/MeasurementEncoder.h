@@ -0,0 +1,107 @@
+#ifndef MEASUREMENT_ENCODER_H
+#define MEASUREMENT_ENCODER_H
+
+#include "ISensor.h"
+#include "SensorKey.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Encoder of sensor readings into a compact binary batch, written into a
+ * buffer provided by the caller without allocating. The metadata of each
+ * sensor is written once, followed by its signals.
+ *
+ * Batch format (varint: unsigned LEB128, zigzag: signed varint):
+ *
+ *   batch  := FORMAT_MAGIC FORMAT_VERSION sensor* 0x00
+ *   sensor := varint number of signals (> 0)
+ *             uint8 bus id, uint8 I2C address, varint deviceID
+ *             uint8 label length, DeviceType label (not terminated)
+ *             signal*
+ *   signal := varint SignalType
+ *             zigzag time stamp minus the time stamp of the previous signal
+ *                    of the batch (0 for the first signal), in ms
+ *             float32 value, little endian
+ *
+ * The time stamps are the milliseconds passed since program startup, as in
+ * core::DataPoint. Signals of a sensor usually share their time stamp, such
+ * that most deltas take a single byte.
+ *
+ * A batch is decoded by MeasurementDecoder of the host build
+ * (extras/host). */
+class MeasurementEncoder {
+  public:
+    static constexpr uint8_t FORMAT_MAGIC = 0xB5;
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr uint8_t END_OF_BATCH = 0x00;
+
+    /**
+     * @brief constructor, writes the batch header
+     *
+     * @param[in] buffer memory into which the batch is written
+     *
+     * @param[in] capacity size of buffer in bytes
+     */
+    MeasurementEncoder(uint8_t* buffer, size_t capacity);
+
+    /**
+     * @brief append the readings of a sensor to the batch
+     *
+     * @param[in] key identity of the sensor
+     *
+     * @param[in] measurements readings of the sensor, of which the metadata
+     * of the first entry is encoded
+     *
+     * @returns False if the sensor does not fit into the buffer, in which
+     * case the batch is left unchanged
+     */
+    bool append(const SensorKey& key,
+                const ISensor::MeasurementList& measurements);
+
+    /**
+     * @brief terminate the batch
+     *
+     * @note No sensor can be appended after the batch is terminated
+     *
+     * @returns The size of the batch in bytes, 0 if the buffer is too small
+     * to hold an empty batch
+     */
+    size_t finish();
+
+    /**
+     * @brief getter method for the number of sensors in the batch
+     */
+    size_t getNumberOfSensors() const {
+        return mNumberOfSensors;
+    }
+
+    /**
+     * @brief getter method for the number of sensors which were left out
+     * because they did not fit into the buffer
+     */
+    size_t getNumberOfDroppedSensors() const {
+        return mNumberOfDroppedSensors;
+    }
+
+  private:
+    uint8_t* mBuffer;
+    size_t mCapacity;
+    size_t mSize = 0;
+    uint32_t mLastTimeStamp = 0;
+    size_t mNumberOfSensors = 0;
+    size_t mNumberOfDroppedSensors = 0;
+    bool mFinished = false;
+
+    /**
+     * @brief write primitives, failing without writing if the buffer
+     * (minus the byte reserved for the end of the batch) is full
+     */
+    bool _writeByte(uint8_t byte);
+    bool _writeVarint(uint64_t value);
+    bool _writeZigzag(int32_t value);
+    bool _writeFloat(float value);
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* MEASUREMENT_ENCODER_H */
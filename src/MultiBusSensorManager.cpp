@@ -0,0 +1,212 @@
+#include "MultiBusSensorManager.h"
+
+namespace sensirion::upt::i2c_autodetect{
+
+constexpr auto TAG = "MultiBusSensorManager";
+
+MultiBusSensorManager::MultiBusSensorManager(
+    std::initializer_list<std::reference_wrapper<IAutoDetector>> detectors) {
+    mBuses.reserve(detectors.size());
+    for (IAutoDetector& detector : detectors) {
+        mBuses.push_back(std::make_unique<Bus>(detector));
+    }
+}
+
+void MultiBusSensorManager::_runBusOperation(void* pBus) {
+    Bus* bus = static_cast<Bus*>(pBus);
+    switch (bus->operation) {
+        case BusOperation::REFRESH:
+            bus->manager.refreshConnectedSensors();
+            break;
+        case BusOperation::EXECUTE:
+            bus->manager.executeSensorCommunication();
+            break;
+        case BusOperation::COLLECT:
+            bus->manager.collectPendingMeasurements();
+            break;
+        case BusOperation::REFRESH_AND_EXECUTE:
+            bus->manager.refreshConnectedSensors();
+            bus->manager.executeSensorCommunication();
+            break;
+        default:
+            break;
+    }
+}
+
+void MultiBusSensorManager::_detachSharedHistories() {
+    for (size_t i = 1; i < mBuses.size(); ++i) {
+        ISensorHistory* history = mBuses[i]->manager.getHistory();
+        for (size_t j = 0; history && j < i; ++j) {
+            if (mBuses[j]->manager.getHistory() == history) {
+                ESP_LOGE(TAG,
+                         "Buses %u and %u share a history, which is not "
+                         "synchronized. Detaching it from bus %u.",
+                         static_cast<unsigned>(j), static_cast<unsigned>(i),
+                         static_cast<unsigned>(i));
+                mBuses[i]->manager.setHistory(nullptr);
+                history = nullptr;
+            }
+        }
+    }
+}
+
+void MultiBusSensorManager::_runOnAllBuses(const BusOperation operation) {
+    if (mBuses.empty()) {
+        return;
+    }
+    _detachSharedHistories();
+    for (size_t i = 1; i < mBuses.size(); ++i) {
+        mBuses[i]->operation = operation;
+        mBuses[i]->worker.dispatch(&_runBusOperation, mBuses[i].get());
+    }
+    // The first bus is attended by the calling task
+    mBuses[0]->operation = operation;
+    _runBusOperation(mBuses[0].get());
+    for (size_t i = 1; i < mBuses.size(); ++i) {
+        mBuses[i]->worker.join();
+    }
+    _publishFreshReadings();
+}
+
+void MultiBusSensorManager::_publishFreshReadings() {
+    for (const auto& bus : mBuses) {
+        bus->publishedGeneration = bus->manager.forEachFreshReading(
+            bus->publishedGeneration,
+            [this](const SensorKey& key, const core::DeviceType deviceType,
+                   const MeasurementList& measurements) {
+                if (mHistory) {
+                    mHistory->record(key, measurements);
+                }
+                if (!mSubscriptions.empty()) {
+                    mSubscriptions.notify(key, deviceType, measurements);
+                }
+            });
+    }
+}
+
+void MultiBusSensorManager::refreshConnectedSensors() {
+    _runOnAllBuses(BusOperation::REFRESH);
+}
+
+void MultiBusSensorManager::executeSensorCommunication() {
+    _runOnAllBuses(BusOperation::EXECUTE);
+}
+
+void MultiBusSensorManager::collectPendingMeasurements() {
+    _runOnAllBuses(BusOperation::COLLECT);
+}
+
+unsigned long MultiBusSensorManager::nextWakeupMs() const {
+    unsigned long wakeupMs = ~0UL;
+    for (const auto& bus : mBuses) {
+        wakeupMs = std::min(wakeupMs, bus->manager.nextWakeupMs());
+    }
+    return mBuses.empty() ? 0 : wakeupMs;
+}
+
+void MultiBusSensorManager::getSensorReadings(
+    const MeasurementList* dataHashmap[]) {
+    size_t offset = 0;
+    for (const auto& bus : mBuses) {
+        bus->manager.getSensorReadings(dataHashmap + offset);
+        offset += bus->detector.configuredSensorsCount();
+    }
+}
+
+void MultiBusSensorManager::refreshAndGetSensorReadings(
+    const MeasurementList* dataHashmap[]) {
+    _runOnAllBuses(BusOperation::REFRESH_AND_EXECUTE);
+    getSensorReadings(dataHashmap);
+}
+
+size_t MultiBusSensorManager::encodeSensorReadings(uint8_t* buffer,
+                                                   const size_t capacity) const {
+    MeasurementEncoder encoder(buffer, capacity);
+    for (const auto& bus : mBuses) {
+        bus->manager.appendToSensorFrame(encoder);
+    }
+    return encoder.finish();
+}
+
+size_t MultiBusSensorManager::encodeSensorReadings(TextEncoder& encoder) const {
+    for (const auto& bus : mBuses) {
+        bus->manager.appendToSensorFrame(encoder);
+    }
+    return encoder.finish();
+}
+
+void MultiBusSensorManager::setInterval(const unsigned long interval,
+                                        const core::DeviceType deviceType) {
+    for (const auto& bus : mBuses) {
+        bus->manager.setInterval(interval, deviceType);
+    }
+}
+
+void MultiBusSensorManager::setInterval(const unsigned long interval,
+                                        const SensorKey& key) {
+    for (const auto& bus : mBuses) {
+        bus->manager.setInterval(interval, key);
+    }
+}
+
+void MultiBusSensorManager::setAdaptiveInterval(
+    const AdaptiveInterval& adaptiveInterval,
+    const core::DeviceType deviceType) {
+    for (const auto& bus : mBuses) {
+        bus->manager.setAdaptiveInterval(adaptiveInterval, deviceType);
+    }
+}
+
+void MultiBusSensorManager::setAdaptiveInterval(
+    const AdaptiveInterval& adaptiveInterval, const SensorKey& key) {
+    for (const auto& bus : mBuses) {
+        bus->manager.setAdaptiveInterval(adaptiveInterval, key);
+    }
+}
+
+void MultiBusSensorManager::setHistory(ISensorHistory* history) {
+    mHistory = history;
+}
+
+ISensorHistory* MultiBusSensorManager::getHistory() const {
+    return mHistory;
+}
+
+int MultiBusSensorManager::subscribe(
+    const SensorKey& key, const SensorSubscriptions::SensorCallback callback,
+    void* context) {
+    return mSubscriptions.subscribe(key, callback, context);
+}
+
+int MultiBusSensorManager::subscribe(
+    const core::DeviceType deviceType,
+    const SensorSubscriptions::SensorCallback callback, void* context) {
+    return mSubscriptions.subscribe(deviceType, callback, context);
+}
+
+int MultiBusSensorManager::subscribe(
+    const core::SignalType signalType,
+    const SensorSubscriptions::SignalCallback callback, void* context) {
+    return mSubscriptions.subscribe(signalType, callback, context);
+}
+
+void MultiBusSensorManager::unsubscribe(const int id) {
+    mSubscriptions.unsubscribe(id);
+}
+
+size_t MultiBusSensorManager::getMaxNumberOfSensors() const {
+    size_t count = 0;
+    for (const auto& bus : mBuses) {
+        count += bus->detector.configuredSensorsCount();
+    }
+    return count;
+}
+
+size_t MultiBusSensorManager::getNumberOfBuses() const {
+    return mBuses.size();
+}
+
+SensorManager& MultiBusSensorManager::getSensorManager(const size_t bus) {
+    return mBuses[bus]->manager;
+}
+} // namespace sensirion::upt::i2c_autodetect
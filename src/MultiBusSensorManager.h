@@ -0,0 +1,282 @@
+#ifndef MULTI_BUS_SENSOR_MANAGER_H
+#define MULTI_BUS_SENSOR_MANAGER_H
+
+#include "BusWorker.h"
+#include "SensorManager.h"
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Class to manage the sensors connected to several I2C buses. Each bus is
+ * handled by its own SensorManager, and the buses are attended in parallel:
+ * the first bus on the calling task, the others on a BusWorker each. The
+ * readings of all buses are merged into one hashmap.
+ *
+ * Threading: the methods return once all buses are done, and the history
+ * and subscriptions of MultiBusSensorManager are served on the calling task
+ * after that, such that neither needs to be synchronized. Histories and
+ * subscriptions set on the SensorManager of a bus (getSensorManager()) are
+ * served on the worker task of the bus instead. */
+class MultiBusSensorManager {
+  public:
+    using MeasurementList = SensorManager::MeasurementList;
+
+    /**
+     * @brief constructor
+     *
+     * @param[in] detectors one detector per bus, eg.
+     * MultiBusSensorManager manager({detectorWire, detectorWire1});
+     *
+     * @note Give the detectors distinct bus ids, such that sensors can be
+     * addressed by SensorKey
+     */
+    MultiBusSensorManager(
+        std::initializer_list<std::reference_wrapper<IAutoDetector>>
+            detectors);
+
+    MultiBusSensorManager(const MultiBusSensorManager&) = delete;
+    MultiBusSensorManager&
+    operator=(const MultiBusSensorManager&) = delete;
+
+    /**
+     * @brief Remove lost sensors and check all buses for connected sensors
+     */
+    void refreshConnectedSensors();
+
+    /**
+     * @brief Updates the sensor state machines which are due, on all buses
+     * in parallel
+     */
+    void executeSensorCommunication();
+
+    /**
+     * @brief Wait for the pending measurements on all buses in parallel, see
+     * SensorManager::collectPendingMeasurements()
+     */
+    void collectPendingMeasurements();
+
+    /**
+     * @brief Time until the next sensor state machine update is due on any
+     * bus, see SensorManager::nextWakeupMs()
+     */
+    unsigned long nextWakeupMs() const;
+
+    /**
+     * @brief obtain a hashmap of read-only pointers to the sensor signal
+     * readings of all buses.
+     *
+     * @param[in] dataHashmap location to which write the references to the
+     * individual state machines data. The entries of bus i follow those of
+     * bus i-1. Size of the hashmap can be queried using
+     * MultiBusSensorManager::getMaxNumberOfSensors().
+     */
+    void getSensorReadings(const MeasurementList* dataHashmap[]);
+
+    /**
+     * @brief convenience function performing the sensor list refresh, state
+     * machine update and data window setup, on all buses in parallel
+     */
+    void refreshAndGetSensorReadings(const MeasurementList* dataHashmap[]);
+
+    /**
+     * @brief obtain a columnar snapshot of the sensor signal readings of all
+     * buses, see SensorManager::getSensorFrame()
+     */
+    template <class FrameT>
+    void getSensorFrame(FrameT& frame) const {
+        frame.clear();
+        for (const auto& bus : mBuses) {
+            bus->manager.appendToSensorFrame(frame);
+        }
+    }
+
+    /**
+     * @brief publish a snapshot of the sensor signal readings of all buses to
+     * reader tasks, see SensorManager::publishSensorFrame()
+     */
+    template <class SharedFrameT>
+    void publishSensorFrame(SharedFrameT& shared) const {
+        getSensorFrame(shared.beginWrite());
+        shared.endWrite();
+    }
+
+    /**
+     * @brief encode the sensor signal readings of all buses into a compact
+     * binary batch, see SensorManager::encodeSensorReadings()
+     */
+    size_t encodeSensorReadings(uint8_t* buffer, size_t capacity) const;
+
+    /**
+     * @brief write the sensor signal readings of all buses as text, see
+     * SensorManager::encodeSensorReadings()
+     */
+    size_t encodeSensorReadings(TextEncoder& encoder) const;
+
+    /**
+     * @brief Sets polling interval for the specified sensor type on all buses,
+     * see SensorManager::setInterval()
+     */
+    void setInterval(unsigned long interval, core::DeviceType deviceType);
+
+    /**
+     * @brief Sets polling interval for a particular sensor instance, see
+     * SensorManager::setInterval()
+     */
+    void setInterval(unsigned long interval, const SensorKey& key);
+
+    /**
+     * @brief Let the polling interval of the specified sensor type adapt to
+     * the dynamics of its signals on all buses, see
+     * SensorManager::setAdaptiveInterval()
+     */
+    void setAdaptiveInterval(const AdaptiveInterval& adaptiveInterval,
+                             core::DeviceType deviceType);
+
+    /**
+     * @brief Let the polling interval of a particular sensor instance adapt
+     * to the dynamics of its signals, see
+     * SensorManager::setAdaptiveInterval()
+     */
+    void setAdaptiveInterval(const AdaptiveInterval& adaptiveInterval,
+                             const SensorKey& key);
+
+    /**
+     * @brief visit the latency histograms and counters of the sensors of all
+     * buses, see SensorManager::getStatistics()
+     *
+     * @note Must not be called concurrently with the methods of
+     * MultiBusSensorManager
+     */
+    template <typename Visitor>
+    void getStatistics(Visitor&& visitor) const {
+        for (const auto& bus : mBuses) {
+            bus->manager.getStatistics(visitor);
+        }
+    }
+
+    /**
+     * @brief Set the history to which every new set of readings of all buses
+     * is recorded, see SensorManager::setHistory()
+     *
+     * @note Recorded on the calling task once all buses are done, such that
+     * one history serves all buses
+     */
+    void setHistory(ISensorHistory* history);
+
+    /**
+     * @brief getter method for the history set with setHistory(), nullptr
+     * if none
+     */
+    ISensorHistory* getHistory() const;
+
+    /**
+     * @brief Subscribe for the readings of a particular sensor on any bus,
+     * see SensorManager::subscribe()
+     *
+     * @note The callback is invoked on the calling task once all buses are
+     * done
+     */
+    int subscribe(const SensorKey& key,
+                  SensorSubscriptions::SensorCallback callback,
+                  void* context = nullptr);
+
+    /**
+     * @brief Subscribe for the readings of all sensors of a DeviceType, see
+     * subscribe(const SensorKey&, ...)
+     */
+    int subscribe(core::DeviceType deviceType,
+                  SensorSubscriptions::SensorCallback callback,
+                  void* context = nullptr);
+
+    /**
+     * @brief Subscribe for the readings of a signal from all sensors
+     * measuring it, see subscribe(const SensorKey&, ...)
+     */
+    int subscribe(core::SignalType signalType,
+                  SensorSubscriptions::SignalCallback callback,
+                  void* context = nullptr);
+
+    /**
+     * @brief Remove a subscription
+     *
+     * @param[in] id subscription id returned by subscribe()
+     */
+    void unsubscribe(int id);
+
+    /**
+     * @brief getter method for the size of the hashmap passed to
+     * getSensorReadings(), ie. the number of sensors configured on all buses
+     */
+    size_t getMaxNumberOfSensors() const;
+
+    /**
+     * @brief getter method for the number of buses
+     */
+    size_t getNumberOfBuses() const;
+
+    /**
+     * @brief getter method for the SensorManager of a bus, eg. to retrieve
+     * sensor drivers
+     *
+     * @note Must not be called concurrently with the methods of
+     * MultiBusSensorManager. Histories set with SensorManager::setHistory()
+     * must be distinct per bus, a history shared with a previous bus is
+     * detached. Prefer MultiBusSensorManager::setHistory() and
+     * MultiBusSensorManager::subscribe(), which are served on the calling
+     * task.
+     */
+    SensorManager& getSensorManager(size_t bus);
+
+  private:
+    enum class BusOperation {
+        REFRESH,
+        EXECUTE,
+        COLLECT,
+        REFRESH_AND_EXECUTE
+    };
+
+    struct Bus {
+        explicit Bus(IAutoDetector& detector)
+            : detector(detector), manager(detector){};
+        IAutoDetector& detector;
+        SensorManager manager;
+        BusWorker worker;
+        BusOperation operation = BusOperation::EXECUTE;
+        // Generation of the bus up to which the readings were recorded to
+        // the history and notified to the subscribers
+        uint32_t publishedGeneration = 0;
+    };
+
+    std::vector<std::unique_ptr<Bus>> mBuses;
+    ISensorHistory* mHistory = nullptr;
+    SensorSubscriptions mSubscriptions;
+
+    /**
+     * @brief detach the history of the buses sharing it with a previous bus,
+     * since the buses record to their histories in parallel
+     */
+    void _detachSharedHistories();
+
+    /**
+     * @brief record the readings of all buses updated since the previous
+     * call to the history and notify the subscribers, on the calling task
+     */
+    void _publishFreshReadings();
+
+    /**
+     * @brief execute an operation on all buses in parallel, wait for its
+     * completion and publish the new readings
+     */
+    void _runOnAllBuses(BusOperation operation);
+
+    /**
+     * @brief execute the pending operation of a bus, BusWorker::Job
+     */
+    static void _runBusOperation(void* pBus);
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* MULTI_BUS_SENSOR_MANAGER_H */
@@ -0,0 +1,317 @@
+#include "SampleLog.h"
+
+#include <Arduino.h>
+#include <cerrno>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace sensirion::upt::i2c_autodetect{
+
+constexpr auto TAG = "SampleLog";
+constexpr auto SEGMENT_SUFFIX = ".slg";
+constexpr size_t MAX_PATH_LENGTH = 96;
+
+SampleLog::SampleLog(const char* directory, const uint32_t blocksPerSegment,
+                     const uint32_t maxSegments)
+    : mDirectory(directory),
+      mBlocksPerSegment(blocksPerSegment > 0 ? blocksPerSegment : 1),
+      mMaxSegments(maxSegments > 0 ? maxSegments : 1) {
+}
+
+SampleLog::~SampleLog() {
+    if (mSegmentFile) {
+        fclose(mSegmentFile);
+    }
+    if (mReadFile) {
+        fclose(mReadFile);
+    }
+}
+
+bool SampleLog::begin() {
+    if (mkdir(mDirectory, 0755) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "Cannot create directory %s", mDirectory);
+        return false;
+    }
+    DIR* dir = opendir(mDirectory);
+    if (!dir) {
+        ESP_LOGE(TAG, "Cannot open directory %s", mDirectory);
+        return false;
+    }
+    bool found = false;
+    uint32_t first = 0;
+    uint32_t last = 0;
+    while (const dirent* entry = readdir(dir)) {
+        unsigned int segment = 0;
+        char suffix[8] = {};
+        if (sscanf(entry->d_name, "%8x%7s", &segment, suffix) != 2 ||
+            strcmp(suffix, SEGMENT_SUFFIX) != 0) {
+            continue;
+        }
+        if (!found || segment < first) {
+            first = segment;
+        }
+        if (!found || segment > last) {
+            last = segment;
+        }
+        found = true;
+    }
+    closedir(dir);
+
+    // Never append to an existing segment, its last block may be torn
+    const uint32_t next = found ? last + 1 : 0;
+    mFirstSegment = found ? first : next;
+    mLastSegment = next;
+    mBlocksInSegment = 0;
+    return true;
+}
+
+SampleLog::Block* SampleLog::_activeBlock() {
+    const uint32_t sealed = mSealed.load(std::memory_order_relaxed);
+    if (sealed - mWritten.load(std::memory_order_acquire) >=
+        NUMBER_OF_BUFFERED_BLOCKS) {
+        return nullptr;
+    }
+    Block& block = mBlocks[sealed % NUMBER_OF_BUFFERED_BLOCKS];
+    if (block.header.magic != BLOCK_MAGIC) {
+        // Unused blocks are zeroed, such that the files are deterministic
+        memset(&block, 0, sizeof(block));
+        block.header.magic = BLOCK_MAGIC;
+        block.header.version = FORMAT_VERSION;
+    }
+    return &block;
+}
+
+void SampleLog::_seal() {
+    const uint32_t sealed = mSealed.load(std::memory_order_relaxed);
+    if (sealed - mWritten.load(std::memory_order_acquire) >=
+        NUMBER_OF_BUFFERED_BLOCKS) {
+        return;
+    }
+    Block& block = mBlocks[sealed % NUMBER_OF_BUFFERED_BLOCKS];
+    if (block.header.magic != BLOCK_MAGIC ||
+        block.header.numberOfRecords == 0) {
+        return;
+    }
+    mSealed.store(sealed + 1, std::memory_order_release);
+}
+
+void SampleLog::record(const SensorKey& key,
+                       const ISensor::MeasurementList& measurements) {
+    _append(key, measurements);
+    if (mDownstreamHistory) {
+        mDownstreamHistory->record(key, measurements);
+    }
+}
+
+void SampleLog::_append(const SensorKey& key,
+                        const ISensor::MeasurementList& measurements) {
+    if (measurements.empty()) {
+        return;
+    }
+    const core::MetaData& metaData = measurements[0].metaData;
+    for (bool retry = true;; retry = false) {
+        Block* block = _activeBlock();
+        if (!block) {
+            mDroppedCount += measurements.size();
+            return;
+        }
+        BlockHeader& header = block->header;
+        const size_t sensorIndex = _sensorIndex(*block, key, metaData);
+        bool fits = sensorIndex < MAX_SENSORS_PER_BLOCK &&
+                    header.numberOfRecords + measurements.size() <=
+                        RECORDS_PER_BLOCK;
+        if (header.numberOfRecords == 0) {
+            header.baseTimeMs =
+                mTimeOffsetMs + measurements[0].dataPoint.t_offset;
+        }
+        for (size_t i = 0; fits && i < measurements.size(); ++i) {
+            const int64_t delta = static_cast<int64_t>(
+                mTimeOffsetMs + measurements[i].dataPoint.t_offset -
+                header.baseTimeMs);
+            fits = delta >= INT32_MIN && delta <= INT32_MAX;
+        }
+        if (!fits) {
+            if (retry && header.numberOfRecords > 0) {
+                // Continue in the next block
+                _seal();
+                continue;
+            }
+            mDroppedCount += measurements.size();
+            return;
+        }
+
+        for (const auto& measurement : measurements) {
+            const uint64_t timeMs =
+                mTimeOffsetMs + measurement.dataPoint.t_offset;
+            Record& record = block->records[header.numberOfRecords];
+            record.timeDeltaMs =
+                static_cast<int32_t>(timeMs - header.baseTimeMs);
+            record.value = measurement.dataPoint.value;
+            record.sensorIndex = static_cast<uint8_t>(sensorIndex);
+            record.signalType = static_cast<uint8_t>(measurement.signalType);
+            if (header.numberOfRecords == 0 || timeMs < header.minTimeMs) {
+                header.minTimeMs = timeMs;
+            }
+            if (header.numberOfRecords == 0 || timeMs > header.maxTimeMs) {
+                header.maxTimeMs = timeMs;
+            }
+            header.numberOfRecords++;
+        }
+        if (header.numberOfRecords == RECORDS_PER_BLOCK) {
+            _seal();
+        }
+        return;
+    }
+}
+
+size_t SampleLog::_sensorIndex(Block& block, const SensorKey& key,
+                               const core::MetaData& metaData) {
+    BlockHeader& header = block.header;
+    for (size_t i = 0; i < header.numberOfSensors; ++i) {
+        const SensorEntry& entry = block.sensors[i];
+        if (entry.busId == key.busId && entry.i2cAddress == key.i2cAddress &&
+            entry.deviceID == metaData.deviceID) {
+            return i;
+        }
+    }
+    if (header.numberOfSensors >= MAX_SENSORS_PER_BLOCK) {
+        return MAX_SENSORS_PER_BLOCK;
+    }
+    SensorEntry& entry = block.sensors[header.numberOfSensors];
+    entry.deviceID = metaData.deviceID;
+    entry.busId = key.busId;
+    entry.i2cAddress = key.i2cAddress;
+    const char* label = core::deviceLabel(metaData.deviceType);
+    if (label) {
+        strncpy(entry.label, label, LABEL_LENGTH - 1);
+    }
+    return header.numberOfSensors++;
+}
+
+void SampleLog::flush() {
+    _seal();
+}
+
+size_t SampleLog::sync() {
+    size_t numberOfBlocks = 0;
+    uint32_t written = mWritten.load(std::memory_order_relaxed);
+    while (written != mSealed.load(std::memory_order_acquire)) {
+        Block& block = mBlocks[written % NUMBER_OF_BUFFERED_BLOCKS];
+        if (!_writeBlock(block)) {
+            // Keep the block, and with it further readings, until the
+            // file system recovers
+            break;
+        }
+        // Mark the block as unused for _activeBlock()
+        block.header.magic = 0;
+        mWritten.store(++written, std::memory_order_release);
+        numberOfBlocks++;
+    }
+    return numberOfBlocks;
+}
+
+bool SampleLog::_writeBlock(Block& block) {
+    char path[MAX_PATH_LENGTH];
+    if (mSegmentFile && mBlocksInSegment >= mBlocksPerSegment) {
+        fclose(mSegmentFile);
+        mSegmentFile = nullptr;
+        mLastSegment.store(mLastSegment.load() + 1);
+        mBlocksInSegment = 0;
+    }
+    if (!mSegmentFile) {
+        const uint32_t last = mLastSegment.load();
+        // Delete the oldest segments beyond the limit
+        while (last - mFirstSegment.load() >= mMaxSegments) {
+            const uint32_t first = mFirstSegment.load();
+            mFirstSegment.store(first + 1);
+            _segmentPath(first, path, sizeof(path));
+            remove(path);
+        }
+        _segmentPath(last, path, sizeof(path));
+        mSegmentFile = fopen(path, "ab");
+        if (!mSegmentFile) {
+            ESP_LOGE(TAG, "Cannot open segment %s", path);
+            return false;
+        }
+    }
+
+    block.header.checksum = _checksum(block);
+    if (fwrite(&block, sizeof(block), 1, mSegmentFile) != 1 ||
+        fflush(mSegmentFile) != 0) {
+        ESP_LOGE(TAG, "Cannot write segment %" PRIu32,
+                 mLastSegment.load());
+        // Continue in a new segment, the current one may end torn
+        fclose(mSegmentFile);
+        mSegmentFile = nullptr;
+        mLastSegment.store(mLastSegment.load() + 1);
+        mBlocksInSegment = 0;
+        return false;
+    }
+    mBlocksInSegment++;
+    return true;
+}
+
+SampleLog::BlockLoad SampleLog::_loadBlock(const uint32_t segment,
+                                           const uint32_t index,
+                                           const uint64_t fromMs,
+                                           const uint64_t toMs) {
+    if (!mReadFile || mReadSegment != segment) {
+        if (mReadFile) {
+            fclose(mReadFile);
+        }
+        char path[MAX_PATH_LENGTH];
+        _segmentPath(segment, path, sizeof(path));
+        mReadFile = fopen(path, "rb");
+        mReadSegment = segment;
+        if (!mReadFile) {
+            return BlockLoad::END_OF_SEGMENT;
+        }
+    }
+
+    // Only the header is read for blocks outside the time range
+    BlockHeader& header = mReadBlock.header;
+    if (fseek(mReadFile, static_cast<long>(index) * BLOCK_SIZE, SEEK_SET) !=
+            0 ||
+        fread(&header, sizeof(header), 1, mReadFile) != 1) {
+        return BlockLoad::END_OF_SEGMENT;
+    }
+    if (header.magic != BLOCK_MAGIC || header.version != FORMAT_VERSION ||
+        header.maxTimeMs < fromMs || header.minTimeMs > toMs) {
+        return BlockLoad::SKIPPED;
+    }
+    if (fread(reinterpret_cast<uint8_t*>(&mReadBlock) + sizeof(header),
+              BLOCK_SIZE - sizeof(header), 1, mReadFile) != 1) {
+        // Block still being written, or torn
+        return BlockLoad::END_OF_SEGMENT;
+    }
+    if (header.checksum != _checksum(mReadBlock) ||
+        header.numberOfRecords > RECORDS_PER_BLOCK) {
+        return BlockLoad::SKIPPED;
+    }
+    return BlockLoad::LOADED;
+}
+
+void SampleLog::_segmentPath(const uint32_t segment, char* path,
+                             const size_t size) const {
+    snprintf(path, size, "%s/%08" PRIx32 "%s", mDirectory, segment,
+             SEGMENT_SUFFIX);
+}
+
+uint32_t SampleLog::_checksum(const Block& block) {
+    // FNV-1a of all bytes but the checksum itself
+    constexpr size_t CHECKSUM_OFFSET = offsetof(BlockHeader, checksum);
+    uint32_t hash = 2166136261u;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(&block);
+    for (size_t i = 0; i < sizeof(Block); ++i) {
+        if (i == CHECKSUM_OFFSET) {
+            i += sizeof(block.header.checksum) - 1;
+            continue;
+        }
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+} // namespace sensirion::upt::i2c_autodetect
@@ -0,0 +1,303 @@
+#ifndef SAMPLE_LOG_H
+#define SAMPLE_LOG_H
+
+#include "ISensorHistory.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Append-only log of the sensor readings in files, eg. on LittleFS, such
+ * that readings survive hours without connectivity and can be replayed.
+ *
+ * The log is a directory of segment files (00000000.slg, 00000001.slg, ...)
+ * of at most blocksPerSegment blocks each, of which the oldest are deleted
+ * beyond maxSegments. Each block is BLOCK_SIZE bytes long and decodable on
+ * its own: a header with the time range of its records, a table of the
+ * sensors it refers to, and fixed-size records. All fields are little
+ * endian at fixed offsets, such that segments can be memory-mapped on Linux
+ * and read as arrays of SampleLog::Block.
+ *
+ * The headers serve as time index: reading a time range only loads the
+ * blocks whose time range overlaps with it.
+ *
+ * Files are accessed through stdio, which the ESP32 maps to the mounted file
+ * systems, eg. "/littlefs/log" after LittleFS.begin(). On the host build the
+ * directory is a plain directory. begin() creates and lists the directory
+ * with mkdir() and opendir(), such that the file system must support
+ * directories, eg. LittleFS or FAT. SPIFFS has no directories and is not
+ * supported.
+ *
+ * record() only fills blocks in RAM, such that the acquisition task never
+ * waits for the flash. Full blocks are written by sync(), in one write per
+ * block, from the loop or another task. */
+class SampleLog : public ISensorHistory {
+  public:
+    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr uint32_t BLOCK_MAGIC = 0x474C5355;  // "USLG"
+    static constexpr uint16_t FORMAT_VERSION = 1;
+    static constexpr size_t MAX_SENSORS_PER_BLOCK = 16;
+    static constexpr size_t LABEL_LENGTH = 14;
+    // Blocks filled by record() which sync() did not write yet
+    static constexpr size_t NUMBER_OF_BUFFERED_BLOCKS = 2;
+
+    struct BlockHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t numberOfRecords;
+        uint8_t numberOfSensors;
+        uint8_t reserved[3];
+        // FNV-1a of the block without this field
+        uint32_t checksum;
+        // Time of the records relative to baseTimeMs
+        uint64_t baseTimeMs;
+        uint64_t minTimeMs;
+        uint64_t maxTimeMs;
+    };
+
+    struct SensorEntry {
+        uint64_t deviceID;
+        uint8_t busId;
+        uint8_t i2cAddress;
+        // DeviceType label, null terminated
+        char label[LABEL_LENGTH];
+    };
+
+    struct Record {
+        int32_t timeDeltaMs;
+        float value;
+        uint8_t sensorIndex;
+        uint8_t signalType;
+        uint16_t reserved;
+    };
+
+    static constexpr size_t RECORDS_PER_BLOCK =
+        (BLOCK_SIZE - sizeof(BlockHeader) -
+         MAX_SENSORS_PER_BLOCK * sizeof(SensorEntry)) /
+        sizeof(Record);
+
+    struct Block {
+        BlockHeader header;
+        SensorEntry sensors[MAX_SENSORS_PER_BLOCK];
+        Record records[RECORDS_PER_BLOCK];
+    };
+    static_assert(sizeof(BlockHeader) == 40 && sizeof(SensorEntry) == 24 &&
+                      sizeof(Record) == 12 && sizeof(Block) == BLOCK_SIZE,
+                  "The block layout is part of the file format");
+
+    /* Sensor of a record visited by read() */
+    struct LoggedSensor {
+        SensorKey key;
+        const char* deviceLabel;
+    };
+
+    /**
+     * @brief constructor
+     *
+     * @param[in] directory directory of the segment files, eg.
+     * "/littlefs/log". Must outlive the log.
+     *
+     * @param[in] blocksPerSegment number of blocks after which a new segment
+     * file is started
+     *
+     * @param[in] maxSegments number of segment files kept, bounding the
+     * size of the log to maxSegments * blocksPerSegment * BLOCK_SIZE
+     */
+    explicit SampleLog(const char* directory, uint32_t blocksPerSegment = 64,
+                       uint32_t maxSegments = 8);
+
+    ~SampleLog() override;
+
+    SampleLog(const SampleLog&) = delete;  // Illegal operation
+    SampleLog& operator=(const SampleLog&) = delete;  // Illegal operation
+
+    /**
+     * @brief create the directory if needed and find the existing segments.
+     * Writing continues in a new segment.
+     *
+     * @returns False if the directory cannot be accessed
+     */
+    bool begin();
+
+    /**
+     * @brief set the time added to the time stamps of the readings, which
+     * are milliseconds passed since program startup. Eg. the unix time in
+     * milliseconds at startup, such that the logs of several runs can be
+     * told apart.
+     */
+    void setTimeOffsetMs(uint64_t offsetMs) {
+        mTimeOffsetMs = offsetMs;
+    }
+
+    /**
+     * @brief set a history to which record() forwards every set of
+     * readings, eg. a SensorHistory serving the latest readings from RAM.
+     * SensorManager holds a single history, such that the log is registered
+     * with setHistory() and further histories are chained behind it.
+     *
+     * @note Set before the log is registered with SensorManager. Readings
+     * are forwarded even when the log drops them.
+     *
+     * @param[in] history history receiving the readings, nullptr to stop
+     * forwarding
+     */
+    void setDownstreamHistory(ISensorHistory* history) {
+        mDownstreamHistory = history;
+    }
+
+    void record(const SensorKey& key,
+                const ISensor::MeasurementList& measurements) override;
+
+    /**
+     * @brief close the block being filled, such that the next sync() writes
+     * it even though it is not full. Eg. before deep sleep.
+     *
+     * @note Call from the task recording the readings
+     */
+    void flush();
+
+    /**
+     * @brief write the blocks filled by record() to the segment files
+     *
+     * @note Call from a single task, eg. the loop or a dedicated task
+     *
+     * @returns The number of blocks written
+     */
+    size_t sync();
+
+    /**
+     * @brief visit the logged readings of a time range, in order of their
+     * recording
+     *
+     * @note Call from a single task. Blocks which are not synced yet are not
+     * visited.
+     *
+     * @param[in] fromMs, toMs time range, inclusive, in the time of the
+     * readings plus the time offset
+     *
+     * @param[in] visitor callable invoked with (const LoggedSensor&,
+     * core::SignalType, uint64_t timeMs, float value)
+     *
+     * @returns The number of visited readings
+     */
+    template <typename Visitor>
+    size_t read(const uint64_t fromMs, const uint64_t toMs,
+                Visitor&& visitor) {
+        size_t numberOfReadings = 0;
+        const uint32_t lastSegment = mLastSegment.load();
+        for (uint32_t segment = mFirstSegment.load();
+             segment != lastSegment + 1; ++segment) {
+            for (uint32_t index = 0;; ++index) {
+                const BlockLoad load =
+                    _loadBlock(segment, index, fromMs, toMs);
+                if (load == BlockLoad::END_OF_SEGMENT) {
+                    break;
+                }
+                if (load == BlockLoad::SKIPPED) {
+                    continue;
+                }
+                const Block& block = mReadBlock;
+                for (size_t r = 0; r < block.header.numberOfRecords; ++r) {
+                    const Record& record = block.records[r];
+                    const uint64_t timeMs =
+                        block.header.baseTimeMs + record.timeDeltaMs;
+                    if (timeMs < fromMs || timeMs > toMs ||
+                        record.sensorIndex >= block.header.numberOfSensors) {
+                        continue;
+                    }
+                    const SensorEntry& entry =
+                        block.sensors[record.sensorIndex];
+                    const LoggedSensor sensor{
+                        SensorKey{entry.busId, entry.i2cAddress,
+                                  entry.deviceID},
+                        entry.label};
+                    visitor(sensor,
+                            static_cast<core::SignalType>(record.signalType),
+                            timeMs, record.value);
+                    numberOfReadings++;
+                }
+            }
+        }
+        return numberOfReadings;
+    }
+
+    /**
+     * @brief getter method for the number of readings which were not
+     * recorded because sync() did not keep up
+     */
+    size_t getDroppedCount() const {
+        return mDroppedCount;
+    }
+
+  private:
+    enum class BlockLoad { LOADED, SKIPPED, END_OF_SEGMENT };
+
+    const char* mDirectory;
+    const uint32_t mBlocksPerSegment;
+    const uint32_t mMaxSegments;
+    uint64_t mTimeOffsetMs = 0;
+    size_t mDroppedCount = 0;
+    ISensorHistory* mDownstreamHistory = nullptr;
+
+    // Blocks handed from record() to sync(), mBlocks[mSealed % N] is filled
+    Block mBlocks[NUMBER_OF_BUFFERED_BLOCKS]{};
+    std::atomic<uint32_t> mSealed{0};
+    std::atomic<uint32_t> mWritten{0};
+
+    // Segment files, first and last inclusive
+    std::atomic<uint32_t> mFirstSegment{0};
+    std::atomic<uint32_t> mLastSegment{0};
+    FILE* mSegmentFile = nullptr;
+    uint32_t mBlocksInSegment = 0;
+
+    // Reader side
+    Block mReadBlock;
+    FILE* mReadFile = nullptr;
+    uint32_t mReadSegment = 0;
+
+    /**
+     * @brief getter method for the block being filled, nullptr if sync() did
+     * not free it yet
+     */
+    Block* _activeBlock();
+
+    /**
+     * @brief close the active block and hand it to sync()
+     */
+    void _seal();
+
+    /**
+     * @brief append a set of readings to the active block
+     */
+    void _append(const SensorKey& key,
+                 const ISensor::MeasurementList& measurements);
+
+    /**
+     * @brief find or add a sensor in the table of a block
+     *
+     * @returns MAX_SENSORS_PER_BLOCK if the table is full
+     */
+    static size_t _sensorIndex(Block& block, const SensorKey& key,
+                               const core::MetaData& metaData);
+
+    /**
+     * @brief write a block to the current segment, starting a new segment
+     * if it is full
+     */
+    bool _writeBlock(Block& block);
+
+    /**
+     * @brief load a block into mReadBlock if its time range overlaps with
+     * the given range and its checksum is valid
+     */
+    BlockLoad _loadBlock(uint32_t segment, uint32_t index, uint64_t fromMs,
+                         uint64_t toMs);
+
+    void _segmentPath(uint32_t segment, char* path, size_t size) const;
+
+    static uint32_t _checksum(const Block& block);
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* SAMPLE_LOG_H */
@@ -1,9 +1,14 @@
 #ifndef SENSIRION_UPT_I2C_AUTO_DETECTION_H
 #define SENSIRION_UPT_I2C_AUTO_DETECTION_H
 
+#include "AdaptiveInterval.h"
 #include "I2CAutoDetector.h"
+#include "MultiBusSensorManager.h"
+#include "SampleLog.h"
 #include "Sensirion_UPT_Core.h"
+#include "SensorHistory.h"
 #include "SensorManager.h"
+#include "SensorStatistics.h"
 
 #include <Arduino.h>
 
@@ -0,0 +1,119 @@
+#ifndef SENSOR_FRAME_H
+#define SENSOR_FRAME_H
+
+#include "ISensor.h"
+#include "SensorKey.h"
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Columnar snapshot of the current readings of all sensors. The signals are
+ * stored in contiguous arrays (sensor index, SignalType, time stamp, value),
+ * such that exports and statistics are linear scans over dense memory. The
+ * sensor index of a signal refers to the side table of keys and metadata.
+ *
+ * @tparam MAX_SENSORS number of sensors the frame can hold, eg.
+ * DefaultI2cDetector::CONFIGURED_SENSORS
+ *
+ * @tparam MAX_SIGNALS number of signals the frame can hold */
+template <size_t MAX_SENSORS,
+          size_t MAX_SIGNALS = MAX_SENSORS * ISensor::MAX_NUMBER_OF_DATA_POINTS>
+class SensorFrame {
+  public:
+    static_assert(MAX_SENSORS <= UINT8_MAX,
+                  "Sensor indices are stored as uint8_t");
+
+    /**
+     * @brief remove all sensors and signals from the frame
+     */
+    void clear() {
+        mNumberOfSensors = 0;
+        mNumberOfSignals = 0;
+    }
+
+    /**
+     * @brief append the readings of a sensor
+     *
+     * @param[in] key identity of the sensor
+     *
+     * @param[in] measurements readings of the sensor, of which the metadata
+     * of the first entry is stored in the side table
+     *
+     * @returns False if the frame cannot hold the sensor and all of its
+     * signals, in which case the frame is left unchanged
+     */
+    bool append(const SensorKey& key,
+                const ISensor::MeasurementList& measurements) {
+        if (measurements.empty() || mNumberOfSensors >= MAX_SENSORS ||
+            mNumberOfSignals + measurements.size() > MAX_SIGNALS) {
+            return false;
+        }
+        const uint8_t sensorIndex = static_cast<uint8_t>(mNumberOfSensors++);
+        mKeys[sensorIndex] = key;
+        mMetaData[sensorIndex] = measurements[0].metaData;
+        for (const auto& measurement : measurements) {
+            mSensorIndices[mNumberOfSignals] = sensorIndex;
+            mSignalTypes[mNumberOfSignals] = measurement.signalType;
+            mTimeStamps[mNumberOfSignals] = measurement.dataPoint.t_offset;
+            mValues[mNumberOfSignals] = measurement.dataPoint.value;
+            ++mNumberOfSignals;
+        }
+        return true;
+    }
+
+    size_t getNumberOfSensors() const {
+        return mNumberOfSensors;
+    }
+
+    size_t getNumberOfSignals() const {
+        return mNumberOfSignals;
+    }
+
+    /**
+     * @brief getter methods for the signal columns, each
+     * getNumberOfSignals() long
+     */
+    const uint8_t* getSensorIndices() const {
+        return mSensorIndices;
+    }
+
+    const core::SignalType* getSignalTypes() const {
+        return mSignalTypes;
+    }
+
+    // Milliseconds passed since program startup at the time of measurement
+    const uint32_t* getTimeStamps() const {
+        return mTimeStamps;
+    }
+
+    const float* getValues() const {
+        return mValues;
+    }
+
+    /**
+     * @brief getter methods for the side table, indexed by the sensor
+     * indices of the signals
+     */
+    const SensorKey& getKey(const size_t sensorIndex) const {
+        return mKeys[sensorIndex];
+    }
+
+    const core::MetaData& getMetaData(const size_t sensorIndex) const {
+        return mMetaData[sensorIndex];
+    }
+
+  private:
+    size_t mNumberOfSensors = 0;
+    size_t mNumberOfSignals = 0;
+
+    uint8_t mSensorIndices[MAX_SIGNALS];
+    core::SignalType mSignalTypes[MAX_SIGNALS];
+    uint32_t mTimeStamps[MAX_SIGNALS];
+    float mValues[MAX_SIGNALS];
+
+    SensorKey mKeys[MAX_SENSORS];
+    core::MetaData mMetaData[MAX_SENSORS];
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* SENSOR_FRAME_H */
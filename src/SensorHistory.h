@@ -0,0 +1,371 @@
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include "AtomicWords.h"
+#include "ISensorHistory.h"
+#include <atomic>
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Preallocated history of the sensor readings. Every sensor has a ring buffer
+ * per signal holding its last DEPTH samples. Each recorded set of readings is
+ * numbered with a sequence number, increasing across all sensors, such that
+ * consumers can drain everything recorded since the last sequence number they
+ * have seen, in batches if needed.
+ *
+ * The history is a single producer, single consumer ring: record() is called
+ * by one task (the task calling SensorManager::executeSensorCommunication()),
+ * while drain() may run on another task, eg. on the other core. The write
+ * position of each ring and the newest sequence number are atomic. Each slot
+ * is stamped with its sequence number, which record() clears while it
+ * overwrites the slot, and the samples are copied word by word, such that
+ * drain() discards a sample which was overwritten while it was copied rather
+ * than returning a torn one. Neither side ever waits for the other.
+ *
+ * @tparam MAX_SENSORS number of sensors the history can hold, eg.
+ * DefaultI2cDetector::CONFIGURED_SENSORS
+ *
+ * @tparam DEPTH number of samples kept per sensor. Older samples are
+ * overwritten.
+ *
+ * @note Use one history per SensorManager, or MultiBusSensorManager::
+ * setHistory() for several buses. clear() belongs to the producer side. */
+template <size_t MAX_SENSORS, size_t DEPTH>
+class SensorHistory : public ISensorHistory {
+  public:
+    static_assert(MAX_SENSORS > 0 && DEPTH > 0,
+                  "The history must hold at least one sample");
+
+    void record(const SensorKey& key,
+                const ISensor::MeasurementList& measurements) override {
+        if (measurements.empty()) {
+            return;
+        }
+        Channel* channel = _findChannel(key, measurements);
+        if (!channel) {
+            const size_t droppedCount =
+                mDroppedCount.load(std::memory_order_relaxed);
+            mDroppedCount.store(droppedCount + 1, std::memory_order_relaxed);
+            return;
+        }
+        const size_t position = channel->head.load(std::memory_order_relaxed);
+        const uint32_t overwritten =
+            channel->sequences[position].load(std::memory_order_relaxed);
+        if (overwritten != EMPTY_SLOT) {
+            _markLost(overwritten);
+        }
+        // Readers racing with the copy below see the cleared stamp
+        channel->sequences[position].store(EMPTY_SLOT,
+                                           std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < channel->descriptor.numberOfSignals; ++i) {
+            channel->dataPoints[i][position].store(measurements[i].dataPoint);
+        }
+        uint32_t sequence = mNewestSequence.load(std::memory_order_relaxed) + 1;
+        if (sequence == EMPTY_SLOT) {
+            sequence++;
+        }
+        channel->sequences[position].store(sequence,
+                                           std::memory_order_release);
+        channel->head.store((position + 1) % DEPTH, std::memory_order_release);
+        mNewestSequence.store(sequence, std::memory_order_release);
+    }
+
+    /**
+     * @brief visit the samples recorded after a given sequence number, in
+     * order of their sequence numbers
+     *
+     * @param[in] sinceSequence sequence number of the last sample seen by the
+     * consumer, 0 to visit all samples in the history
+     *
+     * @param[in] visitor callable invoked with (const SensorKey&, uint32_t
+     * sequence, const core::Measurement&) for each signal of the samples
+     *
+     * @param[in] maxSamples number of samples after which to stop, such that
+     * a slow consumer can catch up in batches
+     *
+     * @returns The sequence number of the last visited sample, to be passed
+     * as sinceSequence to the next call. sinceSequence if there was nothing
+     * to visit.
+     *
+     * @note Samples after sinceSequence were overwritten before they could be
+     * drained if getOldestSequence() is after sinceSequence + 1. Samples
+     * recorded during the call are left to the next call.
+     */
+    template <typename Visitor>
+    uint32_t drain(const uint32_t sinceSequence, Visitor&& visitor,
+                   size_t maxSamples = SIZE_MAX) const {
+        const uint32_t newestSequence =
+            mNewestSequence.load(std::memory_order_acquire);
+        const size_t numberOfChannels =
+            mNumberOfChannels.load(std::memory_order_acquire);
+        // Position of the next slot to visit, and number of slots left, of
+        // each sensor. The oldest slot follows the write position.
+        size_t next[MAX_SENSORS];
+        size_t remaining[MAX_SENSORS];
+        for (size_t c = 0; c < numberOfChannels; ++c) {
+            next[c] = mChannels[c].head.load(std::memory_order_acquire);
+            remaining[c] = DEPTH;
+        }
+
+        uint32_t lastSequence = sinceSequence;
+        Sample sample;
+        while (maxSamples > 0) {
+            // Merge the sensors by sequence number
+            size_t oldestChannel = numberOfChannels;
+            uint32_t oldestSequence = 0;
+            for (size_t c = 0; c < numberOfChannels; ++c) {
+                const uint32_t sequence =
+                    _seekSample(mChannels[c], sinceSequence, newestSequence,
+                                next[c], remaining[c]);
+                if (remaining[c] > 0 &&
+                    (oldestChannel == numberOfChannels ||
+                     _isAfter(oldestSequence, sequence))) {
+                    oldestChannel = c;
+                    oldestSequence = sequence;
+                }
+            }
+            if (oldestChannel == numberOfChannels) {
+                break;
+            }
+
+            const size_t position = next[oldestChannel];
+            next[oldestChannel] = (position + 1) % DEPTH;
+            remaining[oldestChannel]--;
+            if (!_loadSample(mChannels[oldestChannel], position,
+                             oldestSequence, sample)) {
+                // Overwritten while it was copied
+                continue;
+            }
+            lastSequence = oldestSequence;
+            for (size_t i = 0; i < sample.descriptor.numberOfSignals; ++i) {
+                const core::Measurement measurement(
+                    sample.descriptor.metaData,
+                    sample.descriptor.signalTypes[i], sample.dataPoints[i]);
+                visitor(sample.descriptor.key, lastSequence, measurement);
+            }
+            maxSamples--;
+        }
+        return lastSequence;
+    }
+
+    /**
+     * @brief getter method for the sequence number of the last recorded
+     * sample, 0 if none was recorded
+     */
+    uint32_t getNewestSequence() const {
+        return mNewestSequence.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief getter method for the sequence number from which on all
+     * recorded samples are still held, ie. the samples before it were
+     * overwritten or cleared. 1 as long as no sample was lost.
+     */
+    uint32_t getOldestSequence() const {
+        return mLostSequence.load(std::memory_order_acquire) + 1;
+    }
+
+    /**
+     * @brief getter method for the number of sensors in the history
+     */
+    size_t getNumberOfSensors() const {
+        return mNumberOfChannels.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief getter method for the number of samples which were not recorded
+     * because the history was full of other sensors
+     */
+    size_t getDroppedCount() const {
+        return mDroppedCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief remove all samples and sensors from the history
+     *
+     * @note Producer side, call from the task calling record()
+     */
+    void clear() {
+        mNumberOfChannels.store(0, std::memory_order_release);
+        _markLost(mNewestSequence.load(std::memory_order_relaxed));
+    }
+
+  private:
+    // Stamp of a slot which holds no sample, skipped by the sequence numbers
+    static constexpr uint32_t EMPTY_SLOT = 0;
+
+    struct Descriptor {
+        SensorKey key;
+        core::MetaData metaData;
+        size_t numberOfSignals = 0;
+        core::SignalType signalTypes[ISensor::MAX_NUMBER_OF_DATA_POINTS];
+    };
+
+    struct Channel {
+        // Written and read by the producer only
+        Descriptor descriptor;
+        // Copy of the descriptor for the consumer, odd version while it is
+        // rewritten
+        AtomicWords<Descriptor> sharedDescriptor;
+        std::atomic<uint32_t> version{0};
+        // One ring buffer per signal, sharing the sequence numbers
+        AtomicWords<core::DataPoint>
+            dataPoints[ISensor::MAX_NUMBER_OF_DATA_POINTS][DEPTH];
+        std::atomic<uint32_t> sequences[DEPTH] = {};
+        std::atomic<size_t> head{0};  // Position of the next sample
+    };
+
+    // A sample copied by the consumer
+    struct Sample {
+        Descriptor descriptor;
+        core::DataPoint dataPoints[ISensor::MAX_NUMBER_OF_DATA_POINTS];
+    };
+
+    Channel mChannels[MAX_SENSORS];
+    std::atomic<size_t> mNumberOfChannels{0};
+    std::atomic<uint32_t> mNewestSequence{0};
+    // Sequence number of the newest sample which is no longer held
+    std::atomic<uint32_t> mLostSequence{0};
+    std::atomic<size_t> mDroppedCount{0};
+
+    /**
+     * @brief find the channel of a sensor, or claim a new one. The channel is
+     * reset if the sensor at the key's bus and address delivers different
+     * signals than before (eg. it was replaced).
+     *
+     * @returns nullptr if all channels are taken
+     */
+    Channel* _findChannel(const SensorKey& key,
+                          const ISensor::MeasurementList& measurements) {
+        const size_t numberOfChannels =
+            mNumberOfChannels.load(std::memory_order_relaxed);
+        for (size_t c = 0; c < numberOfChannels; ++c) {
+            Channel& channel = mChannels[c];
+            if (channel.descriptor.key.busId != key.busId ||
+                channel.descriptor.key.i2cAddress != key.i2cAddress) {
+                continue;
+            }
+            bool sameSignals =
+                channel.descriptor.numberOfSignals == measurements.size() &&
+                channel.descriptor.key.deviceID == key.deviceID;
+            for (size_t i = 0; sameSignals && i < measurements.size(); ++i) {
+                sameSignals = channel.descriptor.signalTypes[i] ==
+                              measurements[i].signalType;
+            }
+            if (!sameSignals) {
+                _resetChannel(channel, key, measurements);
+            }
+            return &channel;
+        }
+        if (numberOfChannels >= MAX_SENSORS) {
+            return nullptr;
+        }
+        Channel& channel = mChannels[numberOfChannels];
+        _resetChannel(channel, key, measurements);
+        mNumberOfChannels.store(numberOfChannels + 1,
+                                std::memory_order_release);
+        return &channel;
+    }
+
+    /**
+     * @brief discard the samples of a channel and assign it to a sensor
+     */
+    void _resetChannel(Channel& channel, const SensorKey& key,
+                       const ISensor::MeasurementList& measurements) {
+        const uint32_t version =
+            channel.version.load(std::memory_order_relaxed);
+        channel.version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        const size_t head = channel.head.load(std::memory_order_relaxed);
+        const uint32_t newest =
+            channel.sequences[(head + DEPTH - 1) % DEPTH].load(
+                std::memory_order_relaxed);
+        if (newest != EMPTY_SLOT) {
+            _markLost(newest);
+        }
+        for (auto& sequence : channel.sequences) {
+            sequence.store(EMPTY_SLOT, std::memory_order_relaxed);
+        }
+        channel.head.store(0, std::memory_order_relaxed);
+        channel.descriptor.key = key;
+        channel.descriptor.metaData = measurements[0].metaData;
+        channel.descriptor.numberOfSignals = measurements.size();
+        for (size_t i = 0; i < measurements.size(); ++i) {
+            channel.descriptor.signalTypes[i] = measurements[i].signalType;
+        }
+        channel.sharedDescriptor.store(channel.descriptor);
+        channel.version.store(version + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief advance to the next slot of a channel holding a sample after
+     * sinceSequence, up to newestSequence
+     *
+     * @returns the sequence number of the sample, remaining is 0 if there is
+     * none
+     */
+    static uint32_t _seekSample(const Channel& channel,
+                                const uint32_t sinceSequence,
+                                const uint32_t newestSequence, size_t& next,
+                                size_t& remaining) {
+        for (; remaining > 0; next = (next + 1) % DEPTH, --remaining) {
+            const uint32_t sequence =
+                channel.sequences[next].load(std::memory_order_acquire);
+            // Slots stamped after newestSequence were overwritten since the
+            // drain started
+            if (sequence != EMPTY_SLOT && _isAfter(sequence, sinceSequence) &&
+                !_isAfter(sequence, newestSequence)) {
+                return sequence;
+            }
+        }
+        return EMPTY_SLOT;
+    }
+
+    /**
+     * @brief copy the sample of a slot
+     *
+     * @returns False if the slot no longer holds the sample with the given
+     * sequence number, or its channel was reset
+     */
+    static bool _loadSample(const Channel& channel, const size_t position,
+                            const uint32_t sequence, Sample& sample) {
+        const uint32_t version =
+            channel.version.load(std::memory_order_acquire);
+        if (version % 2 != 0) {
+            return false;
+        }
+        channel.sharedDescriptor.load(sample.descriptor);
+        for (size_t i = 0; i < sample.descriptor.numberOfSignals &&
+                           i < ISensor::MAX_NUMBER_OF_DATA_POINTS;
+             ++i) {
+            channel.dataPoints[i][position].load(sample.dataPoints[i]);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return channel.sequences[position].load(std::memory_order_relaxed) ==
+                   sequence &&
+               channel.version.load(std::memory_order_relaxed) == version;
+    }
+
+    /**
+     * @brief account for a sample which is no longer held
+     */
+    void _markLost(const uint32_t sequence) {
+        const uint32_t lostSequence =
+            mLostSequence.load(std::memory_order_relaxed);
+        if (_isAfter(sequence, lostSequence)) {
+            mLostSequence.store(sequence, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief compare sequence numbers, robust against their overflow
+     */
+    static bool _isAfter(const uint32_t sequence, const uint32_t reference) {
+        return static_cast<int32_t>(sequence - reference) > 0;
+    }
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* SENSOR_HISTORY_H */
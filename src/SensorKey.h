@@ -0,0 +1,30 @@
+#ifndef SENSOR_KEY_H
+#define SENSOR_KEY_H
+
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Identity of a sensor instance, allowing to tell apart several sensors of
+ * the same type */
+struct SensorKey {
+    uint8_t busId = 0;
+    uint8_t i2cAddress = 0;
+    // Serial number of the sensor, 0 until the sensor is initialized
+    uint64_t deviceID = 0;
+
+    /**
+     * @brief check if this key identifies the sensor searched for with query
+     *
+     * @note The deviceID is only compared if it is set in the query
+     *
+     * @returns True if bus and address (and deviceID) are equal
+     */
+    bool matches(const SensorKey& query) const {
+        return busId == query.busId && i2cAddress == query.i2cAddress &&
+               (query.deviceID == 0 || deviceID == query.deviceID);
+    }
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* SENSOR_KEY_H */
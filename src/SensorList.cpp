@@ -1,5 +1,6 @@
 #include "SensorList.h"
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 
 namespace sensirion::upt::i2c_autodetect{
@@ -9,22 +10,189 @@ constexpr auto TAG = "SensorList";
 
 SensorList::~SensorList() {}
 
-void SensorList::addSensor(ISensor* pSensor) {
-    auto found = std::find_if(mSensorCollection.begin(),
-    mSensorCollection.end(), [pSensor](SensorStateMachine* x) {
-        return x->getSensor()->getDeviceType() == pSensor->getDeviceType();
-    });
-    if (found == mSensorCollection.end()){
-        mSensorCollection.push_back(new SensorStateMachine(pSensor));
+size_t SensorList::hashSensorType(const core::DeviceType deviceType) {
+    // FNV-1a of the device label
+    size_t hash = 2166136261u;
+    for (const char* c = core::deviceLabel(deviceType); c && *c; ++c) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
     }
+    return hash;
+}
+
+void SensorList::reserve(size_t capacity) {
+    if (mSlots) {
+        return;
+    }
+    if (capacity >= NO_SLOT) {
+        ESP_LOGW(TAG, "Capacity %u exceeds the supported %u sensors",
+                 static_cast<unsigned>(capacity),
+                 static_cast<unsigned>(NO_SLOT - 1));
+        capacity = NO_SLOT - 1;
+    }
+    mSlots = std::make_unique<Slot[]>(capacity);
+    mCapacity = capacity;
+    mSensorCollection.reserve(capacity);
+    memset(mAddressToSlot, NO_SLOT, sizeof(mAddressToSlot));
+    // At most half full, such that probe sequences stay short
+    mTypeIndexSize = 2;
+    while (mTypeIndexSize < 2 * capacity) {
+        mTypeIndexSize *= 2;
+    }
+    mTypeIndex = std::make_unique<TypeIndexEntry[]>(mTypeIndexSize);
+    mNextAtSameAddress = std::make_unique<uint8_t[]>(capacity);
+    mNextOfSameType = std::make_unique<uint8_t[]>(capacity);
+    mSlotTypeEntry = std::make_unique<uint8_t[]>(capacity);
+}
+
+bool SensorList::addSensor(ISensor* pSensor, const SensorKey& key,
+                           size_t slot) {
+    if (!mSlots) {
+        reserve(DEFAULT_CAPACITY);
+    }
+    const uint8_t address = key.i2cAddress & 0x7F;
+    if (_findSlot(key.busId, address) != NO_SLOT) {
+        // Bus and address already taken
+        return false;
+    }
+    if (slot == ANY_SLOT) {
+        if (containsSensor(pSensor)) {
+            return false;
+        }
+        slot = 0;
+        while (slot < mCapacity && mSlots[slot]) {
+            ++slot;
+        }
+    } else if (slot < mCapacity && mSlots[slot]) {
+        // Slot already taken, by this or another instance of the mapping
+        return false;
+    }
+    if (slot >= mCapacity) {
+        ESP_LOGW(TAG, "No free slot for sensor %s, sensor is ignored",
+                 pSensor->getDeviceType().data());
+        return false;
+    }
+
+    mSlots[slot].emplace(pSensor, key);
+    mSensorCollection.push_back(static_cast<uint8_t>(slot));
+    mNextAtSameAddress[slot] = mAddressToSlot[address];
+    mAddressToSlot[address] = static_cast<uint8_t>(slot);
+    _linkType(static_cast<uint8_t>(slot));
+    return true;
+}
+
+uint8_t SensorList::_findSlot(const uint8_t busId,
+                              const uint8_t address) const {
+    uint8_t slot = mAddressToSlot[address & 0x7F];
+    while (slot != NO_SLOT && mSlots[slot]->getKey().busId != busId) {
+        slot = mNextAtSameAddress[slot];
+    }
+    return slot;
+}
+
+size_t SensorList::_findTypeEntry(const core::DeviceType deviceType) const {
+    if (!mTypeIndex) {
+        return mTypeIndexSize;
+    }
+    const size_t hash = hashSensorType(deviceType);
+    const size_t mask = mTypeIndexSize - 1;
+    for (size_t i = 0; i < mTypeIndexSize; ++i) {
+        const size_t entry = (hash + i) & mask;
+        const TypeIndexEntry& e = mTypeIndex[entry];
+        if (!e.used) {
+            break;
+        }
+        if (e.firstSlot != NO_SLOT && e.hash == hash &&
+            mSlots[e.firstSlot]->getSensor()->getDeviceType() == deviceType) {
+            return entry;
+        }
+    }
+    return mTypeIndexSize;
+}
+
+void SensorList::_linkType(const uint8_t slot) {
+    const core::DeviceType deviceType =
+        mSlots[slot]->getSensor()->getDeviceType();
+    mNextOfSameType[slot] = NO_SLOT;
+
+    size_t entry = _findTypeEntry(deviceType);
+    if (entry != mTypeIndexSize) {
+        // Append to the chain, keeping the order of addition
+        uint8_t* link = &mTypeIndex[entry].firstSlot;
+        while (*link != NO_SLOT) {
+            link = &mNextOfSameType[*link];
+        }
+        *link = slot;
+        mSlotTypeEntry[slot] = static_cast<uint8_t>(entry);
+        return;
+    }
+
+    // Claim the first entry whose chain is empty
+    const size_t hash = hashSensorType(deviceType);
+    const size_t mask = mTypeIndexSize - 1;
+    for (size_t i = 0; i < mTypeIndexSize; ++i) {
+        entry = (hash + i) & mask;
+        TypeIndexEntry& e = mTypeIndex[entry];
+        if (!e.used || e.firstSlot == NO_SLOT) {
+            e.used = true;
+            e.hash = hash;
+            e.firstSlot = slot;
+            mSlotTypeEntry[slot] = static_cast<uint8_t>(entry);
+            return;
+        }
+    }
+}
+
+void SensorList::_unlinkType(const uint8_t slot) {
+    uint8_t* link = &mTypeIndex[mSlotTypeEntry[slot]].firstSlot;
+    while (*link != NO_SLOT && *link != slot) {
+        link = &mNextOfSameType[*link];
+    }
+    if (*link == slot) {
+        *link = mNextOfSameType[slot];
+    }
+    mNextOfSameType[slot] = NO_SLOT;
+}
+
+void SensorList::_freeSlot(const uint8_t slot) {
+    _unlinkType(slot);
+    const uint8_t address = mSlots[slot]->getKey().i2cAddress & 0x7F;
+    uint8_t* link = &mAddressToSlot[address];
+    while (*link != NO_SLOT && *link != slot) {
+        link = &mNextAtSameAddress[*link];
+    }
+    if (*link == slot) {
+        *link = mNextAtSameAddress[slot];
+    }
+    mSlots[slot].reset();
+}
+
+uint8_t SensorList::_slotOf(const SensorStateMachine* ssm) const {
+    if (!ssm || !mSlots) {
+        return NO_SLOT;
+    }
+    const uint8_t slot =
+        _findSlot(ssm->getKey().busId, ssm->getKey().i2cAddress);
+    if (slot == NO_SLOT || &*mSlots[slot] != ssm) {
+        return NO_SLOT;
+    }
+    return slot;
+}
+
+void SensorList::updateDeviceType(const SensorStateMachine* ssm) {
+    const uint8_t slot = _slotOf(ssm);
+    if (slot == NO_SLOT) {
+        return;
+    }
+    _unlinkType(slot);
+    _linkType(slot);
 }
 
 
 size_t SensorList::getTotalNumberOfDataPoints() const {
     size_t totalNumberOfDataPoints = 0;
-    for (auto s : mSensorCollection) {
+    for (const auto slot : mSensorCollection) {
         totalNumberOfDataPoints +=
-                s->getSensor()->getNumberOfDataPoints();
+                mSlots[slot]->getSensor()->getNumberOfDataPoints();
     }
     return totalNumberOfDataPoints;
 }
@@ -34,34 +202,63 @@ SensorStateMachine* SensorList::getSensorStateMachine(const size_t i) const {
     if (i >= mSensorCollection.size()){
         return nullptr;
     }
-    return mSensorCollection[i];
+    return &*mSlots[mSensorCollection[i]];
+}
+
+SensorStateMachine* SensorList::getSlot(const size_t slot) const {
+    if (slot >= mCapacity || !mSlots[slot]) {
+        return nullptr;
+    }
+    return &*mSlots[slot];
 }
 
 ISensor* SensorList::getSensor(core::DeviceType deviceType) const {
-    for( const auto s : mSensorCollection){
-        if (s->getSensor()->getDeviceType() == deviceType){
-            return s->getSensor();
-        }
+    const size_t entry = _findTypeEntry(deviceType);
+    if (entry == mTypeIndexSize) {
+        return nullptr;
     }
-    return nullptr;
+    return mSlots[mTypeIndex[entry].firstSlot]->getSensor();
+}
+
+SensorStateMachine*
+SensorList::findSensorStateMachine(const SensorKey& key) const {
+    if (!mSlots) {
+        return nullptr;
+    }
+    const uint8_t slot = _findSlot(key.busId, key.i2cAddress);
+    if (slot == NO_SLOT || !mSlots[slot]->getKey().matches(key)) {
+        return nullptr;
+    }
+    return &*mSlots[slot];
 }
 
 bool SensorList::containsSensor(core::DeviceType deviceType) const {
-    auto iter = std::find_if(mSensorCollection.begin(),
-    mSensorCollection.end(), [deviceType](SensorStateMachine* s) {
-        return s->getSensor()->getDeviceType() == deviceType;
-    });
-    return iter != mSensorCollection.end();
+    return _findTypeEntry(deviceType) != mTypeIndexSize;
+}
+
+bool SensorList::containsSensor(const ISensor* pSensor) const {
+    if (!pSensor) {
+        return false;
+    }
+    // Only the sensors of the same type are candidates
+    bool found = false;
+    forEachSensorOfType(pSensor->getDeviceType(),
+                        [pSensor, &found](const SensorStateMachine* ssm) {
+                            found = found || ssm->getSensor() == pSensor;
+                        });
+    return found;
 }
 
 void SensorList::removeLostSensors() {
-    std::vector<SensorStateMachine*> livingSensors{};
-    for (auto s: mSensorCollection){
-        if(s->getSensorState() != SensorStatus::LOST){
-            livingSensors.push_back(s);
+    // Compact the collection in place and free the slots of lost sensors
+    size_t numberOfLivingSensors = 0;
+    for (const auto slot : mSensorCollection) {
+        if (mSlots[slot]->getSensorState() != SensorStatus::LOST) {
+            mSensorCollection[numberOfLivingSensors++] = slot;
+            continue;
         }
+        _freeSlot(slot);
     }
-    mSensorCollection.clear();
-    mSensorCollection = livingSensors;
+    mSensorCollection.resize(numberOfLivingSensors);
 }
-} // namespace sensirion::upt::i2c_autodetect 
+} // namespace sensirion::upt::i2c_autodetect
@@ -1,20 +1,93 @@
 #ifndef SENSOR_LIST_H
 #define SENSOR_LIST_H
+#include <memory>
+#include <optional>
 #include <vector>
 #include "SensorStateMachine.h"
 
 namespace sensirion::upt::i2c_autodetect{
 
-/* Class to handle the list of sensors on the i2c bus */
+/* Class to handle the list of sensors on the i2c bus. The state machines are
+ * stored in a pool of slots which is allocated once, such that sensors being
+ * lost and found again cost no allocation. Lookups by slot, bus and address,
+ * and DeviceType go through direct indices, such that their cost does not
+ * depend on the number of sensors. */
 class SensorList {
-  using SensorCollection = std::vector<SensorStateMachine*>;
+  using SensorCollection = std::vector<uint8_t>;
   using DeviceType = ISensor::DeviceType;
+  using Slot = std::optional<SensorStateMachine>;
 
-  private:
+  public:
+    /// Slot argument of addSensor() selecting the first free slot
+    static constexpr size_t ANY_SLOT = SIZE_MAX;
+    /// Capacity allocated by addSensor() if reserve() was not called before
+    static constexpr size_t DEFAULT_CAPACITY = 16;
 
+  private:
+    static constexpr uint8_t NO_SLOT = 0xFF;
+    static constexpr size_t NUMBER_OF_ADDRESSES = 128;
+
+    /* Entry of the open addressing hash table from DeviceType to the first
+     * slot holding a sensor of that type. The other slots of the type are
+     * chained through mNextOfSameType. */
+    struct TypeIndexEntry {
+        bool used = false;  // Entries are never unused again
+        size_t hash = 0;
+        uint8_t firstSlot = NO_SLOT;
+    };
+
+    // Slots in order of the addition of their sensors
     SensorCollection mSensorCollection{};
+    std::unique_ptr<Slot[]> mSlots;
+    size_t mCapacity = 0;
+
+    // First slot of the sensors at each address. The sensors at the same
+    // address on other buses are chained through mNextAtSameAddress.
+    uint8_t mAddressToSlot[NUMBER_OF_ADDRESSES];
+    std::unique_ptr<uint8_t[]> mNextAtSameAddress;
+    std::unique_ptr<TypeIndexEntry[]> mTypeIndex;
+    size_t mTypeIndexSize = 0;
+    std::unique_ptr<uint8_t[]> mNextOfSameType;
+    std::unique_ptr<uint8_t[]> mSlotTypeEntry;
+
     static size_t hashSensorType(core::DeviceType deviceType);
 
+    /**
+     * @brief find the type index entry of a DeviceType
+     *
+     * @returns mTypeIndexSize if there is none
+     */
+    size_t _findTypeEntry(core::DeviceType deviceType) const;
+
+    /**
+     * @brief find the slot of the sensor at a bus and address
+     *
+     * @returns NO_SLOT if there is none
+     */
+    uint8_t _findSlot(uint8_t busId, uint8_t address) const;
+
+    /**
+     * @brief add a slot to the chain of the DeviceType of its sensor
+     */
+    void _linkType(uint8_t slot);
+
+    /**
+     * @brief remove a slot from the chain of its DeviceType
+     */
+    void _unlinkType(uint8_t slot);
+
+    /**
+     * @brief free a slot and remove it from the indices
+     */
+    void _freeSlot(uint8_t slot);
+
+    /**
+     * @brief get the slot of a state machine stored in the list
+     *
+     * @returns NO_SLOT if the state machine is not stored in the list
+     */
+    uint8_t _slotOf(const SensorStateMachine* ssm) const;
+
   public:
     explicit SensorList() {};
 
@@ -24,14 +97,39 @@ class SensorList {
 
     ~SensorList();
 
+    /**
+     * @brief allocate the pool of state machine slots and the lookup indices
+     *
+     * @param[in] capacity maximal number of sensors in the list, eg. the
+     * number of sensors configured in the detector. At most 254.
+     *
+     * @note Only the first call allocates, later calls are ignored
+     */
+    void reserve(size_t capacity);
+
+    /**
+     * @brief getter method for the number of slots in the pool
+     */
+    size_t capacity() const { return mCapacity; };
+
     /**
      * @brief add a sensor to the list of tracked sensors. Ignores sensors that
-     * are already in the list. Causes program abort if unknown sensor is
-     * encountered.
+     * are already in the list, or whose bus and address are already taken by
+     * another sensor. Several sensors of the same type may be added. Sensors
+     * are ignored if all slots of the pool are taken. Reserves
+     * DEFAULT_CAPACITY slots if reserve() was not called before.
      *
      * @param[in] pSensor pointer to the sensor to be added to the list
+     *
+     * @param[in] key bus and address at which the sensor was found
+     *
+     * @param[in] slot slot in which to store the sensor, eg. the index of its
+     * mapping in the detector. ANY_SLOT selects the first free slot.
+     *
+     * @returns True if the sensor was added, false if it was ignored
      */
-    void addSensor(ISensor* pSensor);
+    bool addSensor(ISensor* pSensor, const SensorKey& key = SensorKey{},
+                   size_t slot = ANY_SLOT);
 
     /**
      * @brief Counts sensors contained in the list
@@ -58,11 +156,51 @@ class SensorList {
      */
     SensorStateMachine* getSensorStateMachine(size_t) const;
 
+    /**
+     * @brief getter method for the state machine stored in a slot
+     *
+     * @note returns a nullptr if the slot is free
+     */
+    SensorStateMachine* getSlot(size_t slot) const;
+
     /**
      * @brief getter method for a stored sensor
+     *
+     * @note returns the first sensor of the given type if there are several
      */
     ISensor* getSensor(core::DeviceType deviceType) const;
 
+    /**
+     * @brief getter method for the state machine of a particular sensor
+     * instance
+     *
+     * @param[in] key bus and address (and optionally deviceID) of the sensor
+     *
+     * @note returns a nullptr if no matching sensor is stored
+     */
+    SensorStateMachine* findSensorStateMachine(const SensorKey& key) const;
+
+    /**
+     * @brief call f with the state machine of each sensor of a DeviceType
+     */
+    template <typename F>
+    void forEachSensorOfType(core::DeviceType deviceType, F&& f) const {
+        const size_t entry = _findTypeEntry(deviceType);
+        if (entry == mTypeIndexSize) {
+            return;
+        }
+        for (uint8_t slot = mTypeIndex[entry].firstSlot; slot != NO_SLOT;
+             slot = mNextOfSameType[slot]) {
+            f(&*mSlots[slot]);
+        }
+    }
+
+    /**
+     * @brief update the DeviceType index after the type of a sensor was
+     * determined, eg. during its initialization
+     */
+    void updateDeviceType(const SensorStateMachine* ssm);
+
     /**
      * @brief check if the given Sensor is contained in the list.
      *
@@ -73,10 +211,20 @@ class SensorList {
     bool containsSensor(core::DeviceType deviceType) const;
 
     /**
-     * @brief remove lost sensors from list
+     * @brief check if a state machine handling the given sensor instance is
+     * contained in the list.
+     *
+     * @param[in] pSensor pointer to the sensor to be checked for in the list
+     *
+     * @returns True if the sensor is found, false otherwise.
+     */
+    bool containsSensor(const ISensor* pSensor) const;
+
+    /**
+     * @brief remove lost sensors from list, freeing their slots
      */
     void removeLostSensors();
 };
-} // namespace sensirion::upt::i2c_autodetect 
+} // namespace sensirion::upt::i2c_autodetect
 
 #endif /* SENSOR_LIST_H */
@@ -5,44 +5,122 @@ namespace sensirion::upt::i2c_autodetect{
 constexpr auto TAG = "SensorManager";
 
 void SensorManager::refreshConnectedSensors() {
+    // Allocates the state machine slots on the first call only
+    mSensorList.reserve(mDetector.configuredSensorsCount());
     mSensorList.removeLostSensors();
     mDetector.findSensors(mSensorList);
 }
 
 void SensorManager::executeSensorCommunication() {
-    for (int i = 0; i < mSensorList.count(); ++i) {
+    // Measurements started here are read out by a later call, once their
+    // result is due, such that their conversion times overlap
+    const uint32_t nowMs = millis();
+    for (size_t i = 0; i < mSensorList.count(); ++i) {
         SensorStateMachine* ssm = mSensorList.getSensorStateMachine(i);
-        if (ssm) {
-            const AutoDetectorError error = ssm->update();
-            [[maybe_unused]] 
-            const char* sensorName =
-                core::deviceLabel(ssm->getSensor()->getDeviceType());
-            switch (error) {
-                case I2C_ERROR:
-                    ESP_LOGW(TAG,
-                             "An I2C error occurred while attempting to "
-                             "execute a command on sensor %s.",
-                             sensorName);
-                    break;
-                case LOST_SENSOR_ERROR:
-                    ESP_LOGI(
-                        TAG,
-                        "Sensor %s was removed from list of active sensors.",
-                        sensorName);
-                    break;
-                case SENSOR_READY_STATE_DECAYED_ERROR:
-                    ESP_LOGW(
-                        TAG,
-                        "AutoDetect refresh rate too low: sensor %s "
-                        "conditioning deprecated. Decrease update interval.",
-                        sensorName);
-                    break;
-                case NO_ERROR:
-                default:
-                    break;
-            }
+        if (ssm && ssm->isUpdateDue(nowMs)) {
+            _updateStateMachine(ssm);
+        }
+    }
+}
+
+void SensorManager::collectPendingMeasurements() {
+    // Read out the results in the order in which they become available
+    SensorStateMachine* ssm = _nextPendingMeasurement();
+    while (ssm) {
+        const int32_t waitMs =
+            static_cast<int32_t>(ssm->getNextUpdateTimeStampMs() - millis());
+        if (waitMs > 0) {
+            delay(waitMs);
+        }
+        _updateStateMachine(ssm);
+        ssm = _nextPendingMeasurement();
+    }
+}
+
+void SensorManager::_updateStateMachine(SensorStateMachine* ssm) {
+    const uint32_t numberOfSamples = ssm->getNumberOfSamples();
+    const SensorStatus previousState = ssm->getSensorState();
+    const AutoDetectorError error = ssm->update();
+    if (previousState == SensorStatus::UNINITIALIZED &&
+        ssm->getSensorState() != SensorStatus::UNINITIALIZED) {
+        // The initialization may have determined the exact DeviceType (SEN5x)
+        mSensorList.updateDeviceType(ssm);
+    }
+    if (ssm->getNumberOfSamples() != numberOfSamples &&
+        _hasCompleteReadings(ssm)) {
+        ssm->setGeneration(++mGeneration);
+        if (mHistory) {
+            mHistory->record(ssm->getKey(), ssm->getSignals());
+        }
+        if (!mSubscriptions.empty()) {
+            mSubscriptions.notify(ssm->getKey(),
+                                  ssm->getSensor()->getDeviceType(),
+                                  ssm->getSignals());
+        }
+    }
+    [[maybe_unused]] 
+    const char* sensorName =
+        core::deviceLabel(ssm->getSensor()->getDeviceType());
+    switch (error) {
+        case I2C_ERROR:
+            ESP_LOGW(TAG,
+                     "An I2C error occurred while attempting to "
+                     "execute a command on sensor %s.",
+                     sensorName);
+            break;
+        case LOST_SENSOR_ERROR:
+            ESP_LOGI(TAG,
+                     "Sensor %s was removed from list of active sensors.",
+                     sensorName);
+            break;
+        case SENSOR_READY_STATE_DECAYED_ERROR:
+            ESP_LOGW(TAG,
+                     "AutoDetect refresh rate too low: sensor %s "
+                     "conditioning deprecated. Decrease update interval.",
+                     sensorName);
+            break;
+        case NO_ERROR:
+        default:
+            break;
+    }
+}
+
+SensorStateMachine* SensorManager::_nextPendingMeasurement() {
+    SensorStateMachine* next = nullptr;
+    for (size_t i = 0; i < mSensorList.count(); ++i) {
+        SensorStateMachine* ssm = mSensorList.getSensorStateMachine(i);
+        if (!ssm || !ssm->isMeasurementPending() ||
+            ssm->getSensorState() != SensorStatus::RUNNING) {
+            continue;
+        }
+        if (!next || static_cast<int32_t>(ssm->getNextUpdateTimeStampMs() -
+                                          next->getNextUpdateTimeStampMs()) <
+                         0) {
+            next = ssm;
+        }
+    }
+    return next;
+}
+
+unsigned long SensorManager::nextWakeupMs() const {
+    const uint32_t nowMs = millis();
+    unsigned long wakeupMs = MAX_WAKEUP_INTERVAL_MS;
+    for (size_t i = 0; i < mSensorList.count(); ++i) {
+        const SensorStateMachine* ssm = mSensorList.getSensorStateMachine(i);
+        if (!ssm || ssm->getSensorState() == SensorStatus::LOST ||
+            ssm->getSensorState() == SensorStatus::UNDEFINED) {
+            continue;
+        }
+        if (ssm->isUpdateDue(nowMs)) {
+            return 0;
+        }
+        const unsigned long remainingMs =
+            ssm->getNextUpdateTimeStampMs() - nowMs;
+        if (remainingMs < wakeupMs) {
+            wakeupMs = remainingMs;
         }
     }
+    return wakeupMs;
 }
 
 void SensorManager::getSensorReadings(const MeasurementList* dataHashmap[]) {
@@ -51,15 +129,49 @@ void SensorManager::getSensorReadings(const MeasurementList* dataHashmap[]) {
     // of sensors!
     memset(dataHashmap, 0, 
         sizeof(MeasurementList*)*mDetector.configuredSensorsCount());
-    for (int i = 0; i < mSensorList.count(); ++i) {
+    for (size_t i = 0; i < mSensorList.count(); ++i) {
+        const SensorStateMachine* ssm = mSensorList.getSensorStateMachine(i);
+        if (_hasCompleteReadings(ssm)) {
+            dataHashmap[i] = std::addressof(ssm->getSignals());
+        }
+    }
+}
+
+uint32_t SensorManager::getFreshReadings(const MeasurementList* dataHashmap[],
+                                         const uint32_t sinceGeneration) {
+    memset(dataHashmap, 0,
+           sizeof(MeasurementList*) * mDetector.configuredSensorsCount());
+    for (size_t i = 0; i < mSensorList.count(); ++i) {
         const SensorStateMachine* ssm = mSensorList.getSensorStateMachine(i);
-        if (ssm && ssm->getSensorState() == SensorStatus::RUNNING) {
-            const auto sig = std::addressof(ssm->getSignals());
-            if (sig->size() == ssm->getSensor()->getNumberOfDataPoints()){
-                dataHashmap[i] = sig;
-            }
+        // Difference is evaluated signed to be robust against overflow
+        if (_hasCompleteReadings(ssm) &&
+            static_cast<int32_t>(ssm->getGeneration() - sinceGeneration) > 0) {
+            dataHashmap[i] = std::addressof(ssm->getSignals());
         }
     }
+    return mGeneration;
+}
+
+uint32_t SensorManager::getGeneration() const {
+    return mGeneration;
+}
+
+size_t SensorManager::encodeSensorReadings(uint8_t* buffer,
+                                           const size_t capacity) const {
+    MeasurementEncoder encoder(buffer, capacity);
+    appendToSensorFrame(encoder);
+    return encoder.finish();
+}
+
+size_t SensorManager::encodeSensorReadings(TextEncoder& encoder) const {
+    appendToSensorFrame(encoder);
+    return encoder.finish();
+}
+
+bool SensorManager::_hasCompleteReadings(const SensorStateMachine* ssm) {
+    return ssm && ssm->getSensorState() == SensorStatus::RUNNING &&
+           ssm->getSignals().size() ==
+               ssm->getSensor()->getNumberOfDataPoints();
 }
 
 void SensorManager::refreshAndGetSensorReadings(
@@ -71,14 +183,82 @@ void SensorManager::refreshAndGetSensorReadings(
 
 void SensorManager::setInterval(const unsigned long interval,
                                 const ISensor::DeviceType deviceType) {
-    for (int i = 0; i < mSensorList.count(); ++i) {
+    mSensorList.forEachSensorOfType(deviceType,
+                                    [interval](SensorStateMachine* ssm) {
+                                        ssm->setMeasurementInterval(interval);
+                                    });
+}
+
+void SensorManager::setInterval(const unsigned long interval,
+                                const SensorKey& key) {
+    SensorStateMachine* ssm = mSensorList.findSensorStateMachine(key);
+    if (ssm) {
+        ssm->setMeasurementInterval(interval);
+    }
+}
+
+void SensorManager::setAdaptiveInterval(
+    const AdaptiveInterval& adaptiveInterval,
+    const ISensor::DeviceType deviceType) {
+    mSensorList.forEachSensorOfType(
+        deviceType, [&adaptiveInterval](SensorStateMachine* ssm) {
+            ssm->setAdaptiveInterval(adaptiveInterval);
+        });
+}
+
+void SensorManager::setAdaptiveInterval(
+    const AdaptiveInterval& adaptiveInterval, const SensorKey& key) {
+    SensorStateMachine* ssm = mSensorList.findSensorStateMachine(key);
+    if (ssm) {
+        ssm->setAdaptiveInterval(adaptiveInterval);
+    }
+}
+
+const SensorStatistics*
+SensorManager::getSensorStatistics(const SensorKey& key) const {
+    const SensorStateMachine* ssm = mSensorList.findSensorStateMachine(key);
+    return ssm ? &ssm->getStatistics() : nullptr;
+}
+
+void SensorManager::resetStatistics() {
+    for (size_t i = 0; i < mSensorList.count(); ++i) {
         SensorStateMachine* ssm = mSensorList.getSensorStateMachine(i);
-        if (ssm && ssm->getSensor()->getDeviceType() == deviceType) {
-            ssm->setMeasurementInterval(interval);
+        if (ssm) {
+            ssm->resetStatistics();
         }
     }
 }
 
+void SensorManager::setHistory(ISensorHistory* history) {
+    mHistory = history;
+}
+
+ISensorHistory* SensorManager::getHistory() const {
+    return mHistory;
+}
+
+int SensorManager::subscribe(const SensorKey& key,
+                             const SensorSubscriptions::SensorCallback callback,
+                             void* context) {
+    return mSubscriptions.subscribe(key, callback, context);
+}
+
+int SensorManager::subscribe(const core::DeviceType deviceType,
+                             const SensorSubscriptions::SensorCallback callback,
+                             void* context) {
+    return mSubscriptions.subscribe(deviceType, callback, context);
+}
+
+int SensorManager::subscribe(const core::SignalType signalType,
+                             const SensorSubscriptions::SignalCallback callback,
+                             void* context) {
+    return mSubscriptions.subscribe(signalType, callback, context);
+}
+
+void SensorManager::unsubscribe(const int id) {
+    mSubscriptions.unsubscribe(id);
+}
+
 int SensorManager::getMaxNumberOfSensors() {
     return MAX_NUM_SENSORS;
 }
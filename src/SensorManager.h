@@ -2,8 +2,13 @@
 #define SENSOR_MANAGER_H
 
 #include "IAutoDetector.h"
+#include "ISensorHistory.h"
+#include "MeasurementEncoder.h"
 #include "SensirionCore.h"
-#include <vector>
+#include "SensorFrame.h"
+#include "SensorSubscriptions.h"
+#include "SharedSensorFrame.h"
+#include "TextEncoder.h"
 
 namespace sensirion::upt::i2c_autodetect{
 
@@ -14,11 +19,37 @@ class SensorManager {
   private:
     // The number of sensors is limited by size of hash in _sensorList.
     static constexpr uint8_t MAX_NUM_SENSORS = 9;
+    // Upper bound of nextWakeupMs(), such that newly connected sensors are
+    // still detected when no sensor update is pending
+    static constexpr unsigned long MAX_WAKEUP_INTERVAL_MS = 1000;
     SensorList mSensorList;
     IAutoDetector& mDetector;
+    ISensorHistory* mHistory = nullptr;
+    SensorSubscriptions mSubscriptions;
+    // Incremented whenever a sensor delivers a new set of readings
+    uint32_t mGeneration = 0;
+
+    /**
+     * @brief update a state machine, log the errors it reports, record its
+     * new readings to the history and notify the subscribers
+     */
+    void _updateStateMachine(SensorStateMachine* ssm);
+
+    /**
+     * @brief find the state machine whose pending measurement result becomes
+     * available first
+     *
+     * @returns nullptr if no measurement is pending
+     */
+    SensorStateMachine* _nextPendingMeasurement();
+
+    /**
+     * @brief check if the state machine holds a complete set of readings
+     */
+    static bool _hasCompleteReadings(const SensorStateMachine* ssm);
 
   public:
-    using MeasurementList = std::vector<core::Measurement>;
+    using MeasurementList = ISensor::MeasurementList;
     /**
      * @brief constructor
      *
@@ -39,11 +70,37 @@ class SensorManager {
     void refreshConnectedSensors();
 
     /**
-     * @brief Updates all sensor state machines, which fetches signal updates
-     * (whenever available)
+     * @brief Updates the sensor state machines which are due, which fetches
+     * signal updates (whenever available)
+     *
+     * @note Does not wait for measurement results. Measurements started by
+     * this call are read out by the first call after their conversion time,
+     * which nextWakeupMs() accounts for.
      */
     void executeSensorCommunication();
 
+    /**
+     * @brief Wait for the measurements started by executeSensorCommunication()
+     * and read out their results
+     *
+     * @note Blocks for the longest conversion time among the pending
+     * measurements. Only for applications which cannot sleep until
+     * nextWakeupMs() and need the readings right after the call.
+     */
+    void collectPendingMeasurements();
+
+    /**
+     * @brief Time until the next sensor state machine update is due
+     *
+     * Allows the application to sleep until executeSensorCommunication() has
+     * work to do, instead of polling at a fixed rate. Sleeping longer than
+     * the returned time may exceed ready state decay times (eg. SGP41).
+     *
+     * @returns time in ms until the next update, 0 if an update is due now.
+     * At most MAX_WAKEUP_INTERVAL_MS.
+     */
+    unsigned long nextWakeupMs() const;
+
     /**
      * @brief obtain a hashmap of read-only pointers to the sensor signal
      * readings.
@@ -53,9 +110,64 @@ class SensorManager {
      * Size of the hashmap can be queried using
      * SensorManager::getMaxNumberOfSensors(). Existing entries are either
      * ignored or overwritten.
+     *
+     * @note The readings are updated in place by the next
+     * executeSensorCommunication(). Other tasks must access the readings
+     * through publishSensorFrame() instead.
      */
     void getSensorReadings(const MeasurementList* dataHashmap[]);
 
+    /**
+     * @brief obtain a hashmap of read-only pointers to the sensor signal
+     * readings which were updated since a given generation
+     *
+     * @param[in] dataHashmap see getSensorReadings(). Entries of sensors
+     * without new readings are set to nullptr.
+     *
+     * @param[in] sinceGeneration value returned by the previous call, 0 to
+     * obtain all readings
+     *
+     * @returns the current generation, to be passed to the next call
+     */
+    uint32_t getFreshReadings(const MeasurementList* dataHashmap[],
+                              uint32_t sinceGeneration);
+
+    /**
+     * @brief getter method for the generation counter, which is incremented
+     * whenever a sensor delivers a new set of readings
+     */
+    uint32_t getGeneration() const;
+
+    /**
+     * @brief visit the readings of the sensors which were updated since a
+     * given generation, eg. to record or forward them on another task than
+     * the one calling executeSensorCommunication()
+     *
+     * @param[in] sinceGeneration value returned by the previous call, 0 to
+     * visit all readings
+     *
+     * @param[in] visitor callable invoked with (const SensorKey&,
+     * core::DeviceType, const MeasurementList&)
+     *
+     * @returns the current generation, to be passed to the next call
+     */
+    template <typename Visitor>
+    uint32_t forEachFreshReading(const uint32_t sinceGeneration,
+                                 Visitor&& visitor) const {
+        for (size_t i = 0; i < mSensorList.count(); ++i) {
+            const SensorStateMachine* ssm =
+                mSensorList.getSensorStateMachine(i);
+            // Difference is evaluated signed to be robust against overflow
+            if (_hasCompleteReadings(ssm) &&
+                static_cast<int32_t>(ssm->getGeneration() - sinceGeneration) >
+                    0) {
+                visitor(ssm->getKey(), ssm->getSensor()->getDeviceType(),
+                        ssm->getSignals());
+            }
+        }
+        return mGeneration;
+    }
+
     /**
      * @brief convenience function performing the sensor list refresh, state
      * machine update and data window setup
@@ -68,6 +180,73 @@ class SensorManager {
      */
     void refreshAndGetSensorReadings(const MeasurementList* dataHashmap[]);
 
+    /**
+     * @brief obtain a columnar snapshot of the sensor signal readings
+     *
+     * @param[out] frame frame to fill, eg.
+     * SensorFrame<DefaultI2cDetector::CONFIGURED_SENSORS>. Sensors which do
+     * not fit into the frame are left out.
+     */
+    template <class FrameT>
+    void getSensorFrame(FrameT& frame) const {
+        frame.clear();
+        appendToSensorFrame(frame);
+    }
+
+    /**
+     * @brief publish a snapshot of the sensor signal readings to reader tasks
+     *
+     * @param[out] shared frame to publish to, eg.
+     * SharedSensorFrame<DefaultI2cDetector::CONFIGURED_SENSORS>. Readers
+     * obtain consistent copies with SharedSensorFrame::read().
+     *
+     * @note Call from the task calling executeSensorCommunication(). Does not
+     * wait for the readers.
+     */
+    template <class SharedFrameT>
+    void publishSensorFrame(SharedFrameT& shared) const {
+        getSensorFrame(shared.beginWrite());
+        shared.endWrite();
+    }
+
+    /**
+     * @brief encode the sensor signal readings into a compact binary batch,
+     * see MeasurementEncoder for the format
+     *
+     * @param[out] buffer memory into which the batch is written
+     *
+     * @param[in] capacity size of buffer in bytes. Sensors which do not fit
+     * into the buffer are left out.
+     *
+     * @returns The size of the batch in bytes, 0 if the buffer cannot even
+     * hold an empty batch
+     */
+    size_t encodeSensorReadings(uint8_t* buffer, size_t capacity) const;
+
+    /**
+     * @brief write the sensor signal readings as text (CSV, JSON or line
+     * protocol) and terminate the text, see TextEncoder
+     *
+     * @returns The number of characters written
+     */
+    size_t encodeSensorReadings(TextEncoder& encoder) const;
+
+    /**
+     * @brief append the sensor signal readings to a frame, eg. to combine the
+     * readings of several buses. Any class with the append() method of
+     * SensorFrame may serve as frame, eg. MeasurementEncoder.
+     */
+    template <class FrameT>
+    void appendToSensorFrame(FrameT& frame) const {
+        for (size_t i = 0; i < mSensorList.count(); ++i) {
+            const SensorStateMachine* ssm =
+                mSensorList.getSensorStateMachine(i);
+            if (_hasCompleteReadings(ssm)) {
+                frame.append(ssm->getKey(), ssm->getSignals());
+            }
+        }
+    }
+
     /**
      * @brief Sets polling interval for the specified sensor after checking if
      * it is valid
@@ -77,10 +256,145 @@ class SensorManager {
      * @param[in] deviceType target sensor
      *
      * @note Does not return an error in case the validity checks fail, in which
-     * case the interval is not set for the sensor
+     * case the interval is not set for the sensor. Applies to all sensors of
+     * the given type.
      */
     void setInterval(unsigned long interval, core::DeviceType deviceType);
 
+    /**
+     * @brief Sets polling interval for a particular sensor instance after
+     * checking if it is valid
+     *
+     * @param[in] interval desired measurement interval
+     *
+     * @param[in] key bus and address (and optionally deviceID) of the target
+     * sensor
+     *
+     * @note Does not return an error in case the validity checks fail, in which
+     * case the interval is not set for the sensor
+     */
+    void setInterval(unsigned long interval, const SensorKey& key);
+
+    /**
+     * @brief Let the polling interval of the specified sensors adapt to the
+     * dynamics of their signals, see AdaptiveInterval
+     *
+     * @param[in] adaptiveInterval interval bounds and change thresholds
+     *
+     * @param[in] deviceType target sensor
+     *
+     * @note Does not return an error in case the interval bounds are invalid
+     * for the sensor, in which case its interval is left unchanged. Applies
+     * to all sensors of the given type. setInterval() returns to a fixed
+     * interval.
+     */
+    void setAdaptiveInterval(const AdaptiveInterval& adaptiveInterval,
+                             core::DeviceType deviceType);
+
+    /**
+     * @brief Let the polling interval of a particular sensor instance adapt
+     * to the dynamics of its signals, see
+     * setAdaptiveInterval(const AdaptiveInterval&, core::DeviceType)
+     */
+    void setAdaptiveInterval(const AdaptiveInterval& adaptiveInterval,
+                             const SensorKey& key);
+
+    /**
+     * @brief visit the latency histograms and counters of the driver calls
+     * of each sensor, eg. to find slow or marginal sensors
+     *
+     * @param[in] visitor callable invoked with (const SensorKey&,
+     * core::DeviceType, const SensorStatistics&)
+     *
+     * @note The statistics of a sensor are discarded once it is lost
+     */
+    template <typename Visitor>
+    void getStatistics(Visitor&& visitor) const {
+        for (size_t i = 0; i < mSensorList.count(); ++i) {
+            const SensorStateMachine* ssm =
+                mSensorList.getSensorStateMachine(i);
+            if (ssm) {
+                visitor(ssm->getKey(), ssm->getSensor()->getDeviceType(),
+                        ssm->getStatistics());
+            }
+        }
+    }
+
+    /**
+     * @brief getter method for the statistics of a particular sensor
+     *
+     * @param[in] key bus and address (and optionally deviceID) of the sensor
+     *
+     * @returns nullptr if no matching sensor is connected
+     */
+    const SensorStatistics* getSensorStatistics(const SensorKey& key) const;
+
+    /**
+     * @brief reset the statistics of all sensors, eg. after reporting them
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Set the history to which every new set of readings is recorded,
+     * eg. a SensorHistory. A single history is held; a SampleLog forwards
+     * the readings to a further history, see
+     * SampleLog::setDownstreamHistory().
+     *
+     * @param[in] history history to record to, nullptr to stop recording
+     *
+     * @note The history must outlive the SensorManager. Use one history per
+     * SensorManager, since the buses of a MultiBusSensorManager are attended
+     * in parallel; MultiBusSensorManager detaches a history shared by several
+     * of its buses.
+     */
+    void setHistory(ISensorHistory* history);
+
+    /**
+     * @brief getter method for the history set with setHistory(), nullptr
+     * if none
+     */
+    ISensorHistory* getHistory() const;
+
+    /**
+     * @brief Subscribe for the readings of a particular sensor
+     *
+     * @param[in] key bus and address (and optionally deviceID) of the sensor
+     *
+     * @param[in] callback function called right after each successful
+     * readout of the sensor, on the task calling executeSensorCommunication()
+     *
+     * @param[in] context passed to the callback
+     *
+     * @returns subscription id for unsubscribe(), -1 if
+     * SensorSubscriptions::MAX_SUBSCRIPTIONS are taken
+     */
+    int subscribe(const SensorKey& key,
+                  SensorSubscriptions::SensorCallback callback,
+                  void* context = nullptr);
+
+    /**
+     * @brief Subscribe for the readings of all sensors of a DeviceType, see
+     * subscribe(const SensorKey&, ...)
+     */
+    int subscribe(core::DeviceType deviceType,
+                  SensorSubscriptions::SensorCallback callback,
+                  void* context = nullptr);
+
+    /**
+     * @brief Subscribe for the readings of a signal from all sensors
+     * measuring it, see subscribe(const SensorKey&, ...)
+     */
+    int subscribe(core::SignalType signalType,
+                  SensorSubscriptions::SignalCallback callback,
+                  void* context = nullptr);
+
+    /**
+     * @brief Remove a subscription
+     *
+     * @param[in] id subscription id returned by subscribe()
+     */
+    void unsubscribe(int id);
+
     /**
      * @brief getter method for number of sensors
      */
@@ -103,12 +417,35 @@ class SensorManager {
     template <class T>
     AutoDetectorError getSensorDriver(T*& pDriver,
                                       const ISensor::DeviceType deviceType) {
-        if (!mSensorList.containsSensor(deviceType)) {
+        ISensor* pSensor = mSensorList.getSensor(deviceType);
+        if (!pSensor) {
+            return DRIVER_NOT_FOUND_ERROR;
+        }
+        pDriver = static_cast<T*>(pSensor->getDriver());
+        return NO_ERROR;
+    };
+
+    /**
+     * Retrieve the sensor driver instance T of a particular sensor, for
+     * setups with several sensors of the same type.
+     *
+     * @param[in] pDriver nullptr initialized pointer to specific Sensirion
+     * sensor driver class T.
+     *
+     * @param[in] key bus and address (and optionally deviceID) of the sensor.
+     * The caller is responsible that the sensor uses driver class T.
+     *
+     * @returns DRIVER_NOT_FOUND_ERROR in case of failure
+     * to retrieve the driver. Only in case of NO_ERROR may the driver methods
+     * be called. e.g.: pDriver->driverMethod()
+     */
+    template <class T>
+    AutoDetectorError getSensorDriver(T*& pDriver, const SensorKey& key) {
+        const SensorStateMachine* ssm = mSensorList.findSensorStateMachine(key);
+        if (!ssm) {
             return DRIVER_NOT_FOUND_ERROR;
-        } else {
-            pDriver =
-                static_cast<T*>(mSensorList.getSensor(deviceType)->getDriver());
         }
+        pDriver = static_cast<T*>(ssm->getSensor()->getDriver());
         return NO_ERROR;
     };
 };
@@ -1,6 +1,8 @@
 #include "SensorStateMachine.h"
 
 #include <SensirionErrors.h>
+#include <algorithm>
+#include <cmath>
 
 namespace sensirion::upt::i2c_autodetect{
 
@@ -9,31 +11,51 @@ constexpr auto TAG = "SensorStateMachine";
 bool timeIntervalPassed(const uint32_t interval,
                         const uint32_t currentTimeStamp,
                         const uint32_t latestUpdateTimeStamp) {
-    if (currentTimeStamp < interval) {
-        return true;
-    }
-    unsigned long elapsedTime = currentTimeStamp - latestUpdateTimeStamp;
-    return elapsedTime >= interval;
+    // Difference is evaluated signed to be robust against millis() overflow
+    const uint32_t dueTimeStamp = latestUpdateTimeStamp + interval;
+    return static_cast<int32_t>(currentTimeStamp - dueTimeStamp) >= 0;
 }
 
 SensorStateMachine::SensorStateMachine(ISensor* pSensor)
+    : SensorStateMachine(pSensor, SensorKey{}){};
+
+SensorStateMachine::SensorStateMachine(ISensor* pSensor, const SensorKey& key)
     : mSensorState(SensorStatus::UNINITIALIZED), mInitErrorCounter(0),
       mMeasurementErrorCounter(0), mLastMeasurementTimeStampMs(0),
-      mMeasurementIntervalMs(0), mSensor(pSensor) {
+      mMeasurementIntervalMs(0), mNextUpdateTimeStampMs(millis()),
+      mNextInitializationStepTimeStampMs(millis()), mMeasurementPending(false),
+      mMeasurementTriggerTimeStampMs(0), mResultReadyTimeStampMs(0),
+      mNumberOfSamples(0), mGeneration(0), mSensor(pSensor), mKey(key),
+      mAdaptive(false) {
     mSensor->start();
 };
 
 AutoDetectorError SensorStateMachine::_initialize() {
-    uint16_t error = mSensor->initializationStep();
+    unsigned long nextStepInMs = 0;
+    const uint32_t startUs = micros();
+    uint16_t error = mSensor->resumeInitialization(nextStepInMs);
+    _recordOperation(SensorOperation::INITIALIZATION_STEP, startUs, error);
     if (error) {
         char errorMsg[256];
         errorToString(error, errorMsg, 256);
         ESP_LOGE(TAG, "Failed to perform initialization step of sensor %s: %s",
                  mSensor->getDeviceType().data(), errorMsg);
+        // Retry right away
+        mNextInitializationStepTimeStampMs = millis();
         return I2C_ERROR;
     }
-    mMeasurementIntervalMs = mSensor->getMinimumMeasurementIntervalMs();
+    if (nextStepInMs > 0) {
+        // One additional tick compensates for the resolution of millis()
+        mNextInitializationStepTimeStampMs = millis() + nextStepInMs + 1;
+        return NO_ERROR;
+    }
+
+    mMeasurementIntervalMs = mAdaptive
+                                 ? mAdaptiveInterval.minIntervalMs
+                                 : mSensor->getMinimumMeasurementIntervalMs();
+    _resetReferenceValues();
     mLastMeasurementTimeStampMs = millis();
+    mKey.deviceID = mSensor->getMetaData().deviceID;
 
     if (mSensor->getInitializationIntervalMs() > 0) {
         // SGP4X, SCD4X
@@ -90,6 +112,8 @@ AutoDetectorError SensorStateMachine::_readSignalsRoutine() {
 
         case timeLineRegion::OUTSIDE_VALID_INITIALIZATION:
             mSensorState = SensorStatus::UNINITIALIZED;
+            mNextInitializationStepTimeStampMs = millis();
+            mStatistics.readyStateDecayCount++;
             return SENSOR_READY_STATE_DECAYED_ERROR;
 
         default:
@@ -100,10 +124,38 @@ AutoDetectorError SensorStateMachine::_readSignalsRoutine() {
 }
 
 AutoDetectorError SensorStateMachine::_readSignals() {
-    
     const uint32_t nowMS = millis();
+    unsigned long readyInMs = 0;
+    const uint32_t startUs = micros();
+    const uint16_t error = mSensor->triggerMeasurement(readyInMs);
+    _recordOperation(SensorOperation::TRIGGER_MEASUREMENT, startUs, error);
+
+    if (error) {
+        char errorMsg[256];
+        errorToString(error, errorMsg, 256);
+        ESP_LOGE(TAG, "Failed to start measurement for sensor %s: %s",
+                 mSensor->getDeviceType().data(), errorMsg);
+        return I2C_ERROR;
+    }
+
+    mMeasurementTriggerTimeStampMs = nowMS;
+    if (readyInMs > 0) {
+        mMeasurementPending = true;
+        // One additional tick compensates for the resolution of millis()
+        mResultReadyTimeStampMs = millis() + readyInMs + 1;
+        return NO_ERROR;
+    }
+
+    return _fetchSignals();
+}
+
+AutoDetectorError SensorStateMachine::_fetchSignals() {
+    mMeasurementPending = false;
     mSensorSignals.clear();
-    const uint16_t error = mSensor->measureAndWrite(mSensorSignals, nowMS);
+    const uint32_t startUs = micros();
+    const uint16_t error =
+        mSensor->fetchResult(mSensorSignals, mMeasurementTriggerTimeStampMs);
+    _recordOperation(SensorOperation::FETCH_RESULT, startUs, error);
 
     if (error) {
         char errorMsg[256];
@@ -113,23 +165,174 @@ AutoDetectorError SensorStateMachine::_readSignals() {
         return I2C_ERROR;
     }
 
-    mLastMeasurementTimeStampMs = nowMS;
+    mLastMeasurementTimeStampMs = mMeasurementTriggerTimeStampMs;
+    mNumberOfSamples++;
+    if (mAdaptive) {
+        _adaptMeasurementInterval();
+    }
 
     return NO_ERROR;
 }
 
+void SensorStateMachine::_recordOperation(const SensorOperation operation,
+                                          const uint32_t startUs,
+                                          const uint16_t error) {
+    OperationStatistics& statistics = mStatistics[operation];
+    statistics.latency.add(micros() - startUs);
+    if (error) {
+        statistics.errorCount++;
+    } else {
+        statistics.successCount++;
+    }
+}
+
 SensorStatus SensorStateMachine::getSensorState() const {
     return mSensorState;
 }
 
 uint16_t SensorStateMachine::setMeasurementInterval(uint32_t interval) {
     if (interval > mSensor->getMinimumMeasurementIntervalMs()) {
+        mAdaptive = false;
         mMeasurementIntervalMs = interval;
+        _scheduleNextUpdate();
         return NO_ERROR;
     }
     return 1;
 }
 
+uint16_t SensorStateMachine::setAdaptiveInterval(
+    const AdaptiveInterval& adaptiveInterval) {
+    // At least 1 ms, such that the interval can stretch by doubling
+    const uint32_t minIntervalMs = std::max<uint32_t>(
+        {adaptiveInterval.minIntervalMs,
+         static_cast<uint32_t>(mSensor->getMinimumMeasurementIntervalMs()),
+         1});
+    uint32_t maxIntervalMs = adaptiveInterval.maxIntervalMs;
+    const long decayTimeMs = mSensor->readyStateDecayTimeMs();
+    if (decayTimeMs > 0) {
+        // Leave a margin for late updates, which would let the ready state
+        // decay
+        maxIntervalMs =
+            std::min<uint32_t>(maxIntervalMs, decayTimeMs / 10 * 9);
+    }
+    if (maxIntervalMs < minIntervalMs) {
+        return 1;
+    }
+
+    mAdaptive = true;
+    mAdaptiveInterval = adaptiveInterval;
+    mAdaptiveInterval.minIntervalMs = minIntervalMs;
+    mAdaptiveInterval.maxIntervalMs = maxIntervalMs;
+    _resetReferenceValues();
+    mMeasurementIntervalMs = minIntervalMs;
+    _scheduleNextUpdate();
+    return NO_ERROR;
+}
+
+uint32_t SensorStateMachine::getMeasurementIntervalMs() const {
+    return mMeasurementIntervalMs;
+}
+
+void SensorStateMachine::_adaptMeasurementInterval() {
+    const auto& thresholds = mAdaptiveInterval.thresholds;
+    // Signals are matched by SignalType, since the layout of the readings
+    // may change, eg. with the product variant of a SEN5x
+    const core::Measurement* signals[ISensor::MAX_NUMBER_OF_DATA_POINTS] = {};
+    bool changed = false;
+    for (size_t k = 0; k < thresholds.size(); ++k) {
+        for (const auto& measurement : mSensorSignals) {
+            if (measurement.signalType == thresholds[k].signalType) {
+                signals[k] = &measurement;
+                break;
+            }
+        }
+        if (!signals[k]) {
+            continue;
+        }
+        const float value = signals[k]->dataPoint.value;
+        const float reference = mReferenceValues[k];
+        // A signal becoming valid or invalid counts as change, else NaN
+        // would compare as stable forever
+        if (std::isnan(value) != std::isnan(reference) ||
+            std::fabs(value - reference) > thresholds[k].threshold) {
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        for (size_t k = 0; k < thresholds.size(); ++k) {
+            // Invalid readings do not replace the reference
+            if (signals[k] && !std::isnan(signals[k]->dataPoint.value)) {
+                mReferenceValues[k] = signals[k]->dataPoint.value;
+            }
+        }
+        mMeasurementIntervalMs = mAdaptiveInterval.minIntervalMs;
+        return;
+    }
+    // Doubling, without overflowing for long maximum intervals
+    mMeasurementIntervalMs =
+        mMeasurementIntervalMs > mAdaptiveInterval.maxIntervalMs / 2
+            ? mAdaptiveInterval.maxIntervalMs
+            : mMeasurementIntervalMs * 2;
+}
+
+void SensorStateMachine::_resetReferenceValues() {
+    std::fill(std::begin(mReferenceValues), std::end(mReferenceValues), NAN);
+}
+
+void SensorStateMachine::_scheduleNextUpdate() {
+    switch (mSensorState) {
+        case SensorStatus::UNINITIALIZED:
+            mNextUpdateTimeStampMs = mNextInitializationStepTimeStampMs;
+            break;
+
+        case SensorStatus::INITIALIZING:
+            mNextUpdateTimeStampMs = mLastMeasurementTimeStampMs +
+                                     mSensor->getInitializationIntervalMs();
+            break;
+
+        case SensorStatus::RUNNING: {
+            if (mMeasurementPending) {
+                mNextUpdateTimeStampMs = mResultReadyTimeStampMs;
+                break;
+            }
+            mNextUpdateTimeStampMs =
+                mLastMeasurementTimeStampMs + mMeasurementIntervalMs;
+            // Wake up in time to detect the decay if the measurement interval
+            // exceeds the decay time
+            const long decayTimeMs = mSensor->readyStateDecayTimeMs();
+            if (decayTimeMs > 0 &&
+                static_cast<uint32_t>(decayTimeMs) < mMeasurementIntervalMs) {
+                mNextUpdateTimeStampMs =
+                    mLastMeasurementTimeStampMs + decayTimeMs + 1;
+            }
+            break;
+        }
+
+        case SensorStatus::UNDEFINED:
+        case SensorStatus::LOST:
+        default:
+            break;
+    }
+}
+
+bool SensorStateMachine::isUpdateDue(const uint32_t nowMs) const {
+    if (mSensorState == SensorStatus::UNDEFINED ||
+        mSensorState == SensorStatus::LOST) {
+        return false;
+    }
+    // Difference is evaluated signed to be robust against millis() overflow
+    return static_cast<int32_t>(nowMs - mNextUpdateTimeStampMs) >= 0;
+}
+
+uint32_t SensorStateMachine::getNextUpdateTimeStampMs() const {
+    return mNextUpdateTimeStampMs;
+}
+
+bool SensorStateMachine::isMeasurementPending() const {
+    return mMeasurementPending;
+}
+
 AutoDetectorError SensorStateMachine::update() {
     AutoDetectorError error = NO_ERROR;
     switch (mSensorState) {
@@ -137,6 +340,11 @@ AutoDetectorError SensorStateMachine::update() {
             break;
 
         case SensorStatus::UNINITIALIZED:
+            if (static_cast<int32_t>(millis() -
+                                     mNextInitializationStepTimeStampMs) < 0) {
+                // Sensor still busy with the previous initialization step
+                break;
+            }
             error = _initialize();
             if (error) {
                 mInitErrorCounter++;
@@ -150,7 +358,16 @@ AutoDetectorError SensorStateMachine::update() {
             break;
 
         case SensorStatus::RUNNING:
-            error = _readSignalsRoutine();
+            if (mMeasurementPending) {
+                if (static_cast<int32_t>(millis() - mResultReadyTimeStampMs) <
+                    0) {
+                    // Result not yet available
+                    break;
+                }
+                error = _fetchSignals();
+            } else {
+                error = _readSignalsRoutine();
+            }
             if (error) {
                 mMeasurementErrorCounter++;
             } else {
@@ -169,9 +386,14 @@ AutoDetectorError SensorStateMachine::update() {
         return LOST_SENSOR_ERROR;
     }
 
+    _scheduleNextUpdate();
     return error;
 }
 
+const SensorKey& SensorStateMachine::getKey() const {
+    return mKey;
+}
+
 ISensor* SensorStateMachine::getSensor() const {
     return mSensor;
 }
@@ -180,4 +402,24 @@ const ISensor::MeasurementList& SensorStateMachine::getSignals() const {
     return mSensorSignals;
 }
 
+uint32_t SensorStateMachine::getNumberOfSamples() const {
+    return mNumberOfSamples;
+}
+
+void SensorStateMachine::setGeneration(const uint32_t generation) {
+    mGeneration = generation;
+}
+
+uint32_t SensorStateMachine::getGeneration() const {
+    return mGeneration;
+}
+
+const SensorStatistics& SensorStateMachine::getStatistics() const {
+    return mStatistics;
+}
+
+void SensorStateMachine::resetStatistics() {
+    mStatistics = SensorStatistics{};
+}
+
 } // sensirion::upt::i2c_autodetect
@@ -1,8 +1,11 @@
 #ifndef SENSOR_STATE_MACHINE_H
 #define SENSOR_STATE_MACHINE_H
 
+#include "AdaptiveInterval.h"
 #include "AutoDetectorErrors.h"
 #include "ISensor.h"
+#include "SensorKey.h"
+#include "SensorStatistics.h"
 
 namespace sensirion::upt::i2c_autodetect{
 
@@ -31,13 +34,29 @@ class SensorStateMachine {
     uint8_t mMeasurementErrorCounter;
     uint32_t mLastMeasurementTimeStampMs;
     uint32_t mMeasurementIntervalMs;
+    uint32_t mNextUpdateTimeStampMs;
+    uint32_t mNextInitializationStepTimeStampMs;
+    bool mMeasurementPending;
+    uint32_t mMeasurementTriggerTimeStampMs;
+    uint32_t mResultReadyTimeStampMs;
+    uint32_t mNumberOfSamples;
+    uint32_t mGeneration;
 
     ISensor* mSensor;
+    SensorKey mKey;
     MeasurementList mSensorSignals;
+    SensorStatistics mStatistics;
+
+    // Adaptive measurement interval, see setAdaptiveInterval()
+    bool mAdaptive;
+    AdaptiveInterval mAdaptiveInterval;
+    // Reference value of the signal of each threshold of mAdaptiveInterval,
+    // in the same order, NaN if there is none yet
+    float mReferenceValues[ISensor::MAX_NUMBER_OF_DATA_POINTS];
 
     /**
-     * @brief initialize the state machine. Promotes sensor state to
-     * INITIALIZING or RUNNING when appropriate.
+     * @brief perform the next initialization step of the sensor. Promotes
+     * sensor state to INITIALIZING or RUNNING once all steps are completed.
      *
      * @note Needs to be outside of constructor because state machines may decay
      * to UNINITIALIZED
@@ -70,26 +89,75 @@ class SensorStateMachine {
     AutoDetectorError _readSignalsRoutine();
 
     /**
-     * @brief Query sensor for new signals
+     * @brief Start a measurement on the sensor. If the sensor delivers its
+     * result at a later time, the measurement is left pending until
+     * _fetchSignals() is called, else signals are fetched right away.
      *
-     * @return  I2C_ERROR if ISensor::measureAndWrite() fails (in which case the
-     *            error is decoded and printed to logs)
+     * @return  I2C_ERROR if ISensor::triggerMeasurement() or
+     *            ISensor::fetchResult() fails (in which case the error is
+     *            decoded and printed to logs)
      *          NO_ERROR on success
      */
     AutoDetectorError _readSignals();
 
+    /**
+     * @brief Query sensor for the signals of the last triggered measurement
+     *
+     * @return  I2C_ERROR if ISensor::fetchResult() fails (in which case the
+     *            error is decoded and printed to logs)
+     *          NO_ERROR on success
+     */
+    AutoDetectorError _fetchSignals();
+
+    /**
+     * @brief Determine the time at which the next call to update() has an
+     * effect: end of the initialization interval, next measurement or ready
+     * state decay, depending on the sensor state.
+     */
+    void _scheduleNextUpdate();
+
+    /**
+     * @brief count the latency and outcome of a driver call
+     *
+     * @param[in] startUs time as returned by micros() before the call
+     */
+    void _recordOperation(SensorOperation operation, uint32_t startUs,
+                          uint16_t error);
+
+    /**
+     * @brief stretch the adaptive measurement interval if the signals are
+     * stable, or return it to the minimum if they changed
+     */
+    void _adaptMeasurementInterval();
+
+    /**
+     * @brief discard the reference values of the adaptive interval, such
+     * that the next reading becomes the reference
+     */
+    void _resetReferenceValues();
+
   public:
 
     SensorStateMachine()
         : mSensorState(SensorStatus::UNDEFINED), mInitErrorCounter(0),
           mMeasurementErrorCounter(0), mLastMeasurementTimeStampMs(0),
-          mMeasurementIntervalMs(0), mSensor(nullptr){};
+          mMeasurementIntervalMs(0), mNextUpdateTimeStampMs(0),
+          mNextInitializationStepTimeStampMs(0), mMeasurementPending(false),
+          mMeasurementTriggerTimeStampMs(0), mResultReadyTimeStampMs(0),
+          mNumberOfSamples(0), mGeneration(0), mSensor(nullptr),
+          mAdaptive(false){};
 
     /**
      * @brief constructor with ISensor pointer, used by autodetector
      */
     explicit SensorStateMachine(ISensor*);
 
+    /**
+     * @brief constructor with ISensor pointer and the bus and address the
+     * sensor was found at, used by autodetector
+     */
+    SensorStateMachine(ISensor*, const SensorKey& key);
+
     /**
      * @brief getter method for _sensorState
      */
@@ -107,6 +175,25 @@ class SensorStateMachine {
      */
     uint16_t setMeasurementInterval(uint32_t);
 
+    /**
+     * @brief let the measurement interval adapt to the dynamics of the
+     * signals, see AdaptiveInterval. A later call to setMeasurementInterval()
+     * returns to a fixed interval.
+     *
+     * @note Function call has no effect if the maximum interval is shorter
+     * than the minimum one after both are bound by the sensor's minimum
+     * measurement interval and ready state decay time.
+     *
+     * @return  1 if the interval bounds are invalid for the sensor
+     *          NO_ERROR on success
+     */
+    uint16_t setAdaptiveInterval(const AdaptiveInterval& adaptiveInterval);
+
+    /**
+     * @brief getter method for the current measurement interval
+     */
+    uint32_t getMeasurementIntervalMs() const;
+
     /**
      * @brief update state machine
      *
@@ -123,6 +210,32 @@ class SensorStateMachine {
      */
     AutoDetectorError update();
 
+    /**
+     * @brief check if the state machine has pending work at the given time
+     *
+     * @param[in] nowMs current time as returned by millis()
+     *
+     * @returns True if update() is due, false if calling update() would have
+     * no effect. Always false for LOST sensors.
+     */
+    bool isUpdateDue(uint32_t nowMs) const;
+
+    /**
+     * @brief getter method for the time stamp (in millis() time base) at
+     * which update() is due next
+     *
+     * @note Only meaningful for sensors that are not LOST
+     */
+    uint32_t getNextUpdateTimeStampMs() const;
+
+    /**
+     * @brief check if a measurement was started and its result is yet to be
+     * fetched by update()
+     *
+     * @note The result is due at getNextUpdateTimeStampMs()
+     */
+    bool isMeasurementPending() const;
+
     /**
      * @brief getter method for sensor handled by state machine
      *
@@ -130,10 +243,45 @@ class SensorStateMachine {
      */
     ISensor* getSensor() const;
 
+    /**
+     * @brief getter method for the identity of the sensor. The deviceID is
+     * set once the initialization is completed.
+     */
+    const SensorKey& getKey() const;
+
     /**
      * @brief getter method for address of sensor signals
      */
     const MeasurementList& getSignals() const;
+
+    /**
+     * @brief getter method for the number of successful readouts, which
+     * changes whenever getSignals() holds a new set of readings
+     */
+    uint32_t getNumberOfSamples() const;
+
+    /**
+     * @brief setter method for the generation of the readings, ie. the value
+     * of the SensorManager's generation counter when they were obtained
+     */
+    void setGeneration(uint32_t generation);
+
+    /**
+     * @brief getter method for the generation of the readings, 0 if there
+     * are none
+     */
+    uint32_t getGeneration() const;
+
+    /**
+     * @brief getter method for the latency histograms and counters of the
+     * driver calls of the sensor
+     */
+    const SensorStatistics& getStatistics() const;
+
+    /**
+     * @brief reset the latency histograms and counters
+     */
+    void resetStatistics();
 };
 
 } // namespace sensirion::upt::i2c_autodetect 
@@ -0,0 +1,150 @@
+#ifndef SENSOR_STATISTICS_H
+#define SENSOR_STATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Histogram of latencies in microseconds with fixed memory. The buckets are
+ * log-linear: every power of two is split into SUB_BUCKETS buckets, such that
+ * percentiles are accurate to 25%. Latencies beyond the last bucket are
+ * counted in the last bucket. When a bucket saturates, all buckets are
+ * halved, which keeps the shape of the distribution and weights recent
+ * latencies more. */
+class LatencyHistogram {
+  public:
+    static constexpr size_t SUB_BUCKETS = 4;
+    // Covers latencies up to 2^21 us (about 2 s)
+    static constexpr size_t NUMBER_OF_BUCKETS = 20 * SUB_BUCKETS;
+
+    /**
+     * @brief count a latency
+     */
+    void add(const uint32_t latencyUs) {
+        if (latencyUs > mMaxUs || mCount == 0) {
+            mMaxUs = latencyUs;
+        }
+        mCount++;
+        uint16_t& bucket = mBuckets[_bucketIndex(latencyUs)];
+        if (bucket == UINT16_MAX) {
+            for (auto& b : mBuckets) {
+                b /= 2;
+            }
+        }
+        bucket++;
+    }
+
+    /**
+     * @brief estimate a percentile of the latencies
+     *
+     * @param[in] percent percentile to estimate, eg. 50 or 99
+     *
+     * @returns The upper bound of the bucket holding the percentile, at most
+     * the largest latency. 0 if there are no latencies.
+     */
+    uint32_t getPercentileUs(const uint8_t percent) const {
+        uint32_t total = 0;
+        for (const auto b : mBuckets) {
+            total += b;
+        }
+        if (total == 0) {
+            return 0;
+        }
+        // Rank of the percentile, rounded up
+        const uint32_t rank =
+            (static_cast<uint64_t>(total) * (percent < 100 ? percent : 100) +
+             99) /
+            100;
+        uint32_t cumulated = 0;
+        for (size_t i = 0; i < NUMBER_OF_BUCKETS; ++i) {
+            cumulated += mBuckets[i];
+            if (cumulated >= rank && cumulated > 0) {
+                const uint32_t upperUs = _bucketUpperBoundUs(i);
+                return upperUs < mMaxUs ? upperUs : mMaxUs;
+            }
+        }
+        return mMaxUs;
+    }
+
+    /**
+     * @brief getter method for the number of counted latencies
+     */
+    uint32_t getCount() const {
+        return mCount;
+    }
+
+    /**
+     * @brief getter method for the largest counted latency
+     */
+    uint32_t getMaxUs() const {
+        return mMaxUs;
+    }
+
+    void clear() {
+        *this = LatencyHistogram{};
+    }
+
+  private:
+    uint16_t mBuckets[NUMBER_OF_BUCKETS] = {};
+    uint32_t mCount = 0;
+    uint32_t mMaxUs = 0;
+
+    static size_t _bucketIndex(const uint32_t latencyUs) {
+        if (latencyUs < SUB_BUCKETS) {
+            return latencyUs;
+        }
+        // Position of the leading bit, at least 2
+        const size_t octave = 31 - __builtin_clz(latencyUs);
+        const size_t sub = (latencyUs >> (octave - 2)) & (SUB_BUCKETS - 1);
+        const size_t index = (octave - 1) * SUB_BUCKETS + sub;
+        return index < NUMBER_OF_BUCKETS ? index : NUMBER_OF_BUCKETS - 1;
+    }
+
+    static uint32_t _bucketUpperBoundUs(const size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        const size_t octave = index / SUB_BUCKETS + 1;
+        const uint32_t width = 1u << (octave - 2);
+        const uint32_t lower = (SUB_BUCKETS + index % SUB_BUCKETS) * width;
+        return lower + width - 1;
+    }
+};
+
+/* Operations of a sensor on the bus whose latencies are tracked */
+enum class SensorOperation : uint8_t {
+    INITIALIZATION_STEP,  // ISensor::resumeInitialization()
+    TRIGGER_MEASUREMENT,  // ISensor::triggerMeasurement(), includes the
+                          // readout for sensors without split-phase support
+    FETCH_RESULT,         // ISensor::fetchResult()
+    NUMBER_OF_OPERATIONS
+};
+
+/* Latencies and outcome counters of one operation of a sensor */
+struct OperationStatistics {
+    LatencyHistogram latency;
+    uint32_t successCount = 0;
+    uint32_t errorCount = 0;
+};
+
+/* Statistics of a sensor, kept by its SensorStateMachine */
+struct SensorStatistics {
+    OperationStatistics
+        operations[static_cast<size_t>(SensorOperation::NUMBER_OF_OPERATIONS)];
+    // Number of times the sensor had to be initialized again because its
+    // ready state decayed
+    uint32_t readyStateDecayCount = 0;
+
+    OperationStatistics& operator[](const SensorOperation operation) {
+        return operations[static_cast<size_t>(operation)];
+    }
+
+    const OperationStatistics&
+    operator[](const SensorOperation operation) const {
+        return operations[static_cast<size_t>(operation)];
+    }
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* SENSOR_STATISTICS_H */
@@ -0,0 +1,95 @@
+#include "SensorSubscriptions.h"
+
+namespace sensirion::upt::i2c_autodetect{
+
+int SensorSubscriptions::subscribe(const SensorKey& key,
+                                   const SensorCallback callback,
+                                   void* context) {
+    Subscription subscription;
+    subscription.filter = Filter::SENSOR;
+    subscription.key = key;
+    subscription.sensorCallback = callback;
+    subscription.context = context;
+    return _add(subscription);
+}
+
+int SensorSubscriptions::subscribe(const core::DeviceType deviceType,
+                                   const SensorCallback callback,
+                                   void* context) {
+    Subscription subscription;
+    subscription.filter = Filter::DEVICE_TYPE;
+    subscription.deviceType = deviceType;
+    subscription.sensorCallback = callback;
+    subscription.context = context;
+    return _add(subscription);
+}
+
+int SensorSubscriptions::subscribe(const core::SignalType signalType,
+                                   const SignalCallback callback,
+                                   void* context) {
+    Subscription subscription;
+    subscription.filter = Filter::SIGNAL_TYPE;
+    subscription.signalType = signalType;
+    subscription.signalCallback = callback;
+    subscription.context = context;
+    return _add(subscription);
+}
+
+int SensorSubscriptions::_add(const Subscription& subscription) {
+    if (!subscription.sensorCallback && !subscription.signalCallback) {
+        return -1;
+    }
+    for (size_t i = 0; i < MAX_SUBSCRIPTIONS; ++i) {
+        if (mSubscriptions[i].filter == Filter::NONE) {
+            mSubscriptions[i] = subscription;
+            mNumberOfSubscriptions++;
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void SensorSubscriptions::unsubscribe(const int id) {
+    if (id < 0 || static_cast<size_t>(id) >= MAX_SUBSCRIPTIONS ||
+        mSubscriptions[id].filter == Filter::NONE) {
+        return;
+    }
+    mSubscriptions[id] = Subscription{};
+    mNumberOfSubscriptions--;
+}
+
+void SensorSubscriptions::notify(
+    const SensorKey& key, const core::DeviceType deviceType,
+    const ISensor::MeasurementList& measurements) const {
+    for (const Subscription& subscription : mSubscriptions) {
+        switch (subscription.filter) {
+            case Filter::SENSOR:
+                if (key.matches(subscription.key)) {
+                    subscription.sensorCallback(key, measurements,
+                                                subscription.context);
+                }
+                break;
+
+            case Filter::DEVICE_TYPE:
+                if (deviceType == subscription.deviceType) {
+                    subscription.sensorCallback(key, measurements,
+                                                subscription.context);
+                }
+                break;
+
+            case Filter::SIGNAL_TYPE:
+                for (const auto& measurement : measurements) {
+                    if (measurement.signalType == subscription.signalType) {
+                        subscription.signalCallback(key, measurement,
+                                                    subscription.context);
+                    }
+                }
+                break;
+
+            case Filter::NONE:
+            default:
+                break;
+        }
+    }
+}
+} // namespace sensirion::upt::i2c_autodetect
@@ -0,0 +1,106 @@
+#ifndef SENSOR_SUBSCRIPTIONS_H
+#define SENSOR_SUBSCRIPTIONS_H
+
+#include "ISensor.h"
+#include "SensorKey.h"
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* Table of the consumers to notify of new sensor readings. Consumers
+ * subscribe for a particular sensor, for all sensors of a DeviceType or for a
+ * SignalType, with a plain function pointer and context, such that no heap
+ * memory is used. */
+class SensorSubscriptions {
+  public:
+    /// Callback for the subscriptions for a sensor or DeviceType, receiving
+    /// all readings of the sensor
+    using SensorCallback = void (*)(const SensorKey& key,
+                                    const ISensor::MeasurementList& measurements,
+                                    void* context);
+    /// Callback for the subscriptions for a SignalType, receiving the reading
+    /// of the signal
+    using SignalCallback = void (*)(const SensorKey& key,
+                                    const core::Measurement& measurement,
+                                    void* context);
+
+    static constexpr size_t MAX_SUBSCRIPTIONS = 8;
+
+    /**
+     * @brief subscribe for the readings of a particular sensor
+     *
+     * @param[in] key bus and address (and optionally deviceID) of the sensor
+     *
+     * @param[in] callback function called with each new set of readings
+     *
+     * @param[in] context passed to the callback
+     *
+     * @returns subscription id, -1 if MAX_SUBSCRIPTIONS are taken
+     */
+    int subscribe(const SensorKey& key, SensorCallback callback,
+                  void* context = nullptr);
+
+    /**
+     * @brief subscribe for the readings of all sensors of a DeviceType
+     */
+    int subscribe(core::DeviceType deviceType, SensorCallback callback,
+                  void* context = nullptr);
+
+    /**
+     * @brief subscribe for the readings of a signal, from all sensors
+     * measuring it
+     */
+    int subscribe(core::SignalType signalType, SignalCallback callback,
+                  void* context = nullptr);
+
+    /**
+     * @brief remove a subscription
+     *
+     * @param[in] id subscription id returned by subscribe()
+     */
+    void unsubscribe(int id);
+
+    /**
+     * @brief call the callbacks of the subscriptions matching the readings
+     *
+     * @param[in] key identity of the sensor
+     *
+     * @param[in] deviceType type of the sensor
+     *
+     * @param[in] measurements new readings of the sensor
+     */
+    void notify(const SensorKey& key, core::DeviceType deviceType,
+                const ISensor::MeasurementList& measurements) const;
+
+    /**
+     * @brief check if there are no subscriptions
+     */
+    bool empty() const {
+        return mNumberOfSubscriptions == 0;
+    }
+
+  private:
+    enum class Filter { NONE, SENSOR, DEVICE_TYPE, SIGNAL_TYPE };
+
+    struct Subscription {
+        Filter filter = Filter::NONE;
+        SensorKey key;
+        core::DeviceType deviceType;
+        core::SignalType signalType;
+        SensorCallback sensorCallback = nullptr;
+        SignalCallback signalCallback = nullptr;
+        void* context = nullptr;
+    };
+
+    Subscription mSubscriptions[MAX_SUBSCRIPTIONS];
+    size_t mNumberOfSubscriptions = 0;
+
+    /**
+     * @brief store a subscription in a free slot
+     *
+     * @returns index of the slot, -1 if there is none
+     */
+    int _add(const Subscription& subscription);
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* SENSOR_SUBSCRIPTIONS_H */
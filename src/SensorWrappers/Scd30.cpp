@@ -1,4 +1,5 @@
 #include "SensorWrappers/Scd30.h"
+#include "I2cCommand.h"
 #include "SensirionCore.h"
 #include "Sensirion_UPT_Core.h"
 
@@ -60,6 +61,49 @@ uint16_t Scd30::measureAndWrite(MeasurementList& measurements,
     return HighLevelError::NoError;
 }
 
+uint16_t Scd30::triggerMeasurement(unsigned long& readyInMs) {
+    // Query the data ready flag, 3ms execution time. The query also takes the
+    // role of the one at the end of measureAndWrite().
+    readyInMs = 3;
+    return sendI2cCommand(_wire, static_cast<uint8_t>(_address), 0x0202, 2);
+}
+
+uint16_t Scd30::fetchResult(MeasurementList& measurements,
+                            const unsigned long timeStamp) {
+    uint16_t dataReadyFlag = 0;
+    uint16_t error =
+        readI2cWords(_wire, static_cast<uint8_t>(_address), &dataReadyFlag, 1);
+    if (error) {
+        return error;
+    }
+    if (!dataReadyFlag) {
+        return 1;
+    }
+
+    float co2Concentration;
+    float temperature;
+    float humidity;
+    error =
+        _driver.readMeasurementData(co2Concentration, temperature, humidity);
+    if (error) {
+        return error;
+    }
+
+    measurements.emplace_back(_metaData, 
+        core::SignalType::CO2_PARTS_PER_MILLION,
+        core::DataPoint{timeStamp, co2Concentration});
+
+    measurements.emplace_back(_metaData, 
+        core::SignalType::TEMPERATURE_DEGREES_CELSIUS, 
+        core::DataPoint{timeStamp, temperature});
+
+    measurements.emplace_back(_metaData, 
+        core::SignalType::RELATIVE_HUMIDITY_PERCENTAGE, 
+        core::DataPoint{timeStamp, humidity});
+
+    return HighLevelError::NoError;
+}
+
 uint16_t Scd30::initializationStep() {
     // stop potentially previously started measurement
     _driver.stopPeriodicMeasurement();
@@ -92,7 +136,7 @@ core::MetaData Scd30::getMetaData() const {
 }
 
 size_t Scd30::getNumberOfDataPoints() const {
-    return 3;
+    return NUMBER_OF_DATA_POINTS;
 }
 
 unsigned long Scd30::getMinimumMeasurementIntervalMs() const {
@@ -1,4 +1,5 @@
 #include "SensorWrappers/Scd4x.h"
+#include "I2cCommand.h"
 #include "SensirionCore.h"
 #include "Sensirion_UPT_Core.h"
 
@@ -39,14 +40,27 @@ uint16_t Scd4x::measureAndWrite(MeasurementList& measurements,
 }
 
 uint16_t Scd4x::initializationStep() {
-    // stop potentially previously started measurement
-    uint16_t error = mDriver.stopPeriodicMeasurement();
-    if (error) {
-        return error;
+    return initializeBlocking();
+}
+
+uint16_t Scd4x::resumeInitialization(unsigned long& nextStepInMs) {
+    nextStepInMs = 0;
+    if (mInitializationStep == 0) {
+        // stop potentially previously started measurement, which takes 500ms
+        const uint16_t error =
+            sendI2cCommand(mWire, static_cast<uint8_t>(mAddress), 0x3F86, 2);
+        if (error) {
+            return error;
+        }
+        mInitializationStep = 1;
+        nextStepInMs = 500;
+        return HighLevelError::NoError;
     }
+    mInitializationStep = 0;
+
     // Sensor Serial no.
     uint64_t serialNumber;
-    error = mDriver.getSerialNumber(serialNumber);
+    uint16_t error = mDriver.getSerialNumber(serialNumber);
     if (error) {
         return error;
     }
@@ -68,7 +82,7 @@ core::MetaData Scd4x::getMetaData() const {
 }
 
 size_t Scd4x::getNumberOfDataPoints() const {
-    return 3;
+    return NUMBER_OF_DATA_POINTS;
 }
 
 unsigned long Scd4x::getMinimumMeasurementIntervalMs() const {
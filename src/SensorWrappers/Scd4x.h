@@ -9,11 +9,14 @@ namespace sensirion::upt::i2c_autodetect{
 
 class Scd4x : public ISensor {
   public:
+    static constexpr size_t NUMBER_OF_DATA_POINTS = 3;
+
     explicit Scd4x(TwoWire& wire, uint16_t address);
     uint16_t start() override;
     uint16_t measureAndWrite(MeasurementList& measurements,
                              const unsigned long timeStamp) override;
     uint16_t initializationStep() override;
+    uint16_t resumeInitialization(unsigned long& nextStepInMs) override;
     DeviceType getDeviceType() const override;
     core::MetaData getMetaData() const override;
     size_t getNumberOfDataPoints() const override;
@@ -27,6 +30,7 @@ class Scd4x : public ISensor {
     uint16_t mAddress;
     SensirionI2cScd4x mDriver;
     core::MetaData mMetadata;
+    uint8_t mInitializationStep = 0;
 };
 } // namespace sensirion::upt::i2c_autodetect 
 
@@ -1,6 +1,7 @@
 #include "SensorWrappers/Sen5x.h"
+#include "I2cCommand.h"
 #include "SensirionCore.h"
-#include <map>
+#include <utility>
 
 namespace sensirion::upt::i2c_autodetect{
 
@@ -84,14 +85,26 @@ uint16_t Sen5x::measureAndWrite(MeasurementList& measurements,
 }
 
 uint16_t Sen5x::initializationStep() {
-    // stop potentially previously started measurement
-    uint16_t error = _driver.stopMeasurement();
-    if (error) {
-        return error;
+    return initializeBlocking();
+}
+
+uint16_t Sen5x::resumeInitialization(unsigned long& nextStepInMs) {
+    nextStepInMs = 0;
+    if (_initializationStep == 0) {
+        // stop potentially previously started measurement, which takes 200ms
+        const uint16_t error =
+            sendI2cCommand(_wire, static_cast<uint8_t>(_address), 0x0104, 2);
+        if (error) {
+            return error;
+        }
+        _initializationStep = 1;
+        nextStepInMs = 200;
+        return HighLevelError::NoError;
     }
+    _initializationStep = 0;
 
     // Get sensor version (SEN50/SEN54/SEN55)
-    error = _determineSensorVersion();
+    uint16_t error = _determineSensorVersion();
     if (error) {
         return error;
     }
@@ -132,17 +145,19 @@ core::MetaData Sen5x::getMetaData() const {
 }
 
 size_t Sen5x::getNumberOfDataPoints() const {
-    static std::map<core::DeviceType, size_t> deviceToSignalCount = {
+    // Looked up in a constant table, such that no heap memory is allocated
+    static const std::pair<core::DeviceType, size_t> deviceToSignalCount[] = {
         {core::SEN5X(), 4},
         {core::SEN50(), 4},
         {core::SEN54(), 7},
-        {core::SEN55(), 8},
+        {core::SEN55(), NUMBER_OF_DATA_POINTS},
     };
-    const auto iter = deviceToSignalCount.find(getDeviceType());
-    if (iter == deviceToSignalCount.cend()){
-        return 0;
+    for (const auto& entry : deviceToSignalCount) {
+        if (entry.first == getDeviceType()) {
+            return entry.second;
+        }
     }
-    return iter->second;
+    return 0;
 }
 
 unsigned long Sen5x::getMinimumMeasurementIntervalMs() const {
@@ -9,11 +9,15 @@ namespace sensirion::upt::i2c_autodetect{
 
 class Sen5x : public ISensor {
   public:
+    // Number of DataPoints of the SEN55, the other variants deliver fewer
+    static constexpr size_t NUMBER_OF_DATA_POINTS = 8;
+
     explicit Sen5x(TwoWire& wire, uint16_t address);
     uint16_t start() override;
     uint16_t measureAndWrite(MeasurementList&,
                              const unsigned long timeStamp) override;
     uint16_t initializationStep() override;
+    uint16_t resumeInitialization(unsigned long& nextStepInMs) override;
     DeviceType getDeviceType() const override;
     core::MetaData getMetaData() const override;
     size_t getNumberOfDataPoints() const override;
@@ -25,6 +29,7 @@ class Sen5x : public ISensor {
     SensirionI2CSen5x _driver;
     uint16_t _address;
     core::MetaData _metaData;
+    uint8_t _initializationStep = 0;
     uint16_t _determineSensorVersion();
 };
 } // namespace sensirion::upt::i2c_autodetect 
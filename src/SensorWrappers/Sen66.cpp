@@ -1,4 +1,5 @@
 #include "SensorWrappers/Sen66.h"
+#include "I2cCommand.h"
 #include "SensirionCore.h"
 
 namespace sensirion::upt::i2c_autodetect{
@@ -91,18 +92,29 @@ uint16_t Sen66::measureAndWrite(MeasurementList& measurements,
 }
 
 uint16_t Sen66::initializationStep() {
-    // Reset the device to ensure a known state
-    uint16_t error = mDriver.deviceReset();
-    if (error) {
-        return error;
-    }
+    return initializeBlocking();
+}
 
-    delay(1200);
+uint16_t Sen66::resumeInitialization(unsigned long& nextStepInMs) {
+    nextStepInMs = 0;
+    if (mInitializationStep == 0) {
+        // Reset the device to ensure a known state. Sent without the driver,
+        // which would block for the reset duration.
+        const uint16_t error =
+            sendI2cCommand(mWire, static_cast<uint8_t>(mAddress), 0xD304, 2);
+        if (error) {
+            return error;
+        }
+        mInitializationStep = 1;
+        nextStepInMs = 1200;
+        return HighLevelError::NoError;
+    }
+    mInitializationStep = 0;
 
     // Get sensor unique ID (last 8 chars of serial no.)
     constexpr uint16_t serialNumberSize = 32;
     int8_t serialNumber[serialNumberSize] = {0};
-    error = mDriver.getSerialNumber(serialNumber, serialNumberSize);
+    uint16_t error = mDriver.getSerialNumber(serialNumber, serialNumberSize);
     if (error) {
         return error;
     }
@@ -133,7 +145,7 @@ core::MetaData Sen66::getMetaData() const {
 }
 
 size_t Sen66::getNumberOfDataPoints() const {
-    return 9;
+    return NUMBER_OF_DATA_POINTS;
 }
 
 unsigned long Sen66::getMinimumMeasurementIntervalMs() const {
@@ -9,11 +9,14 @@ namespace sensirion::upt::i2c_autodetect{
 
 class Sen66 : public ISensor {
   public:
+    static constexpr size_t NUMBER_OF_DATA_POINTS = 9;
+
     explicit Sen66(TwoWire& wire, uint16_t address);
     uint16_t start() override;
     uint16_t measureAndWrite(MeasurementList& measurements,
                              unsigned long timeStamp) override;
     uint16_t initializationStep() override;
+    uint16_t resumeInitialization(unsigned long& nextStepInMs) override;
     DeviceType getDeviceType() const override;
     core::MetaData getMetaData() const override;
     size_t getNumberOfDataPoints() const override;
@@ -26,6 +29,7 @@ class Sen66 : public ISensor {
     SensirionI2cSen66 mDriver;
     uint16_t mAddress;
     core::MetaData mMetaData;
+    uint8_t mInitializationStep = 0;
 };
 } // namespace sensirion::upt::i2c_autodetect 
 
@@ -75,7 +75,7 @@ core::MetaData Sfa3x::getMetaData() const {
 }
 
 size_t Sfa3x::getNumberOfDataPoints() const {
-    return 3;
+    return NUMBER_OF_DATA_POINTS;
 }
 
 unsigned long Sfa3x::getMinimumMeasurementIntervalMs() const {
@@ -9,6 +9,8 @@ namespace sensirion::upt::i2c_autodetect{
 
 class Sfa3x : public ISensor {
   public:
+    static constexpr size_t NUMBER_OF_DATA_POINTS = 3;
+
     explicit Sfa3x(TwoWire& wire, uint16_t address);
     uint16_t start() override;
     uint16_t measureAndWrite(MeasurementList& measurements,
@@ -1,4 +1,5 @@
 #include "SensorWrappers/Sgp4x.h"
+#include "I2cCommand.h"
 #include "SensirionCore.h"
 #include "Sensirion_UPT_Core.h"
 
@@ -36,6 +37,33 @@ uint16_t Sgp41::measureAndWrite(MeasurementList& measurements,
     return HighLevelError::NoError;
 }
 
+uint16_t Sgp41::triggerMeasurement(unsigned long& readyInMs) {
+    // Measure raw signals, 50ms max. duration
+    readyInMs = 50;
+    const uint16_t compensation[] = {_defaultRh, _defaultT};
+    return sendI2cCommand(_wire, static_cast<uint8_t>(_address), 0x2619, 2,
+                          compensation, 2);
+}
+
+uint16_t Sgp41::fetchResult(MeasurementList& measurements,
+                            const unsigned long timeStamp) {
+    uint16_t raw[2];
+    uint16_t error = readI2cWords(_wire, static_cast<uint8_t>(_address), raw, 2);
+    if (error) {
+        return error;
+    }
+
+    measurements.emplace_back(mMetadata, 
+        core::SignalType::RAW_VOC_INDEX,
+        core::DataPoint{timeStamp, static_cast<float>(raw[0])});
+
+    measurements.emplace_back(mMetadata, 
+        core::SignalType::RAW_NOX_INDEX,
+        core::DataPoint{timeStamp, static_cast<float>(raw[1])});
+
+    return HighLevelError::NoError;
+}
+
 uint16_t Sgp41::initializationStep() {
     // Read serial No.
     uint16_t serialNo[3];
@@ -62,7 +90,7 @@ core::MetaData Sgp41::getMetaData() const {
 }
 
 size_t Sgp41::getNumberOfDataPoints() const {
-    return 2;
+    return NUMBER_OF_DATA_POINTS;
 }
 
 unsigned long Sgp41::getMinimumMeasurementIntervalMs() const {
@@ -9,10 +9,15 @@ namespace sensirion::upt::i2c_autodetect{
 
 class Sgp41 : public ISensor {
   public:
+    static constexpr size_t NUMBER_OF_DATA_POINTS = 2;
+
     explicit Sgp41(TwoWire& wire, uint16_t address);
     uint16_t start() override;
     uint16_t measureAndWrite(MeasurementList& measurements,
                              const unsigned long timeStamp) override;
+    uint16_t triggerMeasurement(unsigned long& readyInMs) override;
+    uint16_t fetchResult(MeasurementList& measurements,
+                         unsigned long timeStamp) override;
     uint16_t initializationStep() override;
     DeviceType getDeviceType() const override;
     core::MetaData getMetaData() const override;
@@ -1,4 +1,5 @@
 #include "SensorWrappers/Sht4x.h"
+#include "I2cCommand.h"
 #include "SensirionCore.h"
 #include "Sensirion_UPT_Core.h"
 
@@ -14,6 +15,10 @@ uint16_t Sht4x::start() {
     return HighLevelError::NoError;
 }
 
+void Sht4x::setI2cAddress(const uint16_t address) {
+    _address = address;
+}
+
 uint16_t Sht4x::measureAndWrite(MeasurementList& measurements,
                                 const unsigned long timeStamp) {
     float temperature;
@@ -34,6 +39,35 @@ uint16_t Sht4x::measureAndWrite(MeasurementList& measurements,
     return HighLevelError::NoError;
 }
 
+uint16_t Sht4x::triggerMeasurement(unsigned long& readyInMs) {
+    // Measure T & RH with high precision, 8.3ms max. duration
+    readyInMs = 10;
+    return sendI2cCommand(_wire, static_cast<uint8_t>(_address), 0xFD, 1);
+}
+
+uint16_t Sht4x::fetchResult(MeasurementList& measurements,
+                            const unsigned long timeStamp) {
+    uint16_t ticks[2];
+    uint16_t error =
+        readI2cWords(_wire, static_cast<uint8_t>(_address), ticks, 2);
+    if (error) {
+        return error;
+    }
+    // Conversion as in SensirionI2cSht4x
+    const float temperature = -45.0f + 175.0f * ticks[0] / 65535.0f;
+    const float humi = -6.0f + 125.0f * ticks[1] / 65535.0f;
+
+    measurements.emplace_back(mMetadata, 
+        core::SignalType::TEMPERATURE_DEGREES_CELSIUS,
+        core::DataPoint{timeStamp, temperature});
+
+    measurements.emplace_back(mMetadata, 
+        core::SignalType::RELATIVE_HUMIDITY_PERCENTAGE,
+        core::DataPoint{timeStamp, humi});
+
+    return HighLevelError::NoError;
+}
+
 uint16_t Sht4x::initializationStep() {
     uint32_t serialNo;
     uint16_t error = _driver.serialNumber(serialNo);
@@ -53,7 +87,7 @@ MetaData Sht4x::getMetaData() const {
 }
 
 size_t Sht4x::getNumberOfDataPoints() const {
-    return 2;
+    return NUMBER_OF_DATA_POINTS;
 }
 
 unsigned long Sht4x::getMinimumMeasurementIntervalMs() const {
@@ -1,4 +1,5 @@
 #include "SensorWrappers/Stc3x.h"
+#include "I2cCommand.h"
 #include "SensirionCore.h"
 #include "Sensirion_UPT_Core.h"
 
@@ -15,6 +16,10 @@ uint16_t Stc3x::start() {
     return error;
 }
 
+void Stc3x::setI2cAddress(const uint16_t address) {
+    _address = address;
+}
+
 uint16_t Stc3x::measureAndWrite(MeasurementList& measurements,
                                 const unsigned long timeStamp) {
     float gasValue;
@@ -37,6 +42,34 @@ uint16_t Stc3x::measureAndWrite(MeasurementList& measurements,
     return HighLevelError::NoError;
 }
 
+uint16_t Stc3x::triggerMeasurement(unsigned long& readyInMs) {
+    // Measure gas concentration, 66ms max. duration
+    readyInMs = 70;
+    return sendI2cCommand(_wire, static_cast<uint8_t>(_address), 0x3639, 2);
+}
+
+uint16_t Stc3x::fetchResult(MeasurementList& measurements,
+                            const unsigned long timeStamp) {
+    uint16_t raw[2];
+    uint16_t error = readI2cWords(_wire, static_cast<uint8_t>(_address), raw, 2);
+    if (error) {
+        return error;
+    }
+    // Conversion as in SensirionI2cStc3x
+    const float gasValue = 100.0f * (raw[0] - 16384.0f) / 32768.0f;
+    const float temperatureValue = static_cast<int16_t>(raw[1]) / 200.0f;
+
+    measurements.emplace_back(mMetadata, 
+        core::SignalType::GAS_CONCENTRATION_VOLUME_PERCENTAGE,
+        core::DataPoint{timeStamp, gasValue});
+
+    measurements.emplace_back(mMetadata, 
+        core::SignalType::TEMPERATURE_DEGREES_CELSIUS,
+        core::DataPoint{timeStamp, temperatureValue});
+
+    return HighLevelError::NoError;
+}
+
 uint16_t Stc3x::initializationStep() {
     uint16_t error = _driver.prepareProductIdentifier();
     if (error) {
@@ -116,7 +149,7 @@ core::MetaData Stc3x::getMetaData() const {
 }
 
 size_t Stc3x::getNumberOfDataPoints() const {
-    return 2;
+    return NUMBER_OF_DATA_POINTS;
 }
 
 unsigned long Stc3x::getMinimumMeasurementIntervalMs() const {
@@ -9,16 +9,23 @@ namespace sensirion::upt::i2c_autodetect{
 
 class Stc3x : public ISensor {
   public:
+    static constexpr size_t NUMBER_OF_DATA_POINTS = 2;
+
     explicit Stc3x(TwoWire& wire, uint16_t address);
     uint16_t start() override;
     uint16_t measureAndWrite(MeasurementList& measurements,
                              const unsigned long timeStamp) override;
+    uint16_t triggerMeasurement(unsigned long& readyInMs) override;
+    uint16_t fetchResult(MeasurementList& measurements,
+                         unsigned long timeStamp) override;
     uint16_t initializationStep() override;
     DeviceType getDeviceType() const override;
     core::MetaData getMetaData() const override;
     size_t getNumberOfDataPoints() const override;
     unsigned long getMinimumMeasurementIntervalMs() const override;
     void* getDriver() override;
+    // Takes effect at the next start()
+    void setI2cAddress(uint16_t address);
 
   private:
     TwoWire& _wire;
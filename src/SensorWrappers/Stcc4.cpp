@@ -1,4 +1,5 @@
 #include "SensorWrappers/Stcc4.h"
+#include "I2cCommand.h"
 #include "SensirionCore.h"
 #include "Sensirion_UPT_Core.h"
 
@@ -43,15 +44,27 @@ uint16_t Stcc4::measureAndWrite(MeasurementList& measurements,
 }
 
 uint16_t Stcc4::initializationStep() {
-    // stop potentially previously started measurement
-    uint16_t error = _driver.stopContinuousMeasurement();
-    if (error) {
-        return error;
+    return initializeBlocking();
+}
+
+uint16_t Stcc4::resumeInitialization(unsigned long& nextStepInMs) {
+    nextStepInMs = 0;
+    if (_initializationStep == 0) {
+        // stop potentially previously started measurement, which takes 1200ms
+        const uint16_t error =
+            sendI2cCommand(_wire, static_cast<uint8_t>(_address), 0x3F86, 2);
+        if (error) {
+            return error;
+        }
+        _initializationStep = 1;
+        nextStepInMs = 1200;
+        return HighLevelError::NoError;
     }
+    _initializationStep = 0;
 
     uint32_t productId;
     uint64_t serialNumber;
-    error = _driver.getProductId(productId, serialNumber);
+    uint16_t error = _driver.getProductId(productId, serialNumber);
     if (error) {
         return error;
     }
@@ -71,7 +84,7 @@ core::MetaData Stcc4::getMetaData() const {
 }
 
 size_t Stcc4::getNumberOfDataPoints() const {
-    return 3;
+    return NUMBER_OF_DATA_POINTS;
 }
 
 unsigned long Stcc4::getMinimumMeasurementIntervalMs() const {
@@ -9,11 +9,14 @@ namespace sensirion::upt::i2c_autodetect{
 
 class Stcc4 : public ISensor {
   public:
+    static constexpr size_t NUMBER_OF_DATA_POINTS = 3;
+
     explicit Stcc4(TwoWire& wire, uint16_t address);
     uint16_t start() override;
     uint16_t measureAndWrite(MeasurementList& measurements,
                              const unsigned long timeStamp) override;
     uint16_t initializationStep() override;
+    uint16_t resumeInitialization(unsigned long& nextStepInMs) override;
     DeviceType getDeviceType() const override;
     core::MetaData getMetaData() const override;
     size_t getNumberOfDataPoints() const override;
@@ -25,6 +28,7 @@ class Stcc4 : public ISensor {
     uint16_t _address;
     SensirionI2cStcc4 _driver;
     core::MetaData mMetadata;
+    uint8_t _initializationStep = 0;
 };
 } // namespace sensirion::upt::i2c_autodetect 
 
@@ -79,7 +79,7 @@ core::MetaData Svm4x::getMetaData() const {
 }
 
 size_t Svm4x::getNumberOfDataPoints() const {
-    return 4;
+    return NUMBER_OF_DATA_POINTS;
 }
 
 unsigned long Svm4x::getMinimumMeasurementIntervalMs() const {
@@ -0,0 +1,88 @@
+#ifndef SHARED_SENSOR_FRAME_H
+#define SHARED_SENSOR_FRAME_H
+
+#include "AtomicWords.h"
+#include "SensorFrame.h"
+#include <atomic>
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect{
+
+/* SensorFrame shared between the task attending the sensors and reader tasks
+ * (eg. on the other core). The frame is double-buffered and protected by a
+ * sequence counter (seqlock): the writer fills a private frame, copies it into
+ * the buffer which is not published and then flips the buffers, without ever
+ * waiting for the readers. Readers copy the published buffer and retry if the
+ * writer reused it in the meantime, which requires two publications during a
+ * single copy. The buffers are copied word by word with relaxed atomic
+ * accesses, such that a torn copy is discarded without a data race.
+ *
+ * @note Supports one writer and any number of readers
+ *
+ * @tparam MAX_SENSORS, MAX_SIGNALS see SensorFrame */
+template <size_t MAX_SENSORS,
+          size_t MAX_SIGNALS = MAX_SENSORS * ISensor::MAX_NUMBER_OF_DATA_POINTS>
+class SharedSensorFrame {
+  public:
+    using FrameT = SensorFrame<MAX_SENSORS, MAX_SIGNALS>;
+
+    /**
+     * @brief get the buffer to fill with the next publication
+     *
+     * @note Writer side, must be followed by endWrite()
+     */
+    FrameT& beginWrite() {
+        return mWriteFrame;
+    }
+
+    /**
+     * @brief publish the frame obtained with beginWrite()
+     */
+    void endWrite() {
+        const uint32_t sequence = mSequence.load(std::memory_order_relaxed);
+        // Odd sequence: publication in progress
+        mSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        mBuffers[(sequence / 2 + 1) % 2].store(mWriteFrame);
+        mSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief copy the last published frame
+     *
+     * @note Reader side, never blocks the writer
+     *
+     * @returns The number of publications so far, which changes whenever a
+     * new frame was published
+     */
+    uint32_t read(FrameT& frame) const {
+        while (true) {
+            const uint32_t before = mSequence.load(std::memory_order_acquire);
+            // During a publication, the previous buffer is still valid
+            const uint32_t published = before / 2;
+            mBuffers[published % 2].load(frame);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint32_t after = mSequence.load(std::memory_order_relaxed);
+            // The buffer is only written again by the publication after next
+            if (after - published * 2 <= 2) {
+                return published;
+            }
+        }
+    }
+
+    /**
+     * @brief getter method for the number of publications so far
+     */
+    uint32_t getNumberOfPublications() const {
+        return mSequence.load(std::memory_order_acquire) / 2;
+    }
+
+  private:
+    // Written by the writer task only
+    FrameT mWriteFrame;
+    AtomicWords<FrameT> mBuffers[2];
+    std::atomic<uint32_t> mSequence{0};
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* SHARED_SENSOR_FRAME_H */
@@ -0,0 +1,387 @@
+#include "TextEncoder.h"
+#include <cmath>
+#include <cstring>
+
+namespace sensirion::upt::i2c_autodetect{
+
+namespace {
+
+constexpr const char* CSV_HEADER =
+    "bus,address,device,device_id,quantity,unit,timestamp_ms,value\n";
+constexpr const char* JSON_TRAILER = "]\n";
+constexpr uint8_t MAX_DECIMALS = 9;
+
+struct SignalLabel {
+    const char* quantity = "";
+    size_t quantityLength = 0;
+    const char* unit = "";
+    size_t unitLength = 0;
+};
+
+SignalLabel makeSignalLabel(const core::SignalType signalType) {
+    SignalLabel label;
+    const char* quantity = core::quantityOf(signalType);
+    const char* unit = core::unitOf(signalType);
+    if (quantity) {
+        label.quantity = quantity;
+        label.quantityLength = strlen(quantity);
+    }
+    if (unit) {
+        label.unit = unit;
+        label.unitLength = strlen(unit);
+    }
+    return label;
+}
+
+/**
+ * @brief look up the labels of a SignalType in a table, which is filled on
+ * first use
+ *
+ * @note SignalType::UNDEFINED is the last SignalType
+ */
+SignalLabel signalLabel(const core::SignalType signalType) {
+    static constexpr size_t NUMBER_OF_SIGNAL_TYPES =
+        static_cast<size_t>(core::SignalType::UNDEFINED) + 1;
+    struct Table {
+        SignalLabel labels[NUMBER_OF_SIGNAL_TYPES];
+        Table() {
+            for (size_t i = 0; i < NUMBER_OF_SIGNAL_TYPES; ++i) {
+                labels[i] =
+                    makeSignalLabel(static_cast<core::SignalType>(i));
+            }
+        }
+    };
+    static const Table table;
+
+    const size_t index = static_cast<size_t>(signalType);
+    if (index >= NUMBER_OF_SIGNAL_TYPES) {
+        return makeSignalLabel(signalType);
+    }
+    return table.labels[index];
+}
+
+} // namespace
+
+TextEncoder::TextEncoder(const TextFormat format, char* buffer,
+                         const size_t capacity, const uint8_t decimals)
+    : mFormat(format), mBuffer(buffer), mCapacity(buffer ? capacity : 0),
+      mDecimals(decimals < MAX_DECIMALS ? decimals : MAX_DECIMALS) {
+    if (mCapacity > 0) {
+        mBuffer[0] = '\0';
+    }
+    _begin();
+}
+
+TextEncoder::TextEncoder(const TextFormat format, Print& print,
+                         const uint8_t decimals)
+    : mFormat(format), mPrint(&print),
+      mDecimals(decimals < MAX_DECIMALS ? decimals : MAX_DECIMALS) {
+    _begin();
+}
+
+void TextEncoder::_begin() {
+    mLineSize = 0;
+    mLineOverflow = false;
+    if (mFormat == TextFormat::CSV) {
+        _put(CSV_HEADER);
+    } else if (mFormat == TextFormat::JSON) {
+        _put('[');
+    }
+    if (mLineSize > 0 && !_commitLine(_trailerSize())) {
+        // Not even the header fits, keep the buffer empty
+        mFinished = true;
+    }
+}
+
+bool TextEncoder::append(const SensorKey& key,
+                         const ISensor::MeasurementList& measurements) {
+    bool complete = true;
+    for (const auto& measurement : measurements) {
+        complete = append(key, measurement) && complete;
+    }
+    return complete;
+}
+
+bool TextEncoder::append(const SensorKey& key,
+                         const core::Measurement& measurement) {
+    if (mFinished) {
+        mNumberOfDroppedSignals++;
+        return false;
+    }
+    mLineSize = 0;
+    mLineOverflow = false;
+    if (!_formatSignal(key, measurement) || !_commitLine(_trailerSize())) {
+        mNumberOfDroppedSignals++;
+        return false;
+    }
+    mNumberOfSignals++;
+    return true;
+}
+
+size_t TextEncoder::finish() {
+    if (mFinished) {
+        return mSize;
+    }
+    mFinished = true;
+    if (mFormat == TextFormat::JSON) {
+        mLineSize = 0;
+        mLineOverflow = false;
+        _put(JSON_TRAILER);
+        // The space of the trailer was reserved by all previous lines
+        _commitLine(0);
+    }
+    return mSize;
+}
+
+bool TextEncoder::_formatSignal(const SensorKey& key,
+                                const core::Measurement& measurement) {
+    const SignalLabel label = signalLabel(measurement.signalType);
+    const char* device = core::deviceLabel(measurement.metaData.deviceType);
+    const size_t deviceLength = device ? strlen(device) : 0;
+    const uint64_t timeStamp =
+        static_cast<uint64_t>(measurement.dataPoint.t_offset) + mTimeOffsetMs;
+    const float value = measurement.dataPoint.value;
+
+    switch (mFormat) {
+        case TextFormat::CSV:
+            _putUnsigned(key.busId);
+            _put(',');
+            _putUnsigned(key.i2cAddress);
+            _put(',');
+            _putEscaped(device, deviceLength);
+            _put(',');
+            _putUnsigned(measurement.metaData.deviceID);
+            _put(',');
+            _putEscaped(label.quantity, label.quantityLength);
+            _put(',');
+            _putEscaped(label.unit, label.unitLength);
+            _put(',');
+            _putUnsigned(timeStamp);
+            _put(',');
+            if (!_putFloat(value)) {
+                _put("nan");
+            }
+            _put('\n');
+            return true;
+
+        case TextFormat::JSON:
+            if (mNumberOfSignals > 0) {
+                _put(',');
+            }
+            _put("{\"bus\":");
+            _putUnsigned(key.busId);
+            _put(",\"address\":");
+            _putUnsigned(key.i2cAddress);
+            _put(",\"device\":\"");
+            _putEscaped(device, deviceLength);
+            _put("\",\"device_id\":");
+            _putUnsigned(measurement.metaData.deviceID);
+            _put(",\"quantity\":\"");
+            _putEscaped(label.quantity, label.quantityLength);
+            _put("\",\"unit\":\"");
+            _putEscaped(label.unit, label.unitLength);
+            _put("\",\"timestamp_ms\":");
+            _putUnsigned(timeStamp);
+            _put(",\"value\":");
+            if (!_putFloat(value)) {
+                _put("null");
+            }
+            _put('}');
+            return true;
+
+        case TextFormat::LINE_PROTOCOL:
+            _putMeasurementName(label.quantity, label.quantityLength);
+            _put(",device=");
+            _putEscaped(device, deviceLength);
+            _put(",device_id=");
+            _putUnsigned(measurement.metaData.deviceID);
+            _put(",bus=");
+            _putUnsigned(key.busId);
+            _put(",address=");
+            _putUnsigned(key.i2cAddress);
+            if (label.unitLength > 0) {
+                _put(",unit=");
+                _putEscaped(label.unit, label.unitLength);
+            }
+            _put(" value=");
+            // The line protocol has no representation of non-finite values
+            if (!_putFloat(value)) {
+                return false;
+            }
+            _put(' ');
+            _putUnsigned(timeStamp);
+            _put('\n');
+            return true;
+    }
+    return false;
+}
+
+bool TextEncoder::_commitLine(const size_t reserve) {
+    if (mLineOverflow) {
+        return false;
+    }
+    if (mPrint) {
+        mPrint->write(reinterpret_cast<const uint8_t*>(mLine), mLineSize);
+        mSize += mLineSize;
+        return true;
+    }
+    // Line, reserve and null terminator
+    if (mSize + mLineSize + reserve + 1 > mCapacity) {
+        return false;
+    }
+    memcpy(mBuffer + mSize, mLine, mLineSize);
+    mSize += mLineSize;
+    mBuffer[mSize] = '\0';
+    return true;
+}
+
+size_t TextEncoder::_trailerSize() const {
+    return mFormat == TextFormat::JSON ? strlen(JSON_TRAILER) : 0;
+}
+
+void TextEncoder::_put(const char c) {
+    if (mLineSize >= LINE_CAPACITY) {
+        mLineOverflow = true;
+        return;
+    }
+    mLine[mLineSize++] = c;
+}
+
+void TextEncoder::_put(const char* text, const size_t length) {
+    if (mLineSize + length > LINE_CAPACITY) {
+        mLineOverflow = true;
+        return;
+    }
+    memcpy(mLine + mLineSize, text, length);
+    mLineSize += length;
+}
+
+void TextEncoder::_put(const char* text) {
+    _put(text, strlen(text));
+}
+
+void TextEncoder::_putEscaped(const char* text, const size_t length) {
+    switch (mFormat) {
+        case TextFormat::CSV:
+            if (!memchr(text, ',', length) && !memchr(text, '"', length) &&
+                !memchr(text, '\n', length)) {
+                _put(text, length);
+                return;
+            }
+            _put('"');
+            for (size_t i = 0; i < length; ++i) {
+                if (text[i] == '"') {
+                    _put('"');
+                }
+                _put(text[i]);
+            }
+            _put('"');
+            return;
+
+        case TextFormat::JSON:
+            for (size_t i = 0; i < length; ++i) {
+                const char c = text[i];
+                if (c == '"' || c == '\\') {
+                    _put('\\');
+                    _put(c);
+                } else if (static_cast<uint8_t>(c) >= 0x20) {
+                    _put(c);
+                }
+            }
+            return;
+
+        case TextFormat::LINE_PROTOCOL:
+            for (size_t i = 0; i < length; ++i) {
+                const char c = text[i];
+                if (c == ',' || c == '=' || c == ' ') {
+                    _put('\\');
+                }
+                if (c != '\n') {
+                    _put(c);
+                }
+            }
+            return;
+    }
+}
+
+void TextEncoder::_putMeasurementName(const char* text, const size_t length) {
+    // Unlike tag keys, tag values and field keys, measurement names keep
+    // their equal signs unescaped
+    for (size_t i = 0; i < length; ++i) {
+        const char c = text[i];
+        if (c == ',' || c == ' ') {
+            _put('\\');
+        }
+        if (c != '\n') {
+            _put(c);
+        }
+    }
+}
+
+void TextEncoder::_putUnsigned(uint64_t value) {
+    char digits[20];
+    size_t numberOfDigits = 0;
+    do {
+        digits[numberOfDigits++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (numberOfDigits > 0) {
+        _put(digits[--numberOfDigits]);
+    }
+}
+
+bool TextEncoder::_putFloat(const float value) {
+    static constexpr uint32_t POWERS_OF_TEN[MAX_DECIMALS + 1] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+        1000000000};
+    // Largest magnitude that is rounded in 64 bit fixed point
+    static constexpr double MAX_FIXED_POINT = 9.0e18;
+
+    if (!std::isfinite(value)) {
+        return false;
+    }
+    const uint32_t scale = POWERS_OF_TEN[mDecimals];
+    const double scaled = std::fabs(static_cast<double>(value)) * scale + 0.5;
+    if (scaled < MAX_FIXED_POINT) {
+        const uint64_t fixedPoint = static_cast<uint64_t>(scaled);
+        if (value < 0 && fixedPoint > 0) {
+            _put('-');
+        }
+        _putFixedPoint(fixedPoint, scale);
+        return true;
+    }
+    // Larger magnitudes are written in exponent notation, eg. 1.23e+20, with
+    // the decimals applied to the mantissa. They are at least 9e9, such that
+    // the exponent is always positive.
+    double mantissa = std::fabs(static_cast<double>(value));
+    uint32_t exponent = static_cast<uint32_t>(std::floor(std::log10(mantissa)));
+    mantissa /= std::pow(10.0, exponent);
+    uint64_t fixedPoint = static_cast<uint64_t>(mantissa * scale + 0.5);
+    if (fixedPoint >= 10ull * scale) {
+        // The mantissa was rounded up to 10
+        fixedPoint = scale;
+        ++exponent;
+    }
+    if (value < 0) {
+        _put('-');
+    }
+    _putFixedPoint(fixedPoint, scale);
+    _put("e+");
+    _putUnsigned(exponent);
+    return true;
+}
+
+void TextEncoder::_putFixedPoint(const uint64_t fixedPoint,
+                                 const uint32_t scale) {
+    _putUnsigned(fixedPoint / scale);
+    if (scale == 1) {
+        return;
+    }
+    _put('.');
+    uint64_t fraction = fixedPoint % scale;
+    for (uint32_t digit = scale / 10; digit > 0; digit /= 10) {
+        _put(static_cast<char>('0' + fraction / digit));
+        fraction %= digit;
+    }
+}
+} // namespace sensirion::upt::i2c_autodetect
@@ -0,0 +1,162 @@
+#ifndef TEXT_ENCODER_H
+#define TEXT_ENCODER_H
+
+#include "ISensor.h"
+#include "SensorKey.h"
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace sensirion::upt::i2c_autodetect{
+
+enum class TextFormat {
+    // Header line, then one line per signal:
+    // bus,address,device,device_id,quantity,unit,timestamp_ms,value
+    CSV,
+    // Array of one flat object per signal:
+    // [{"bus":0,"address":68,"device":"SHT4x","device_id":1,
+    //   "quantity":"Temperature","unit":"degC","timestamp_ms":10,"value":21.5}]
+    JSON,
+    // InfluxDB line protocol, one line per signal with millisecond precision:
+    // <quantity>,device=SHT4x,device_id=1,bus=0,address=68,unit=degC
+    //     value=21.5 10
+    LINE_PROTOCOL
+};
+
+/* Encoder of sensor readings into text, written either into a buffer
+ * provided by the caller or to a Print sink (eg. Serial), without allocating
+ * and without printf. The quantity and unit labels of the signals are looked
+ * up once and kept in a table.
+ *
+ * Each signal is formatted into a line buffer first, such that a buffer
+ * never holds a partial signal: signals which do not fit are left out. */
+class TextEncoder {
+  public:
+    static constexpr size_t DEFAULT_DECIMALS = 2;
+
+    /**
+     * @brief constructor writing into a buffer, which is always kept null
+     * terminated
+     *
+     * @param[in] format text format to write
+     *
+     * @param[in] buffer memory into which the text is written
+     *
+     * @param[in] capacity size of buffer in bytes, including the null
+     * terminator
+     *
+     * @param[in] decimals number of decimals of the values
+     */
+    TextEncoder(TextFormat format, char* buffer, size_t capacity,
+                uint8_t decimals = DEFAULT_DECIMALS);
+
+    /**
+     * @brief constructor writing to a Print sink
+     */
+    TextEncoder(TextFormat format, Print& print,
+                uint8_t decimals = DEFAULT_DECIMALS);
+
+    /**
+     * @brief set the time added to the time stamps of the readings, which
+     * are milliseconds passed since program startup. Eg. the unix time in
+     * milliseconds at startup, as required by the line protocol.
+     */
+    void setTimeOffsetMs(uint64_t offsetMs) {
+        mTimeOffsetMs = offsetMs;
+    }
+
+    /**
+     * @brief append the readings of a sensor
+     *
+     * @note Same signature as SensorFrame::append(), such that the encoder
+     * can be passed to SensorManager::appendToSensorFrame()
+     *
+     * @returns False if a signal was left out
+     */
+    bool append(const SensorKey& key,
+                const ISensor::MeasurementList& measurements);
+
+    /**
+     * @brief append a single signal, eg. from SensorHistory::drain()
+     *
+     * @returns False if the signal was left out
+     */
+    bool append(const SensorKey& key, const core::Measurement& measurement);
+
+    /**
+     * @brief terminate the text (closes the JSON array)
+     *
+     * @note No signal can be appended after the text is terminated
+     *
+     * @returns The number of characters written, without null terminator
+     */
+    size_t finish();
+
+    /**
+     * @brief getter method for the number of signals which were left out,
+     * because they did not fit into the buffer or their value cannot be
+     * represented (non-finite values in the line protocol)
+     */
+    size_t getNumberOfDroppedSignals() const {
+        return mNumberOfDroppedSignals;
+    }
+
+  private:
+    // Longest line of a single signal
+    static constexpr size_t LINE_CAPACITY = 192;
+
+    TextFormat mFormat;
+    char* mBuffer = nullptr;
+    size_t mCapacity = 0;
+    Print* mPrint = nullptr;
+    uint8_t mDecimals;
+    uint64_t mTimeOffsetMs = 0;
+
+    size_t mSize = 0;
+    size_t mNumberOfSignals = 0;
+    size_t mNumberOfDroppedSignals = 0;
+    bool mFinished = false;
+
+    char mLine[LINE_CAPACITY];
+    size_t mLineSize = 0;
+    bool mLineOverflow = false;
+
+    /**
+     * @brief write the header of the format
+     */
+    void _begin();
+
+    /**
+     * @brief format a signal into the line buffer
+     *
+     * @returns False if the signal cannot be represented in the format
+     */
+    bool _formatSignal(const SensorKey& key,
+                       const core::Measurement& measurement);
+
+    /**
+     * @brief write the line buffer to the buffer or Print sink
+     *
+     * @param[in] reserve number of bytes to keep free in the buffer for
+     * the end of the text
+     */
+    bool _commitLine(size_t reserve);
+
+    /**
+     * @brief number of bytes finish() writes into the buffer
+     */
+    size_t _trailerSize() const;
+
+    // Line buffer primitives
+    void _put(char c);
+    void _put(const char* text, size_t length);
+    void _put(const char* text);
+    void _putEscaped(const char* text, size_t length);
+    void _putMeasurementName(const char* text, size_t length);
+    void _putUnsigned(uint64_t value);
+    bool _putFloat(float value);
+    void _putFixedPoint(uint64_t fixedPoint, uint32_t scale);
+};
+} // namespace sensirion::upt::i2c_autodetect
+
+#endif /* TEXT_ENCODER_H */
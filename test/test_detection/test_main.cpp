@@ -0,0 +1,283 @@
+/*
+ * Detection of the sensors on the simulated bus: single sweep over the
+ * candidate addresses, skipped probes of handled addresses, rate limited
+ * rescans and several sensors of the same type.
+ */
+#include "Sensirion_upt_i2c_auto_detection.h"
+#include "DefaultDriverConfig.h"
+#include "SensorModels.h"
+#include <set>
+#include <unity.h>
+
+using namespace sensirion::upt::i2c_autodetect;
+namespace core = sensirion::upt::core;
+
+namespace {
+
+size_t numberOfDistinctCandidateAddresses() {
+    const auto& addresses = DefaultI2cDetector::CANDIDATE_ADDRESSES;
+    return std::set<uint8_t>(addresses.begin(), addresses.end()).size();
+}
+
+void communicateFor(SensorManager& manager, const uint64_t durationUs) {
+    const uint64_t untilUs = host::nowMicros() + durationUs;
+    while (host::nowMicros() < untilUs) {
+        host::advanceMicros(manager.nextWakeupMs() * 1000ull + 1000);
+        manager.executeSensorCommunication();
+    }
+}
+
+size_t countReadings(SensorManager& manager) {
+    const SensorManager::MeasurementList*
+        readings[DefaultI2cDetector::CONFIGURED_SENSORS];
+    manager.getSensorReadings(readings);
+    size_t count = 0;
+    for (const auto* measurements : readings) {
+        count += measurements ? 1 : 0;
+    }
+    return count;
+}
+
+}  // namespace
+
+void setUp() {
+    host::resetClock();
+    Wire.resetStatistics();
+}
+
+void tearDown() {
+    for (uint8_t address = 0; address < 128; ++address) {
+        Wire.detachDevice(address);
+    }
+}
+
+void test_single_sweep_probes_each_address_once() {
+    DefaultI2cDetector detector(Wire);
+    SensorList sensorList;
+    detector.findSensors(sensorList);
+
+    TEST_ASSERT_EQUAL(0, sensorList.count());
+    TEST_ASSERT_EQUAL(numberOfDistinctCandidateAddresses(),
+                      Wire.getStatistics().transactions);
+    TEST_ASSERT_EQUAL(Wire.getStatistics().transactions,
+                      Wire.getStatistics().nacks);
+    TEST_ASSERT_EQUAL(0, detector.getSkippedProbesCount());
+}
+
+void test_detects_sensor_at_alternative_address() {
+    host::Sht4xModel sht4x(0x46);
+    Wire.attachDevice(sht4x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    communicateFor(manager, 2000000);
+
+    TEST_ASSERT_EQUAL(1, countReadings(manager));
+    SensirionI2cSht4x* driver = nullptr;
+    TEST_ASSERT_EQUAL(NO_ERROR,
+                      manager.getSensorDriver(driver, SensorKey{0, 0x46}));
+
+    // Reconnected at another address, the sensor keeps its driver instance
+    Wire.detachDevice(0x46);
+    communicateFor(manager, 2000000);
+    manager.refreshConnectedSensors();
+    TEST_ASSERT_EQUAL(0, countReadings(manager));
+    host::Sht4xModel sht4xAtOtherAddress(0x45);
+    Wire.attachDevice(sht4xAtOtherAddress);
+    manager.refreshConnectedSensors();
+    communicateFor(manager, 2000000);
+    TEST_ASSERT_EQUAL(1, countReadings(manager));
+    SensirionI2cSht4x* reboundDriver = nullptr;
+    TEST_ASSERT_EQUAL(NO_ERROR, manager.getSensorDriver(reboundDriver,
+                                                        SensorKey{0, 0x45}));
+    TEST_ASSERT_EQUAL_PTR(driver, reboundDriver);
+}
+
+void test_handled_sensors_are_not_probed_again() {
+    host::Sht4xModel sht4x;
+    host::Scd4xModel scd4x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(scd4x);
+    DefaultI2cDetector detector(Wire);
+    SensorList sensorList;
+    detector.findSensors(sensorList);
+    TEST_ASSERT_EQUAL(2, sensorList.count());
+
+    Wire.resetStatistics();
+    detector.findSensors(sensorList);
+
+    // All candidate addresses of the SHT4x and the address of the SCD4x
+    const size_t skipped = Sht4xMapping::I2C_ADDRESSES.size() + 1;
+    TEST_ASSERT_EQUAL(skipped, detector.getSkippedProbesCount());
+    TEST_ASSERT_EQUAL(numberOfDistinctCandidateAddresses() - skipped,
+                      Wire.getStatistics().transactions);
+    TEST_ASSERT_EQUAL(2, sensorList.count());
+}
+
+void test_rescan_interval_limits_probes() {
+    DefaultI2cDetector detector(Wire);
+    detector.setRescanInterval(10000);
+    SensorList sensorList;
+    detector.findSensors(sensorList);
+
+    // Hot-plugged sensors are not seen before the rescan is due
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+    host::advanceMicros(5000000);
+    Wire.resetStatistics();
+    detector.findSensors(sensorList);
+    TEST_ASSERT_EQUAL(0, Wire.getStatistics().transactions);
+    TEST_ASSERT_EQUAL(DefaultI2cDetector::CANDIDATE_ADDRESSES.size(),
+                      detector.getSkippedProbesCount());
+    TEST_ASSERT_EQUAL(0, sensorList.count());
+
+    host::advanceMicros(5000000);
+    detector.findSensors(sensorList);
+    TEST_ASSERT_EQUAL(1, sensorList.count());
+}
+
+void test_lost_sensor_is_found_again() {
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    communicateFor(manager, 2000000);
+    TEST_ASSERT_EQUAL(1, countReadings(manager));
+
+    Wire.detachDevice(0x44);
+    communicateFor(manager, 2000000);
+    manager.refreshConnectedSensors();
+    TEST_ASSERT_EQUAL(0, countReadings(manager));
+
+    Wire.attachDevice(sht4x);
+    manager.refreshConnectedSensors();
+    communicateFor(manager, 2000000);
+    TEST_ASSERT_EQUAL(1, countReadings(manager));
+}
+
+void test_two_sensors_of_the_same_type() {
+    using TwoSht4xDetector =
+        I2CAutoDetector<SensorToAddressMapping<0x44, Sht4x>,
+                        SensorToAddressMapping<0x45, Sht4x>>;
+    host::Sht4xModel first(0x44, 0x11111111);
+    host::Sht4xModel second(0x45, 0x22222222);
+    Wire.attachDevice(first);
+    Wire.attachDevice(second);
+    TwoSht4xDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+    manager.setInterval(5000, SensorKey{0, 0x44});
+    manager.setInterval(1000, SensorKey{0, 0x45});
+
+    // Each has its own measurement interval
+    const SensorManager::MeasurementList* readings[2];
+    unsigned long timeStampsMs[2] = {0, 0};
+    uint32_t readouts[2] = {0, 0};
+    while (host::nowMicros() < 10000000) {
+        communicateFor(manager, 1);
+        manager.getSensorReadings(readings);
+        for (size_t i = 0; i < 2; ++i) {
+            if (!readings[i]) {
+                continue;
+            }
+            const core::Measurement& measurement = (*readings[i])[0];
+            const size_t sensor =
+                measurement.metaData.deviceID == 0x11111111 ? 0 : 1;
+            readouts[sensor] +=
+                measurement.dataPoint.t_offset != timeStampsMs[sensor] ? 1 : 0;
+            timeStampsMs[sensor] = measurement.dataPoint.t_offset;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, readouts[0]);
+    TEST_ASSERT_LESS_OR_EQUAL(3, readouts[0]);
+    TEST_ASSERT_GREATER_OR_EQUAL(9, readouts[1]);
+
+    // Both are read, and tell their serial numbers apart
+    TEST_ASSERT_NOT_NULL(readings[0]);
+    TEST_ASSERT_NOT_NULL(readings[1]);
+    uint64_t deviceIds[2] = {(*readings[0])[0].metaData.deviceID,
+                             (*readings[1])[0].metaData.deviceID};
+    TEST_ASSERT_EQUAL_UINT64(0x11111111 + 0x22222222,
+                             deviceIds[0] + deviceIds[1]);
+    TEST_ASSERT_NOT_EQUAL(deviceIds[0], deviceIds[1]);
+
+    // Each instance is addressed by its key
+    SensirionI2cSht4x* firstDriver = nullptr;
+    SensirionI2cSht4x* secondDriver = nullptr;
+    TEST_ASSERT_EQUAL(NO_ERROR, manager.getSensorDriver(
+                                    firstDriver, SensorKey{0, 0x44}));
+    TEST_ASSERT_EQUAL(NO_ERROR, manager.getSensorDriver(
+                                    secondDriver, SensorKey{0, 0x45}));
+    TEST_ASSERT_TRUE(firstDriver != secondDriver);
+    TEST_ASSERT_EQUAL(DRIVER_NOT_FOUND_ERROR,
+                      manager.getSensorDriver(
+                          firstDriver, SensorKey{0, 0x45, 0x11111111}));
+}
+
+void test_sensor_list_without_reserve() {
+    host::Sht4xModel sht4x;
+    Sht4x sensor(Wire, 0x44);
+    SensorList sensorList;
+
+    TEST_ASSERT_TRUE(sensorList.addSensor(&sensor, SensorKey{0, 0x44}));
+    TEST_ASSERT_EQUAL(SensorList::DEFAULT_CAPACITY, sensorList.capacity());
+    TEST_ASSERT_TRUE(sensorList.containsSensor(&sensor));
+    // Neither the instance nor its address are added twice
+    TEST_ASSERT_FALSE(sensorList.addSensor(&sensor, SensorKey{0, 0x45}));
+    Sht4x other(Wire, 0x44);
+    TEST_ASSERT_FALSE(sensorList.addSensor(&other, SensorKey{0, 0x44}));
+    TEST_ASSERT_FALSE(sensorList.containsSensor(&other));
+    TEST_ASSERT_EQUAL(1, sensorList.count());
+}
+
+void test_sensor_list_same_address_on_two_buses() {
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+    Sht4x sensorBus0(Wire, 0x44);
+    Sht4x sensorBus1(Wire1, 0x44);
+    SensorList sensorList;
+
+    TEST_ASSERT_TRUE(sensorList.addSensor(&sensorBus0, SensorKey{0, 0x44}));
+    TEST_ASSERT_TRUE(sensorList.addSensor(&sensorBus1, SensorKey{1, 0x44}));
+    Sht4x other(Wire1, 0x44);
+    TEST_ASSERT_FALSE(sensorList.addSensor(&other, SensorKey{1, 0x44}));
+    TEST_ASSERT_EQUAL_PTR(
+        &sensorBus0,
+        sensorList.findSensorStateMachine(SensorKey{0, 0x44})->getSensor());
+    TEST_ASSERT_EQUAL_PTR(
+        &sensorBus1,
+        sensorList.findSensorStateMachine(SensorKey{1, 0x44})->getSensor());
+    TEST_ASSERT_NULL(sensorList.findSensorStateMachine(SensorKey{2, 0x44}));
+
+    // Nothing answers on the second bus, such that its sensor is lost
+    SensorStateMachine* ssmBus1 =
+        sensorList.findSensorStateMachine(SensorKey{1, 0x44});
+    for (int i = 0; i < 100 && ssmBus1->getSensorState() != SensorStatus::LOST;
+         ++i) {
+        ssmBus1->update();
+        delay(1000);
+    }
+    TEST_ASSERT_EQUAL(SensorStatus::LOST, ssmBus1->getSensorState());
+    sensorList.removeLostSensors();
+    TEST_ASSERT_EQUAL(1, sensorList.count());
+    TEST_ASSERT_NULL(sensorList.findSensorStateMachine(SensorKey{1, 0x44}));
+    TEST_ASSERT_EQUAL_PTR(
+        &sensorBus0,
+        sensorList.findSensorStateMachine(SensorKey{0, 0x44})->getSensor());
+    TEST_ASSERT_TRUE(sensorList.addSensor(&other, SensorKey{1, 0x44}));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_sweep_probes_each_address_once);
+    RUN_TEST(test_detects_sensor_at_alternative_address);
+    RUN_TEST(test_handled_sensors_are_not_probed_again);
+    RUN_TEST(test_rescan_interval_limits_probes);
+    RUN_TEST(test_lost_sensor_is_found_again);
+    RUN_TEST(test_two_sensors_of_the_same_type);
+    RUN_TEST(test_sensor_list_without_reserve);
+    RUN_TEST(test_sensor_list_same_address_on_two_buses);
+    return UNITY_END();
+}
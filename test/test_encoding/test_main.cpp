@@ -0,0 +1,410 @@
+/*
+ * Encoding of the sensor readings: round trips of the binary batches through
+ * MeasurementDecoder, and of the text formats through a minimal parser.
+ */
+#include "Sensirion_upt_i2c_auto_detection.h"
+#include "DefaultDriverConfig.h"
+#include "MeasurementDecoder.h"
+#include "SensorModels.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+using namespace sensirion::upt::i2c_autodetect;
+namespace core = sensirion::upt::core;
+
+namespace {
+
+constexpr size_t MAX_SENSORS = DefaultI2cDetector::CONFIGURED_SENSORS;
+using MeasurementList = SensorManager::MeasurementList;
+
+// A signal as seen by the receiving side of an encoding
+struct Signal {
+    uint8_t busId;
+    uint8_t i2cAddress;
+    uint64_t deviceID;
+    core::SignalType signalType;
+    uint64_t timeStampMs;
+    float value;
+};
+
+void communicateFor(SensorManager& manager, const uint64_t durationUs) {
+    const uint64_t untilUs = host::nowMicros() + durationUs;
+    while (host::nowMicros() < untilUs) {
+        host::advanceMicros(manager.nextWakeupMs() * 1000ull + 1000);
+        manager.executeSensorCommunication();
+    }
+}
+
+// Detect the attached sensors and let all of them deliver readings
+void setUpSensors(SensorManager& manager) {
+    manager.refreshConnectedSensors();
+    communicateFor(manager, 12000000);
+}
+
+// The signals in the order in which the encoders write them
+std::vector<Signal> expectedSignals(SensorManager& manager) {
+    SensorFrame<MAX_SENSORS> frame;
+    manager.getSensorFrame(frame);
+    std::vector<Signal> signals;
+    for (size_t i = 0; i < frame.getNumberOfSignals(); ++i) {
+        const size_t sensorIndex = frame.getSensorIndices()[i];
+        const SensorKey& key = frame.getKey(sensorIndex);
+        signals.push_back({key.busId, key.i2cAddress,
+                           frame.getMetaData(sensorIndex).deviceID,
+                           frame.getSignalTypes()[i],
+                           frame.getTimeStamps()[i], frame.getValues()[i]});
+    }
+    return signals;
+}
+
+std::vector<Signal> decode(const uint8_t* data, const size_t size,
+                           bool& complete) {
+    std::vector<Signal> signals;
+    complete = host::MeasurementDecoder::decode(
+        data, size,
+        [&](const host::DecodedSensor& sensor,
+            const core::SignalType signalType,
+            const core::DataPoint& dataPoint) {
+            signals.push_back({sensor.key.busId, sensor.key.i2cAddress,
+                               sensor.key.deviceID, signalType,
+                               dataPoint.t_offset, dataPoint.value});
+        });
+    return signals;
+}
+
+void assertSignalsEqual(const std::vector<Signal>& expected,
+                        const std::vector<Signal>& actual,
+                        const float tolerance) {
+    TEST_ASSERT_EQUAL(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        TEST_ASSERT_EQUAL(expected[i].busId, actual[i].busId);
+        TEST_ASSERT_EQUAL(expected[i].i2cAddress, actual[i].i2cAddress);
+        TEST_ASSERT_EQUAL_UINT64(expected[i].deviceID, actual[i].deviceID);
+        TEST_ASSERT_TRUE(expected[i].signalType == actual[i].signalType);
+        TEST_ASSERT_EQUAL_UINT64(expected[i].timeStampMs,
+                                 actual[i].timeStampMs);
+        TEST_ASSERT_FLOAT_WITHIN(tolerance, expected[i].value,
+                                 actual[i].value);
+    }
+}
+
+// Lines of a text, without the line breaks
+std::vector<std::string> splitLines(const char* text) {
+    std::vector<std::string> lines;
+    const char* begin = text;
+    while (*begin) {
+        const char* end = std::strchr(begin, '\n');
+        if (!end) {
+            end = begin + std::strlen(begin);
+        }
+        if (end > begin) {
+            lines.emplace_back(begin, end);
+        }
+        begin = *end ? end + 1 : end;
+    }
+    return lines;
+}
+
+// Quantity label of a signal, as written by the text encoders
+std::string quantity(const core::SignalType signalType) {
+    return core::quantityOf(signalType);
+}
+
+// Measurement name of a signal in the line protocol, which escapes spaces
+// and commas
+std::string measurementName(const core::SignalType signalType) {
+    std::string name;
+    for (const char c : quantity(signalType)) {
+        if (c == ' ' || c == ',') {
+            name += '\\';
+        }
+        name += c;
+    }
+    return name;
+}
+
+}  // namespace
+
+void setUp() {
+    host::resetClock();
+    Wire.resetStatistics();
+}
+
+void tearDown() {
+    for (uint8_t address = 0; address < 128; ++address) {
+        Wire.detachDevice(address);
+    }
+}
+
+void test_binary_batch_round_trip() {
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    host::Sgp41Model sgp41;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+    Wire.attachDevice(sgp41);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    setUpSensors(manager);
+
+    const std::vector<Signal> expected = expectedSignals(manager);
+    TEST_ASSERT_GREATER_THAN(4, expected.size());
+    uint8_t buffer[512];
+    const size_t size = manager.encodeSensorReadings(buffer, sizeof(buffer));
+    TEST_ASSERT_GREATER_THAN(0, size);
+
+    bool complete = false;
+    const std::vector<Signal> decoded = decode(buffer, size, complete);
+    TEST_ASSERT_TRUE(complete);
+    // The values are encoded as float32, hence exactly
+    assertSignalsEqual(expected, decoded, 0.0f);
+
+    // A truncated batch is detected, with the signals before the truncation
+    std::vector<Signal> partial = decode(buffer, size - 1, complete);
+    TEST_ASSERT_FALSE(complete);
+    TEST_ASSERT_LESS_OR_EQUAL(expected.size(), partial.size());
+}
+
+void test_binary_batch_leaves_out_sensors_which_do_not_fit() {
+    MeasurementList measurements;
+    for (int i = 0; i < 3; ++i) {
+        measurements.emplace_back(
+            core::MetaData(core::SHT4X()),
+            core::SignalType::TEMPERATURE_DEGREES_CELSIUS,
+            core::DataPoint{1000ul + i, 20.0f + i});
+    }
+    uint8_t buffer[48];
+    MeasurementEncoder encoder(buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(encoder.append(SensorKey{0, 0x44, 1}, measurements));
+    TEST_ASSERT_FALSE(encoder.append(SensorKey{0, 0x45, 2}, measurements));
+    TEST_ASSERT_EQUAL(1, encoder.getNumberOfSensors());
+    TEST_ASSERT_EQUAL(1, encoder.getNumberOfDroppedSensors());
+    const size_t size = encoder.finish();
+
+    bool complete = false;
+    const std::vector<Signal> decoded = decode(buffer, size, complete);
+    TEST_ASSERT_TRUE(complete);
+    TEST_ASSERT_EQUAL(3, decoded.size());
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        TEST_ASSERT_EQUAL(0x44, decoded[i].i2cAddress);
+        TEST_ASSERT_EQUAL_UINT64(1000 + i, decoded[i].timeStampMs);
+        TEST_ASSERT_EQUAL_FLOAT(20.0f + i, decoded[i].value);
+    }
+
+    // Not even an empty batch fits
+    uint8_t tiny[2];
+    MeasurementEncoder tinyEncoder(tiny, sizeof(tiny));
+    TEST_ASSERT_FALSE(tinyEncoder.append(SensorKey{0, 0x44}, measurements));
+    TEST_ASSERT_EQUAL(0, tinyEncoder.finish());
+}
+
+void test_csv_round_trip() {
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    setUpSensors(manager);
+
+    const std::vector<Signal> expected = expectedSignals(manager);
+    char text[2048];
+    TextEncoder encoder(TextFormat::CSV, text, sizeof(text), 3);
+    const size_t length = manager.encodeSensorReadings(encoder);
+    TEST_ASSERT_EQUAL(std::strlen(text), length);
+    TEST_ASSERT_EQUAL(0, encoder.getNumberOfDroppedSignals());
+
+    const std::vector<std::string> lines = splitLines(text);
+    TEST_ASSERT_EQUAL(expected.size() + 1, lines.size());
+    TEST_ASSERT_EQUAL_STRING(
+        "bus,address,device,device_id,quantity,unit,timestamp_ms,value",
+        lines[0].c_str());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        unsigned busId = 0;
+        unsigned i2cAddress = 0;
+        char device[32];
+        unsigned long long deviceID = 0;
+        char quantityLabel[64];
+        char unit[32];
+        unsigned long long timeStampMs = 0;
+        float value = 0.0f;
+        TEST_ASSERT_EQUAL(
+            8, std::sscanf(lines[i + 1].c_str(),
+                           "%u,%u,%31[^,],%llu,%63[^,],%31[^,],%llu,%f",
+                           &busId, &i2cAddress, device, &deviceID,
+                           quantityLabel, unit, &timeStampMs, &value));
+        TEST_ASSERT_EQUAL(expected[i].busId, busId);
+        TEST_ASSERT_EQUAL(expected[i].i2cAddress, i2cAddress);
+        TEST_ASSERT_EQUAL_UINT64(expected[i].deviceID, deviceID);
+        TEST_ASSERT_EQUAL_STRING(quantity(expected[i].signalType).c_str(),
+                                 quantityLabel);
+        TEST_ASSERT_EQUAL_UINT64(expected[i].timeStampMs, timeStampMs);
+        TEST_ASSERT_FLOAT_WITHIN(0.0005f, expected[i].value, value);
+    }
+}
+
+void test_line_protocol_round_trip() {
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    setUpSensors(manager);
+
+    const std::vector<Signal> expected = expectedSignals(manager);
+    const uint64_t offsetMs = 1700000000000ull;
+    char text[1024];
+    TextEncoder encoder(TextFormat::LINE_PROTOCOL, text, sizeof(text));
+    encoder.setTimeOffsetMs(offsetMs);
+    manager.encodeSensorReadings(encoder);
+
+    const std::vector<std::string> lines = splitLines(text);
+    TEST_ASSERT_EQUAL(expected.size(), lines.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const std::string& line = lines[i];
+        // <quantity>,<tags> value=<value> <timestamp>
+        const size_t tagsEnd = line.rfind(" value=");
+        const size_t fieldsEnd = line.rfind(' ');
+        TEST_ASSERT_TRUE(tagsEnd != std::string::npos);
+        TEST_ASSERT_TRUE(fieldsEnd > tagsEnd);
+        const std::string tags = line.substr(0, tagsEnd);
+        TEST_ASSERT_EQUAL(
+            0, tags.find(measurementName(expected[i].signalType) + ","));
+        char address[32];
+        std::snprintf(address, sizeof(address), ",address=%u",
+                      expected[i].i2cAddress);
+        TEST_ASSERT_TRUE(tags.find(address) != std::string::npos);
+
+        float value = 0.0f;
+        TEST_ASSERT_EQUAL(1, std::sscanf(line.c_str() + tagsEnd, " value=%f",
+                                         &value));
+        TEST_ASSERT_FLOAT_WITHIN(0.005f, expected[i].value, value);
+        TEST_ASSERT_EQUAL_UINT64(
+            offsetMs + expected[i].timeStampMs,
+            std::stoull(line.substr(fieldsEnd + 1)));
+    }
+}
+
+void test_json_round_trip() {
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    setUpSensors(manager);
+
+    const std::vector<Signal> expected = expectedSignals(manager);
+    char text[2048];
+    TextEncoder encoder(TextFormat::JSON, text, sizeof(text));
+    manager.encodeSensorReadings(encoder);
+
+    // Array of flat objects, one per signal
+    const char* cursor = text;
+    while (*cursor == ' ' || *cursor == '\n') {
+        ++cursor;
+    }
+    TEST_ASSERT_EQUAL('[', *cursor);
+    size_t numberOfObjects = 0;
+    while ((cursor = std::strchr(cursor, '{')) != nullptr) {
+        const char* end = std::strchr(cursor, '}');
+        TEST_ASSERT_NOT_NULL(end);
+        const std::string object(cursor, end + 1);
+        TEST_ASSERT_LESS_THAN(expected.size(), numberOfObjects);
+        const Signal& signal = expected[numberOfObjects++];
+
+        unsigned i2cAddress = 0;
+        unsigned long long timeStampMs = 0;
+        float value = 0.0f;
+        const size_t addressPosition = object.find("\"address\":");
+        const size_t timeStampPosition = object.find("\"timestamp_ms\":");
+        const size_t valuePosition = object.find("\"value\":");
+        TEST_ASSERT_TRUE(addressPosition != std::string::npos);
+        TEST_ASSERT_TRUE(timeStampPosition != std::string::npos);
+        TEST_ASSERT_TRUE(valuePosition != std::string::npos);
+        TEST_ASSERT_EQUAL(1, std::sscanf(object.c_str() + addressPosition,
+                                         "\"address\":%u", &i2cAddress));
+        TEST_ASSERT_EQUAL(1, std::sscanf(object.c_str() + timeStampPosition,
+                                         "\"timestamp_ms\":%llu",
+                                         &timeStampMs));
+        TEST_ASSERT_EQUAL(1, std::sscanf(object.c_str() + valuePosition,
+                                         "\"value\":%f", &value));
+        const std::string quantityField =
+            "\"quantity\":\"" + quantity(signal.signalType) + "\"";
+        TEST_ASSERT_TRUE(object.find(quantityField) != std::string::npos);
+        TEST_ASSERT_EQUAL(signal.i2cAddress, i2cAddress);
+        TEST_ASSERT_EQUAL_UINT64(signal.timeStampMs, timeStampMs);
+        TEST_ASSERT_FLOAT_WITHIN(0.005f, signal.value, value);
+        cursor = end;
+    }
+    TEST_ASSERT_EQUAL(expected.size(), numberOfObjects);
+    TEST_ASSERT_NOT_NULL(std::strchr(text, ']'));
+}
+
+void test_text_values_beyond_fixed_point_use_exponent_notation() {
+    core::MetaData metaData(core::SHT4X());
+    const SensorKey key{0, 0x44};
+    const float values[] = {3.0e38f, -1.5e19f, 9.999e19f};
+    const char* formatted[] = {"3.00e+38", "-1.50e+19", "1.00e+20"};
+
+    for (size_t i = 0; i < 3; ++i) {
+        const core::Measurement measurement(
+            metaData, core::SignalType::TEMPERATURE_DEGREES_CELSIUS,
+            core::DataPoint{10, values[i]});
+        for (const TextFormat format :
+             {TextFormat::CSV, TextFormat::JSON, TextFormat::LINE_PROTOCOL}) {
+            char text[256];
+            TextEncoder encoder(format, text, sizeof(text));
+            TEST_ASSERT_TRUE(encoder.append(key, measurement));
+            encoder.finish();
+            TEST_ASSERT_EQUAL(0, encoder.getNumberOfDroppedSignals());
+            TEST_ASSERT_NOT_NULL(std::strstr(text, formatted[i]));
+            TEST_ASSERT_NULL(std::strstr(text, "nan"));
+            TEST_ASSERT_NULL(std::strstr(text, "null"));
+        }
+    }
+}
+
+void test_text_buffer_never_holds_partial_signals() {
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    setUpSensors(manager);
+
+    const std::vector<Signal> expected = expectedSignals(manager);
+    char text[160];
+    TextEncoder encoder(TextFormat::CSV, text, sizeof(text));
+    const size_t length = manager.encodeSensorReadings(encoder);
+    TEST_ASSERT_EQUAL(std::strlen(text), length);
+    TEST_ASSERT_GREATER_THAN(0, encoder.getNumberOfDroppedSignals());
+
+    // Every line that was written is complete
+    const std::vector<std::string> lines = splitLines(text);
+    TEST_ASSERT_EQUAL(expected.size() - encoder.getNumberOfDroppedSignals(),
+                      lines.size() - 1);
+    TEST_ASSERT_EQUAL('\n', text[length - 1]);
+    for (size_t i = 1; i < lines.size(); ++i) {
+        size_t commas = 0;
+        for (const char c : lines[i]) {
+            commas += c == ',' ? 1 : 0;
+        }
+        TEST_ASSERT_EQUAL(7, commas);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_binary_batch_round_trip);
+    RUN_TEST(test_binary_batch_leaves_out_sensors_which_do_not_fit);
+    RUN_TEST(test_csv_round_trip);
+    RUN_TEST(test_line_protocol_round_trip);
+    RUN_TEST(test_json_round_trip);
+    RUN_TEST(test_text_values_beyond_fixed_point_use_exponent_notation);
+    RUN_TEST(test_text_buffer_never_holds_partial_signals);
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+/*
+ * The simulated bus and sensor models of the host build: address probes,
+ * the simulated clock, command execution times and CRC protected responses.
+ */
+#include "Arduino.h"
+#include "SensorModels.h"
+#include "Wire.h"
+#include <unity.h>
+
+namespace host = sensirion::upt::i2c_autodetect::host;
+
+namespace {
+
+uint8_t probe(TwoWire& wire, const uint8_t address) {
+    wire.beginTransmission(address);
+    return wire.endTransmission();
+}
+
+uint8_t sendCommand(TwoWire& wire, const uint8_t address,
+                    const uint8_t command) {
+    wire.beginTransmission(address);
+    wire.write(command);
+    return wire.endTransmission();
+}
+
+/* Reads numWords CRC protected words, returns false on a CRC mismatch */
+bool readWords(TwoWire& wire, const uint8_t address, uint16_t* words,
+               const size_t numWords) {
+    const size_t length = 3 * numWords;
+    if (wire.requestFrom(address, length, true) != length) {
+        return false;
+    }
+    for (size_t i = 0; i < numWords; ++i) {
+        const uint8_t msb = static_cast<uint8_t>(wire.read());
+        const uint8_t lsb = static_cast<uint8_t>(wire.read());
+        if (host::SensirionDeviceModel::crc8(msb, lsb) != wire.read()) {
+            return false;
+        }
+        words[i] = static_cast<uint16_t>(msb << 8 | lsb);
+    }
+    return true;
+}
+
+}  // namespace
+
+void setUp() {
+    host::resetClock();
+    Wire.setClock(TwoWire::DEFAULT_CLOCK_HZ);
+}
+
+void tearDown() {
+    for (uint8_t address = 0; address < 128; ++address) {
+        Wire.detachDevice(address);
+    }
+}
+
+void test_delay_advances_the_clock() {
+    TEST_ASSERT_EQUAL_UINT64(0, host::nowMicros());
+    delay(5);
+    TEST_ASSERT_EQUAL(5, millis());
+    delayMicroseconds(250);
+    TEST_ASSERT_EQUAL(5250, micros());
+    host::advanceMicros(750);
+    TEST_ASSERT_EQUAL(6, millis());
+}
+
+void test_probes_acknowledged_by_attached_devices_only() {
+    host::Sht4xModel sht4x;
+    TEST_ASSERT_EQUAL(2, probe(Wire, 0x44));
+
+    Wire.attachDevice(sht4x);
+    TEST_ASSERT_EQUAL_PTR(&sht4x, Wire.getDevice(0x44));
+    TEST_ASSERT_EQUAL(0, probe(Wire, 0x44));
+    TEST_ASSERT_EQUAL(2, probe(Wire, 0x45));
+    TEST_ASSERT_EQUAL(2, probe(Wire1, 0x44));
+
+    Wire.detachDevice(0x44);
+    TEST_ASSERT_NULL(Wire.getDevice(0x44));
+    TEST_ASSERT_EQUAL(2, probe(Wire, 0x44));
+}
+
+void test_transfers_take_time_on_the_wire() {
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+
+    // Start, address byte with ACK and stop at 100 kHz
+    probe(Wire, 0x44);
+    TEST_ASSERT_EQUAL_UINT64(110, host::nowMicros());
+
+    Wire.setClock(400000);
+    host::resetClock();
+    probe(Wire, 0x44);
+    TEST_ASSERT_EQUAL_UINT64(28, host::nowMicros());
+}
+
+void test_sht4x_measurement() {
+    host::Environment env;
+    env.temperatureDegC = {30.0f, 0.0f, 0};
+    env.humidityPercent = {60.0f, 0.0f, 0};
+    host::Sht4xModel sht4x(0x44, 0x12345678, env);
+    Wire.attachDevice(sht4x);
+
+    TEST_ASSERT_EQUAL(0, sendCommand(Wire, 0x44, 0xFD));
+    // The sensor refuses transfers until the measurement is complete
+    uint16_t words[2];
+    TEST_ASSERT_FALSE(readWords(Wire, 0x44, words, 2));
+    TEST_ASSERT_EQUAL(2, probe(Wire, 0x44));
+
+    delay(9);
+    TEST_ASSERT_TRUE(readWords(Wire, 0x44, words, 2));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 30.0f,
+                             -45.0f + 175.0f * words[0] / 65535.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f,
+                             -6.0f + 125.0f * words[1] / 65535.0f);
+
+    // The response is consumed by the read
+    TEST_ASSERT_EQUAL(0, Wire.requestFrom(0x44, 6));
+}
+
+void test_sht4x_serial_number_and_unknown_commands() {
+    host::Sht4xModel sht4x(0x44, 0xCAFE0042);
+    Wire.attachDevice(sht4x);
+
+    TEST_ASSERT_EQUAL(0, sendCommand(Wire, 0x44, 0x89));
+    delay(1);
+    uint16_t words[2];
+    TEST_ASSERT_TRUE(readWords(Wire, 0x44, words, 2));
+    TEST_ASSERT_EQUAL_HEX16(0xCAFE, words[0]);
+    TEST_ASSERT_EQUAL_HEX16(0x0042, words[1]);
+
+    // Data NACK for commands the sensor does not know
+    TEST_ASSERT_EQUAL(3, sendCommand(Wire, 0x44, 0x42));
+}
+
+void test_traffic_statistics() {
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+    Wire.resetStatistics();
+
+    probe(Wire, 0x45);
+    sendCommand(Wire, 0x44, 0xFD);
+    delay(9);
+    Wire.requestFrom(0x44, 6);
+
+    const TwoWire::Statistics& statistics = Wire.getStatistics();
+    TEST_ASSERT_EQUAL(3, statistics.transactions);
+    TEST_ASSERT_EQUAL(1, statistics.nacks);
+    TEST_ASSERT_EQUAL(1, statistics.bytesWritten);
+    TEST_ASSERT_EQUAL(6, statistics.bytesRead);
+
+    Wire.resetStatistics();
+    TEST_ASSERT_EQUAL(0, Wire.getStatistics().transactions);
+}
+
+void test_crc8() {
+    // Example from the Sensirion datasheets
+    TEST_ASSERT_EQUAL_HEX8(0x92, host::SensirionDeviceModel::crc8(0xBE, 0xEF));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_delay_advances_the_clock);
+    RUN_TEST(test_probes_acknowledged_by_attached_devices_only);
+    RUN_TEST(test_transfers_take_time_on_the_wire);
+    RUN_TEST(test_sht4x_measurement);
+    RUN_TEST(test_sht4x_serial_number_and_unknown_commands);
+    RUN_TEST(test_traffic_statistics);
+    RUN_TEST(test_crc8);
+    return UNITY_END();
+}
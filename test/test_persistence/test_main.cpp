@@ -0,0 +1,395 @@
+/*
+ * Persistence of the sensor readings and of the bus traffic: read-back of the
+ * SampleLog, skipping of corrupted blocks, and record/replay of I2C traces.
+ */
+#include "Sensirion_upt_i2c_auto_detection.h"
+#include "DefaultDriverConfig.h"
+#include "I2cTrace.h"
+#include "SensorModels.h"
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <string>
+#include <unistd.h>
+#include <unity.h>
+#include <vector>
+
+using namespace sensirion::upt::i2c_autodetect;
+namespace core = sensirion::upt::core;
+
+namespace {
+
+constexpr size_t MAX_SENSORS = DefaultI2cDetector::CONFIGURED_SENSORS;
+using MeasurementList = SensorManager::MeasurementList;
+
+// Temporary directory of a test, removed with its files by tearDown()
+char gDirectory[] = "/tmp/upt_test_XXXXXX";
+std::string gDirectoryPath;
+
+std::string pathInDirectory(const char* name) {
+    return gDirectoryPath + "/" + name;
+}
+
+void removeDirectory(const std::string& path) {
+    DIR* directory = opendir(path.c_str());
+    if (!directory) {
+        return;
+    }
+    while (const dirent* entry = readdir(directory)) {
+        const std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+            removeDirectory(path + "/" + name);
+            std::remove((path + "/" + name).c_str());
+        }
+    }
+    closedir(directory);
+    rmdir(path.c_str());
+}
+
+void communicateFor(SensorManager& manager, const uint64_t durationUs) {
+    const uint64_t untilUs = host::nowMicros() + durationUs;
+    while (host::nowMicros() < untilUs) {
+        host::advanceMicros(manager.nextWakeupMs() * 1000ull + 1000);
+        manager.executeSensorCommunication();
+    }
+}
+
+// Readings of a sensor with two signals at a given time
+MeasurementList makeReadings(const uint32_t timeMs) {
+    core::MetaData metaData(core::SHT4X());
+    metaData.deviceID = 7;
+    MeasurementList measurements;
+    measurements.emplace_back(
+        metaData, core::SignalType::TEMPERATURE_DEGREES_CELSIUS,
+        core::DataPoint{timeMs, static_cast<float>(timeMs) / 1000.0f});
+    measurements.emplace_back(
+        metaData, core::SignalType::RELATIVE_HUMIDITY_PERCENTAGE,
+        core::DataPoint{timeMs, 50.0f});
+    return measurements;
+}
+
+// Record one set of readings per second, syncing as an application would
+void recordReadings(SampleLog& log, const uint32_t numberOfReadings) {
+    for (uint32_t i = 1; i <= numberOfReadings; ++i) {
+        log.record(SensorKey{0, 0x44, 7}, makeReadings(i * 1000));
+        if (i % 100 == 0) {
+            log.sync();
+        }
+    }
+    log.flush();
+    log.sync();
+}
+
+struct LoggedReading {
+    uint8_t i2cAddress;
+    uint64_t deviceID;
+    std::string deviceLabel;
+    core::SignalType signalType;
+    uint64_t timeMs;
+    float value;
+};
+
+std::vector<LoggedReading> readLog(SampleLog& log, const uint64_t fromMs,
+                                   const uint64_t toMs) {
+    std::vector<LoggedReading> readings;
+    const size_t count = log.read(
+        fromMs, toMs,
+        [&](const SampleLog::LoggedSensor& sensor,
+            const core::SignalType signalType, const uint64_t timeMs,
+            const float value) {
+            readings.push_back({sensor.key.i2cAddress, sensor.key.deviceID,
+                                sensor.deviceLabel, signalType, timeMs,
+                                value});
+        });
+    TEST_ASSERT_EQUAL(readings.size(), count);
+    return readings;
+}
+
+// Values of all signals after each call of executeSensorCommunication()
+std::vector<float> runSession(TwoWire& bus, const uint64_t durationUs) {
+    DefaultI2cDetector detector(bus);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    std::vector<float> values;
+    const uint64_t untilUs = host::nowMicros() + durationUs;
+    while (host::nowMicros() < untilUs) {
+        host::advanceMicros(manager.nextWakeupMs() * 1000ull + 1000);
+        manager.executeSensorCommunication();
+        SensorFrame<MAX_SENSORS> frame;
+        manager.getSensorFrame(frame);
+        values.insert(values.end(), frame.getValues(),
+                      frame.getValues() + frame.getNumberOfSignals());
+    }
+    return values;
+}
+
+}  // namespace
+
+void setUp() {
+    host::resetClock();
+    Wire.resetStatistics();
+    std::snprintf(gDirectory, sizeof(gDirectory), "/tmp/upt_test_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(gDirectory));
+    gDirectoryPath = gDirectory;
+}
+
+void tearDown() {
+    for (uint8_t address = 0; address < 128; ++address) {
+        Wire.detachDevice(address);
+    }
+    removeDirectory(gDirectoryPath);
+}
+
+void test_sample_log_reads_back_the_readings() {
+    const std::string directory = pathInDirectory("log");
+    SampleLog log(directory.c_str());
+    TEST_ASSERT_TRUE(log.begin());
+    // Two records per reading, spanning three blocks
+    const uint32_t numberOfReadings = SampleLog::RECORDS_PER_BLOCK + 50;
+    recordReadings(log, numberOfReadings);
+    TEST_ASSERT_EQUAL(0, log.getDroppedCount());
+
+    const std::vector<LoggedReading> readings = readLog(log, 0, UINT64_MAX);
+    TEST_ASSERT_EQUAL(2 * numberOfReadings, readings.size());
+    for (size_t i = 0; i < readings.size(); ++i) {
+        const uint64_t timeMs = (i / 2 + 1) * 1000;
+        TEST_ASSERT_EQUAL(0x44, readings[i].i2cAddress);
+        TEST_ASSERT_EQUAL_UINT64(7, readings[i].deviceID);
+        TEST_ASSERT_EQUAL_STRING(core::deviceLabel(core::SHT4X()),
+                                 readings[i].deviceLabel.c_str());
+        TEST_ASSERT_EQUAL_UINT64(timeMs, readings[i].timeMs);
+        if (i % 2 == 0) {
+            TEST_ASSERT_TRUE(readings[i].signalType ==
+                             core::SignalType::TEMPERATURE_DEGREES_CELSIUS);
+            TEST_ASSERT_EQUAL_FLOAT(timeMs / 1000.0f, readings[i].value);
+        } else {
+            TEST_ASSERT_EQUAL_FLOAT(50.0f, readings[i].value);
+        }
+    }
+
+    // A time range, inclusive
+    const std::vector<LoggedReading> range = readLog(log, 100000, 199000);
+    TEST_ASSERT_EQUAL(2 * 100, range.size());
+    TEST_ASSERT_EQUAL_UINT64(100000, range.front().timeMs);
+    TEST_ASSERT_EQUAL_UINT64(199000, range.back().timeMs);
+
+    // The log survives a restart
+    SampleLog reopened(directory.c_str());
+    TEST_ASSERT_TRUE(reopened.begin());
+    TEST_ASSERT_EQUAL(2 * numberOfReadings,
+                      readLog(reopened, 0, UINT64_MAX).size());
+}
+
+void test_sample_log_skips_corrupted_blocks() {
+    const std::string directory = pathInDirectory("log");
+    SampleLog log(directory.c_str());
+    TEST_ASSERT_TRUE(log.begin());
+    // Three full blocks
+    const uint32_t numberOfReadings = 3 * SampleLog::RECORDS_PER_BLOCK / 2;
+    recordReadings(log, numberOfReadings);
+    const size_t recordsPerBlock = SampleLog::RECORDS_PER_BLOCK;
+    TEST_ASSERT_EQUAL(2 * numberOfReadings,
+                      readLog(log, 0, UINT64_MAX).size());
+
+    // Flip a bit in a record of the second block
+    const std::string segment = directory + "/00000000.slg";
+    FILE* file = std::fopen(segment.c_str(), "r+b");
+    TEST_ASSERT_NOT_NULL(file);
+    const long offset = SampleLog::BLOCK_SIZE + SampleLog::BLOCK_SIZE - 8;
+    TEST_ASSERT_EQUAL(0, std::fseek(file, offset, SEEK_SET));
+    const int byte = std::fgetc(file);
+    TEST_ASSERT_EQUAL(0, std::fseek(file, offset, SEEK_SET));
+    std::fputc(byte ^ 0x01, file);
+    std::fclose(file);
+
+    // The records of the other blocks are still read, in order
+    const std::vector<LoggedReading> readings = readLog(log, 0, UINT64_MAX);
+    TEST_ASSERT_EQUAL(2 * numberOfReadings - recordsPerBlock,
+                      readings.size());
+    for (size_t i = 1; i < readings.size(); ++i) {
+        TEST_ASSERT_GREATER_OR_EQUAL(readings[i - 1].timeMs,
+                                     readings[i].timeMs);
+    }
+    TEST_ASSERT_EQUAL_UINT64(recordsPerBlock / 2 * 1000,
+                             readings[recordsPerBlock - 1].timeMs);
+    TEST_ASSERT_EQUAL_UINT64(recordsPerBlock * 1000 + 1000,
+                             readings[recordsPerBlock].timeMs);
+}
+
+void test_sample_log_deletes_the_oldest_segments() {
+    const std::string directory = pathInDirectory("log");
+    SampleLog log(directory.c_str(), 1, 2);
+    TEST_ASSERT_TRUE(log.begin());
+    const size_t recordsPerBlock = SampleLog::RECORDS_PER_BLOCK;
+    recordReadings(log, 2 * recordsPerBlock);
+
+    // Four blocks of one segment each, of which the last two are kept
+    const std::vector<LoggedReading> readings = readLog(log, 0, UINT64_MAX);
+    TEST_ASSERT_EQUAL(2 * recordsPerBlock, readings.size());
+    TEST_ASSERT_EQUAL_UINT64(recordsPerBlock * 1000 + 1000,
+                             readings.front().timeMs);
+    FILE* first = std::fopen((directory + "/00000000.slg").c_str(), "rb");
+    TEST_ASSERT_NULL(first);
+}
+
+void test_sample_log_records_the_readings_of_the_manager() {
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    const std::string directory = pathInDirectory("log");
+    SampleLog log(directory.c_str());
+    TEST_ASSERT_TRUE(log.begin());
+    manager.setHistory(&log);
+    manager.refreshConnectedSensors();
+    // Synced every second, as from the loop
+    for (int second = 0; second < 30; ++second) {
+        communicateFor(manager, 1000000);
+        log.sync();
+    }
+    log.flush();
+    log.sync();
+    TEST_ASSERT_EQUAL(0, log.getDroppedCount());
+
+    // One generation per readout of the only sensor
+    const uint32_t readouts = manager.getGeneration();
+    const std::vector<LoggedReading> readings = readLog(log, 0, UINT64_MAX);
+    TEST_ASSERT_GREATER_THAN(0, readouts);
+    TEST_ASSERT_EQUAL(2 * readouts, readings.size());
+
+    // The last logged readings are the current ones
+    const MeasurementList* current[MAX_SENSORS];
+    manager.getSensorReadings(current);
+    const MeasurementList* measurements = nullptr;
+    for (const auto* candidate : current) {
+        measurements = candidate ? candidate : measurements;
+    }
+    TEST_ASSERT_NOT_NULL(measurements);
+    for (size_t i = 0; i < measurements->size(); ++i) {
+        const LoggedReading& reading =
+            readings[readings.size() - measurements->size() + i];
+        TEST_ASSERT_EQUAL_UINT64((*measurements)[i].dataPoint.t_offset,
+                                 reading.timeMs);
+        TEST_ASSERT_EQUAL_FLOAT((*measurements)[i].dataPoint.value,
+                                reading.value);
+    }
+}
+
+void test_sample_log_forwards_the_readings_downstream() {
+    const std::string directory = pathInDirectory("log");
+    SampleLog log(directory.c_str());
+    SensorHistory<MAX_SENSORS, 4> history;
+    TEST_ASSERT_TRUE(log.begin());
+    log.setDownstreamHistory(&history);
+
+    // Without sync() the log drops readings, the history still gets them
+    const uint32_t numberOfReadings = 2 * SampleLog::RECORDS_PER_BLOCK;
+    for (uint32_t i = 1; i <= numberOfReadings; ++i) {
+        log.record(SensorKey{0, 0x44, 7}, makeReadings(i * 1000));
+    }
+    TEST_ASSERT_GREATER_THAN(0, log.getDroppedCount());
+    TEST_ASSERT_EQUAL_UINT32(numberOfReadings, history.getNewestSequence());
+
+    std::vector<float> values;
+    history.drain(numberOfReadings - 1,
+                  [&](const SensorKey& key, uint32_t,
+                      const core::Measurement& measurement) {
+                      TEST_ASSERT_EQUAL(0x44, key.i2cAddress);
+                      values.push_back(measurement.dataPoint.value);
+                  });
+    TEST_ASSERT_EQUAL(2, values.size());
+    TEST_ASSERT_EQUAL_FLOAT(numberOfReadings, values[0]);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, values[1]);
+}
+
+void test_replayed_trace_reproduces_the_session() {
+    const std::string trace = pathInDirectory("session.i2c");
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+
+    std::vector<float> recorded;
+    size_t numberOfTransactions = 0;
+    {
+        host::RecordingWire recorder(Wire);
+        TEST_ASSERT_TRUE(recorder.open(trace.c_str()));
+        recorded = runSession(recorder, 10000000);
+        recorder.close();
+        numberOfTransactions = recorder.getNumberOfTransactions();
+    }
+    TEST_ASSERT_EQUAL(Wire.getStatistics().transactions,
+                      numberOfTransactions);
+    TEST_ASSERT_GREATER_THAN(0, recorded.size());
+
+    // Without any simulated sensor on the bus
+    Wire.detachDevice(0x44);
+    Wire.detachDevice(0x29);
+    host::resetClock();
+    Wire.resetStatistics();
+    host::ReplayWire replay;
+    TEST_ASSERT_TRUE(replay.load(trace.c_str()));
+    TEST_ASSERT_EQUAL(numberOfTransactions, replay.getNumberOfTransactions());
+    const std::vector<float> replayed = runSession(replay, 10000000);
+
+    TEST_ASSERT_EQUAL(0, replay.getNumberOfMismatches());
+    TEST_ASSERT_TRUE(replay.isExhausted());
+    TEST_ASSERT_EQUAL(0, replay.getMaxTimeDeviationUs());
+    TEST_ASSERT_EQUAL(0, Wire.getStatistics().transactions);
+    TEST_ASSERT_EQUAL(recorded.size(), replayed.size());
+    TEST_ASSERT_EQUAL_MEMORY(recorded.data(), replayed.data(),
+                             recorded.size() * sizeof(float));
+
+    // A diverging session is detected
+    host::resetClock();
+    replay.rewind();
+    DefaultI2cDetector detector(replay);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+    manager.setInterval(5000, SensorKey{0, 0x44});
+    communicateFor(manager, 10000000);
+    TEST_ASSERT_GREATER_THAN(0, replay.getNumberOfMismatches());
+}
+
+void test_truncated_trace_is_reported() {
+    const std::string trace = pathInDirectory("session.i2c");
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+    size_t numberOfTransactions = 0;
+    {
+        host::RecordingWire recorder(Wire);
+        TEST_ASSERT_TRUE(recorder.open(trace.c_str()));
+        runSession(recorder, 5000000);
+        recorder.close();
+        numberOfTransactions = recorder.getNumberOfTransactions();
+    }
+    host::ReplayWire replay;
+    TEST_ASSERT_TRUE(replay.load(trace.c_str()));
+    TEST_ASSERT_FALSE(replay.isTruncated());
+
+    // Cut the last transaction, as by a crash during the recording
+    FILE* file = std::fopen(trace.c_str(), "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fclose(file);
+    TEST_ASSERT_EQUAL(0, truncate(trace.c_str(), size - 1));
+
+    TEST_ASSERT_FALSE(replay.load(trace.c_str()));
+    TEST_ASSERT_TRUE(replay.isTruncated());
+    TEST_ASSERT_EQUAL(numberOfTransactions - 1,
+                      replay.getNumberOfTransactions());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sample_log_reads_back_the_readings);
+    RUN_TEST(test_sample_log_skips_corrupted_blocks);
+    RUN_TEST(test_sample_log_deletes_the_oldest_segments);
+    RUN_TEST(test_sample_log_records_the_readings_of_the_manager);
+    RUN_TEST(test_sample_log_forwards_the_readings_downstream);
+    RUN_TEST(test_replayed_trace_reproduces_the_session);
+    RUN_TEST(test_truncated_trace_is_reported);
+    return UNITY_END();
+}
@@ -0,0 +1,536 @@
+/*
+ * Consumption of the sensor readings: fresh readings, subscriptions, the
+ * history of the readings and the frame shared with reader tasks.
+ */
+#include "Sensirion_upt_i2c_auto_detection.h"
+#include "DefaultDriverConfig.h"
+#include "SensorModels.h"
+#include <atomic>
+#include <thread>
+#include <unity.h>
+#include <vector>
+
+using namespace sensirion::upt::i2c_autodetect;
+namespace core = sensirion::upt::core;
+
+namespace {
+
+constexpr size_t MAX_SENSORS = DefaultI2cDetector::CONFIGURED_SENSORS;
+using MeasurementList = SensorManager::MeasurementList;
+
+void communicateFor(SensorManager& manager, const uint64_t durationUs) {
+    const uint64_t untilUs = host::nowMicros() + durationUs;
+    while (host::nowMicros() < untilUs) {
+        host::advanceMicros(manager.nextWakeupMs() * 1000ull + 1000);
+        manager.executeSensorCommunication();
+    }
+}
+
+size_t countReadings(const MeasurementList* readings[]) {
+    size_t count = 0;
+    for (size_t i = 0; i < MAX_SENSORS; ++i) {
+        count += readings[i] ? 1 : 0;
+    }
+    return count;
+}
+
+// Readings of a sensor with a single signal, whose value identifies the
+// sample
+MeasurementList makeReadings(const float value) {
+    MeasurementList measurements;
+    measurements.emplace_back(
+        core::MetaData(core::SHT4X()),
+        core::SignalType::TEMPERATURE_DEGREES_CELSIUS,
+        core::DataPoint{static_cast<unsigned long>(value), value});
+    return measurements;
+}
+
+struct DrainedSample {
+    uint8_t i2cAddress;
+    uint32_t sequence;
+    float value;
+};
+
+template <class HistoryT>
+uint32_t drainInto(const HistoryT& history, const uint32_t sinceSequence,
+                   std::vector<DrainedSample>& samples,
+                   const size_t maxSamples = SIZE_MAX) {
+    return history.drain(
+        sinceSequence,
+        [&](const SensorKey& key, const uint32_t sequence,
+            const core::Measurement& measurement) {
+            samples.push_back(
+                {key.i2cAddress, sequence, measurement.dataPoint.value});
+        },
+        maxSamples);
+}
+
+struct Notifications {
+    size_t count = 0;
+    SensorKey lastKey;
+    size_t lastNumberOfSignals = 0;
+    float lastValue = 0.0f;
+};
+
+void onSensorReadings(const SensorKey& key,
+                      const MeasurementList& measurements, void* context) {
+    Notifications& notifications = *static_cast<Notifications*>(context);
+    notifications.count++;
+    notifications.lastKey = key;
+    notifications.lastNumberOfSignals = measurements.size();
+}
+
+void onSignalReading(const SensorKey& key,
+                     const core::Measurement& measurement, void* context) {
+    Notifications& notifications = *static_cast<Notifications*>(context);
+    notifications.count++;
+    notifications.lastKey = key;
+    notifications.lastValue = measurement.dataPoint.value;
+}
+
+struct ThreadedNotifications {
+    std::thread::id expectedThread;
+    size_t count = 0;
+    size_t countOnOtherThreads = 0;
+    uint32_t busMask = 0;
+};
+
+void onSensorReadingsOnThread(const SensorKey& key, const MeasurementList&,
+                              void* context) {
+    auto& notifications = *static_cast<ThreadedNotifications*>(context);
+    notifications.count++;
+    if (std::this_thread::get_id() != notifications.expectedThread) {
+        notifications.countOnOtherThreads++;
+    }
+    notifications.busMask |= 1u << key.busId;
+}
+
+}  // namespace
+
+void setUp() {
+    host::resetClock();
+    Wire.resetStatistics();
+}
+
+void tearDown() {
+    for (uint8_t address = 0; address < 128; ++address) {
+        Wire.detachDevice(address);
+        Wire1.detachDevice(address);
+    }
+}
+
+void test_fresh_readings_only_hold_new_readings() {
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+    manager.setInterval(1000, SensorKey{0, 0x44});
+    manager.setInterval(5000, SensorKey{0, 0x29});
+    communicateFor(manager, 6000000);
+
+    const MeasurementList* readings[MAX_SENSORS];
+    uint32_t generation = manager.getFreshReadings(readings, 0);
+    TEST_ASSERT_EQUAL(manager.getGeneration(), generation);
+    TEST_ASSERT_EQUAL(2, countReadings(readings));
+
+    // Nothing new without communication
+    TEST_ASSERT_EQUAL(generation, manager.getFreshReadings(readings,
+                                                           generation));
+    TEST_ASSERT_EQUAL(0, countReadings(readings));
+
+    // Only the SHT4x is read within the next second
+    host::advanceMicros(1100000);
+    manager.executeSensorCommunication();
+    manager.collectPendingMeasurements();
+    generation = manager.getFreshReadings(readings, generation);
+    TEST_ASSERT_EQUAL(1, countReadings(readings));
+    for (const auto* measurements : readings) {
+        if (measurements) {
+            TEST_ASSERT_TRUE((*measurements)[0].metaData.deviceType ==
+                             core::SHT4X());
+        }
+    }
+    TEST_ASSERT_EQUAL(manager.getGeneration(), generation);
+}
+
+void test_subscriptions_are_notified_of_matching_readings() {
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+    manager.setInterval(1000, SensorKey{0, 0x44});
+    manager.setInterval(1000, SensorKey{0, 0x29});
+    SensorHistory<MAX_SENSORS, 16> history;
+    manager.setHistory(&history);
+
+    Notifications byKey;
+    Notifications byType;
+    Notifications bySignal;
+    const int keyId =
+        manager.subscribe(SensorKey{0, 0x29}, onSensorReadings, &byKey);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, keyId);
+    TEST_ASSERT_GREATER_OR_EQUAL(
+        0, manager.subscribe(core::SHT4X(), onSensorReadings, &byType));
+    TEST_ASSERT_GREATER_OR_EQUAL(
+        0, manager.subscribe(core::SignalType::RELATIVE_HUMIDITY_PERCENTAGE,
+                             onSignalReading, &bySignal));
+    communicateFor(manager, 5000000);
+
+    TEST_ASSERT_GREATER_THAN(0, byKey.count);
+    TEST_ASSERT_EQUAL(0x29, byKey.lastKey.i2cAddress);
+    // Once per readout of the SHT4x
+    size_t sht4xReadouts = 0;
+    uint32_t lastSequence = 0;
+    history.drain(0, [&](const SensorKey& key, const uint32_t sequence,
+                         const core::Measurement&) {
+        if (key.i2cAddress == 0x44 && sequence != lastSequence) {
+            sht4xReadouts++;
+            lastSequence = sequence;
+        }
+    });
+    TEST_ASSERT_EQUAL(sht4xReadouts, byType.count);
+    TEST_ASSERT_EQUAL(0x44, byType.lastKey.i2cAddress);
+    TEST_ASSERT_EQUAL(2, byType.lastNumberOfSignals);
+    // Only the SHT4x measures the humidity
+    TEST_ASSERT_EQUAL(byType.count, bySignal.count);
+    TEST_ASSERT_EQUAL(0x44, bySignal.lastKey.i2cAddress);
+    TEST_ASSERT_GREATER_THAN(0.0f, bySignal.lastValue);
+
+    const size_t countAtUnsubscribe = byKey.count;
+    manager.unsubscribe(keyId);
+    communicateFor(manager, 3000000);
+    TEST_ASSERT_EQUAL(countAtUnsubscribe, byKey.count);
+    TEST_ASSERT_GREATER_THAN(countAtUnsubscribe, bySignal.count);
+}
+
+void test_subscriptions_are_bounded() {
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    Notifications notifications;
+    int ids[SensorSubscriptions::MAX_SUBSCRIPTIONS];
+    for (int& id : ids) {
+        id = manager.subscribe(core::SHT4X(), onSensorReadings,
+                               &notifications);
+        TEST_ASSERT_GREATER_OR_EQUAL(0, id);
+    }
+    TEST_ASSERT_EQUAL(-1, manager.subscribe(core::SHT4X(), onSensorReadings,
+                                            &notifications));
+
+    // A released subscription can be taken again
+    manager.unsubscribe(ids[3]);
+    TEST_ASSERT_GREATER_OR_EQUAL(
+        0, manager.subscribe(core::SHT4X(), onSensorReadings, &notifications));
+}
+
+void test_multi_bus_notifies_on_the_calling_thread() {
+    host::Sht4xModel sht4xBus0;
+    host::Sht4xModel sht4xBus1;
+    Wire.attachDevice(sht4xBus0);
+    Wire1.attachDevice(sht4xBus1);
+    DefaultI2cDetector detectorBus0(Wire, 0);
+    DefaultI2cDetector detectorBus1(Wire1, 1);
+    MultiBusSensorManager manager({detectorBus0, detectorBus1});
+    // One history serves both buses
+    SensorHistory<2 * MAX_SENSORS, 16> history;
+    manager.setHistory(&history);
+    ThreadedNotifications notifications;
+    notifications.expectedThread = std::this_thread::get_id();
+    const int id = manager.subscribe(core::SHT4X(), onSensorReadingsOnThread,
+                                     &notifications);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, id);
+
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+    manager.setInterval(1000, core::SHT4X());
+    while (host::nowMicros() < 5000000) {
+        host::advanceMicros(manager.nextWakeupMs() * 1000ull + 1000);
+        manager.executeSensorCommunication();
+    }
+
+    TEST_ASSERT_GREATER_THAN(0, notifications.count);
+    TEST_ASSERT_EQUAL(0, notifications.countOnOtherThreads);
+    TEST_ASSERT_EQUAL_HEX32(0x3, notifications.busMask);
+    // One sample per signal and readout
+    std::vector<DrainedSample> samples;
+    drainInto(history, 0, samples);
+    TEST_ASSERT_EQUAL(2 * notifications.count, samples.size());
+
+    const size_t countAtUnsubscribe = notifications.count;
+    manager.unsubscribe(id);
+    host::advanceMicros(2000000);
+    manager.executeSensorCommunication();
+    TEST_ASSERT_EQUAL(countAtUnsubscribe, notifications.count);
+}
+
+void test_history_drains_in_batches_across_wraparound() {
+    SensorHistory<2, 4> history;
+    const SensorKey first{0, 0x44};
+    const SensorKey second{0, 0x45};
+    for (int i = 1; i <= 6; ++i) {
+        history.record(i % 2 ? first : second,
+                       makeReadings(static_cast<float>(i)));
+    }
+    TEST_ASSERT_EQUAL(6, history.getNewestSequence());
+
+    // Batches of two samples, in order of the sequence numbers across
+    // both sensors
+    std::vector<DrainedSample> samples;
+    uint32_t sequence = drainInto(history, 0, samples, 2);
+    TEST_ASSERT_EQUAL(2, sequence);
+    sequence = drainInto(history, sequence, samples, 2);
+    sequence = drainInto(history, sequence, samples, 2);
+    TEST_ASSERT_EQUAL(6, sequence);
+    TEST_ASSERT_EQUAL(6, samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        TEST_ASSERT_EQUAL(i + 1, samples[i].sequence);
+        TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(i + 1), samples[i].value);
+        TEST_ASSERT_EQUAL(i % 2 ? 0x45 : 0x44, samples[i].i2cAddress);
+    }
+    TEST_ASSERT_EQUAL(6, drainInto(history, sequence, samples));
+    TEST_ASSERT_EQUAL(6, samples.size());
+
+    // Each sensor wraps around after 4 samples, losing samples 1, 3 and 5
+    // of the first one
+    for (int i = 7; i <= 10; ++i) {
+        history.record(first, makeReadings(static_cast<float>(i)));
+    }
+    TEST_ASSERT_EQUAL(10, history.getNewestSequence());
+
+    samples.clear();
+    TEST_ASSERT_EQUAL(10, drainInto(history, 0, samples));
+    const uint32_t expected[] = {2, 4, 6, 7, 8, 9, 10};
+    TEST_ASSERT_EQUAL(7, samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        TEST_ASSERT_EQUAL(expected[i], samples[i].sequence);
+        TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(expected[i]),
+                                samples[i].value);
+    }
+}
+
+void test_history_drops_sensors_beyond_capacity() {
+    SensorHistory<1, 4> history;
+    history.record(SensorKey{0, 0x44}, makeReadings(1.0f));
+    history.record(SensorKey{0, 0x45}, makeReadings(2.0f));
+    TEST_ASSERT_EQUAL(1, history.getNumberOfSensors());
+    TEST_ASSERT_EQUAL(1, history.getDroppedCount());
+    TEST_ASSERT_EQUAL(1, history.getNewestSequence());
+
+    history.clear();
+    TEST_ASSERT_EQUAL(0, history.getNumberOfSensors());
+    std::vector<DrainedSample> samples;
+    TEST_ASSERT_EQUAL(1, drainInto(history, 1, samples));
+    TEST_ASSERT_EQUAL(0, samples.size());
+}
+
+void test_history_drains_concurrently_with_record() {
+    // Every signal of sample n holds the value n, and the samples alternate
+    // between two sensors, such that torn or misattributed samples are
+    // detected
+    constexpr uint32_t NUMBER_OF_SAMPLES = 200000;
+    static SensorHistory<2, 2> history;
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> tornSamples{0};
+    std::atomic<uint32_t> drainedSamples{0};
+    std::atomic<uint32_t> lastDrainedSequence{0};
+
+    std::thread consumer([&]() {
+        uint32_t cursor = 0;
+        uint32_t lastSequence = 0;
+        // Drain in batches until the last sample was seen
+        while (!done.load() || cursor != history.getNewestSequence()) {
+            cursor = history.drain(
+                cursor,
+                [&](const SensorKey& key, const uint32_t sequence,
+                    const core::Measurement& measurement) {
+                    if (sequence != lastSequence) {
+                        // Visited in order of the sequence numbers
+                        tornSamples += sequence > lastSequence ? 0 : 1;
+                        lastSequence = sequence;
+                        drainedSamples++;
+                    }
+                    if (measurement.dataPoint.value !=
+                            static_cast<float>(sequence) ||
+                        measurement.dataPoint.t_offset != sequence ||
+                        key.i2cAddress != (sequence % 2 ? 0x44 : 0x45)) {
+                        tornSamples++;
+                    }
+                },
+                8);
+        }
+        lastDrainedSequence = cursor;
+    });
+
+    MeasurementList measurements;
+    for (size_t i = 0; i < ISensor::MAX_NUMBER_OF_DATA_POINTS; ++i) {
+        measurements.emplace_back(
+            core::MetaData(core::SHT4X()),
+            core::SignalType::TEMPERATURE_DEGREES_CELSIUS,
+            core::DataPoint{0, 0.0f});
+    }
+    for (uint32_t n = 1; n <= NUMBER_OF_SAMPLES; ++n) {
+        for (auto& measurement : measurements) {
+            measurement.dataPoint = core::DataPoint{n, static_cast<float>(n)};
+        }
+        history.record(SensorKey{0, static_cast<uint8_t>(n % 2 ? 0x44 : 0x45)},
+                       measurements);
+    }
+    done = true;
+    consumer.join();
+
+    TEST_ASSERT_EQUAL(NUMBER_OF_SAMPLES, history.getNewestSequence());
+    TEST_ASSERT_EQUAL(NUMBER_OF_SAMPLES, lastDrainedSequence.load());
+    TEST_ASSERT_GREATER_THAN(0, drainedSamples.load());
+    TEST_ASSERT_LESS_OR_EQUAL(NUMBER_OF_SAMPLES, drainedSamples.load());
+    TEST_ASSERT_EQUAL(0, tornSamples.load());
+}
+
+void test_history_records_the_readings_of_the_manager() {
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    SensorHistory<MAX_SENSORS, 8> history;
+    manager.setHistory(&history);
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+    manager.setInterval(1000, core::SHT4X());
+
+    // Count the readouts by the timestamps of the readings
+    const MeasurementList* readings[MAX_SENSORS];
+    const MeasurementList* current = nullptr;
+    unsigned long timeStampMs = 0;
+    uint32_t readouts = 0;
+    while (host::nowMicros() < 5000000) {
+        host::advanceMicros(manager.nextWakeupMs() * 1000ull + 1000);
+        manager.executeSensorCommunication();
+        manager.getSensorReadings(readings);
+        for (const auto* measurements : readings) {
+            current = measurements ? measurements : current;
+        }
+        if (current && (*current)[0].dataPoint.t_offset != timeStampMs) {
+            timeStampMs = (*current)[0].dataPoint.t_offset;
+            readouts++;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, readouts);
+    TEST_ASSERT_EQUAL(readouts, history.getNewestSequence());
+
+    // The newest sample equals the current readings
+    TEST_ASSERT_NOT_NULL(current);
+    std::vector<DrainedSample> samples;
+    drainInto(history, history.getNewestSequence() - 1, samples);
+    TEST_ASSERT_EQUAL(current->size(), samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        TEST_ASSERT_EQUAL_FLOAT((*current)[i].dataPoint.value,
+                                samples[i].value);
+    }
+}
+
+void test_shared_frame_equals_the_readings() {
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    communicateFor(manager, 3000000);
+
+    SharedSensorFrame<MAX_SENSORS> shared;
+    manager.publishSensorFrame(shared);
+    SensorFrame<MAX_SENSORS> published;
+    SensorFrame<MAX_SENSORS> expected;
+    TEST_ASSERT_EQUAL(1, shared.read(published));
+    manager.getSensorFrame(expected);
+
+    TEST_ASSERT_EQUAL(2, published.getNumberOfSensors());
+    TEST_ASSERT_EQUAL(expected.getNumberOfSignals(),
+                      published.getNumberOfSignals());
+    TEST_ASSERT_EQUAL_MEMORY(expected.getValues(), published.getValues(),
+                             expected.getNumberOfSignals() * sizeof(float));
+    TEST_ASSERT_EQUAL_MEMORY(expected.getTimeStamps(),
+                             published.getTimeStamps(),
+                             expected.getNumberOfSignals() * sizeof(uint32_t));
+}
+
+void test_shared_frame_reads_are_never_torn() {
+    // The writer publishes frames whose values all equal the publication
+    // number, such that a frame mixing two publications is detected
+    constexpr size_t NUMBER_OF_SENSORS = 16;
+    constexpr uint32_t NUMBER_OF_PUBLICATIONS = 100000;
+    using SharedT = SharedSensorFrame<NUMBER_OF_SENSORS>;
+    static SharedT shared;
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> tornReads{0};
+    std::atomic<uint32_t> reads{0};
+
+    std::thread reader([&]() {
+        SharedT::FrameT frame;
+        uint32_t lastPublication = 0;
+        while (!done.load()) {
+            const uint32_t publication = shared.read(frame);
+            if (publication < lastPublication) {
+                tornReads++;
+            }
+            lastPublication = publication;
+            const float* values = frame.getValues();
+            for (size_t i = 0; i < frame.getNumberOfSignals(); ++i) {
+                if (values[i] != values[0] ||
+                    frame.getTimeStamps()[i] != frame.getTimeStamps()[0]) {
+                    tornReads++;
+                    break;
+                }
+            }
+            reads++;
+        }
+    });
+
+    MeasurementList measurements;
+    for (size_t i = 0; i < ISensor::MAX_NUMBER_OF_DATA_POINTS; ++i) {
+        measurements.emplace_back(
+            core::MetaData(core::SHT4X()),
+            core::SignalType::TEMPERATURE_DEGREES_CELSIUS,
+            core::DataPoint{0, 0.0f});
+    }
+    for (uint32_t n = 1; n <= NUMBER_OF_PUBLICATIONS; ++n) {
+        for (auto& measurement : measurements) {
+            measurement.dataPoint = core::DataPoint{n, static_cast<float>(n)};
+        }
+        SharedT::FrameT& frame = shared.beginWrite();
+        frame.clear();
+        for (size_t s = 0; s < NUMBER_OF_SENSORS; ++s) {
+            frame.append(SensorKey{0, static_cast<uint8_t>(s)}, measurements);
+        }
+        shared.endWrite();
+    }
+    done = true;
+    reader.join();
+
+    TEST_ASSERT_EQUAL(NUMBER_OF_PUBLICATIONS,
+                      shared.getNumberOfPublications());
+    TEST_ASSERT_GREATER_THAN(0, reads.load());
+    TEST_ASSERT_EQUAL(0, tornReads.load());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fresh_readings_only_hold_new_readings);
+    RUN_TEST(test_subscriptions_are_notified_of_matching_readings);
+    RUN_TEST(test_subscriptions_are_bounded);
+    RUN_TEST(test_multi_bus_notifies_on_the_calling_thread);
+    RUN_TEST(test_history_drains_in_batches_across_wraparound);
+    RUN_TEST(test_history_drops_sensors_beyond_capacity);
+    RUN_TEST(test_history_drains_concurrently_with_record);
+    RUN_TEST(test_history_records_the_readings_of_the_manager);
+    RUN_TEST(test_shared_frame_equals_the_readings);
+    RUN_TEST(test_shared_frame_reads_are_never_torn);
+    return UNITY_END();
+}
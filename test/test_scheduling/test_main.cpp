@@ -0,0 +1,344 @@
+/*
+ * Scheduling of the sensor state machines on the simulated bus: deadline
+ * based wakeups, split-phase measurements, resumable initialization, the
+ * statistics of the sensor operations and the adaptive measurement interval.
+ */
+#include "Sensirion_upt_i2c_auto_detection.h"
+#include "DefaultDriverConfig.h"
+#include "SensorModels.h"
+#include <unity.h>
+
+using namespace sensirion::upt::i2c_autodetect;
+namespace core = sensirion::upt::core;
+
+namespace {
+
+// Timestamp of the readings of the index-th connected sensor, 0 before its
+// first readout
+unsigned long readoutTimeStampMs(SensorManager& manager,
+                                 const size_t index = 0) {
+    const SensorManager::MeasurementList*
+        readings[DefaultI2cDetector::CONFIGURED_SENSORS];
+    manager.getSensorReadings(readings);
+    if (!readings[index] || readings[index]->empty()) {
+        return 0;
+    }
+    return (*readings[index])[0].dataPoint.t_offset;
+}
+
+// Timestamp of the readings of the sensor of the given type, 0 before its
+// first readout
+unsigned long readoutTimeStampMs(SensorManager& manager,
+                                 const core::DeviceType& deviceType) {
+    const SensorManager::MeasurementList*
+        readings[DefaultI2cDetector::CONFIGURED_SENSORS];
+    manager.getSensorReadings(readings);
+    for (const auto* measurements : readings) {
+        if (measurements && !measurements->empty() &&
+            (*measurements)[0].metaData.deviceType == deviceType) {
+            return (*measurements)[0].dataPoint.t_offset;
+        }
+    }
+    return 0;
+}
+
+// Simulated duration of a call of executeSensorCommunication()
+uint64_t timedCommunicationUs(SensorManager& manager) {
+    const uint64_t startUs = host::nowMicros();
+    manager.executeSensorCommunication();
+    return host::nowMicros() - startUs;
+}
+
+// Sleep until the next update is due and perform it, as an application
+// would. Returns the duration of the update.
+uint64_t sleepAndCommunicate(SensorManager& manager) {
+    host::advanceMicros(manager.nextWakeupMs() * 1000ull);
+    const uint64_t durationUs = timedCommunicationUs(manager);
+    if (durationUs == 0) {
+        // Nothing was due after all, which would stall the simulated time
+        host::advanceMicros(1000);
+    }
+    return durationUs;
+}
+
+void runUntil(SensorManager& manager, const uint64_t untilUs) {
+    while (host::nowMicros() < untilUs) {
+        sleepAndCommunicate(manager);
+    }
+}
+
+uint32_t successCount(const SensorManager& manager, const SensorKey& key,
+                      const SensorOperation operation) {
+    const SensorStatistics* statistics = manager.getSensorStatistics(key);
+    TEST_ASSERT_NOT_NULL(statistics);
+    return (*statistics)[operation].successCount;
+}
+
+uint32_t fetchCount(const SensorManager& manager, const SensorKey& key) {
+    return successCount(manager, key, SensorOperation::FETCH_RESULT);
+}
+
+}  // namespace
+
+void setUp() {
+    host::resetClock();
+    Wire.resetStatistics();
+}
+
+void tearDown() {
+    for (uint8_t address = 0; address < 128; ++address) {
+        Wire.detachDevice(address);
+    }
+}
+
+void test_next_wakeup_without_sensors_is_bounded() {
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+
+    TEST_ASSERT_EQUAL(1000, manager.nextWakeupMs());
+}
+
+void test_no_bus_traffic_before_next_wakeup() {
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sht4x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+    manager.setInterval(1000, core::SHT4X());
+    manager.executeSensorCommunication();
+
+    const unsigned long wakeupMs = manager.nextWakeupMs();
+    TEST_ASSERT_GREATER_THAN(0, wakeupMs);
+    TEST_ASSERT_LESS_OR_EQUAL(1000, wakeupMs);
+
+    // Nothing is due before the wakeup
+    host::advanceMicros((wakeupMs - 1) * 1000ull);
+    Wire.resetStatistics();
+    const unsigned long timeStampMs = readoutTimeStampMs(manager);
+    manager.executeSensorCommunication();
+    TEST_ASSERT_EQUAL(0, Wire.getStatistics().transactions);
+    TEST_ASSERT_EQUAL(1, manager.nextWakeupMs());
+
+    // The update is due at the wakeup
+    host::advanceMicros(1000);
+    TEST_ASSERT_EQUAL(0, manager.nextWakeupMs());
+    manager.executeSensorCommunication();
+    manager.collectPendingMeasurements();
+    TEST_ASSERT_GREATER_THAN(0, Wire.getStatistics().transactions);
+    TEST_ASSERT_GREATER_THAN(timeStampMs, readoutTimeStampMs(manager));
+}
+
+// Update the state machine every 100 ms until the duration passed, returns
+// whether it was running before
+bool runningWithin(SensorStateMachine& ssm, const uint32_t durationMs) {
+    for (uint32_t elapsedMs = 0; elapsedMs < durationMs; elapsedMs += 100) {
+        ssm.update();
+        if (ssm.getSensorState() == SensorStatus::RUNNING) {
+            return true;
+        }
+        delay(100);
+    }
+    return false;
+}
+
+void test_initialization_interval_is_kept_after_boot_and_wraparound() {
+    // The SCD4x takes 12 s to deliver its first measurement
+    host::Scd4xModel scd4x;
+    Wire.attachDevice(scd4x);
+
+    for (const uint64_t startMs : {0ull, (1ull << 32) - 2000}) {
+        host::resetClock();
+        host::advanceMicros(startMs * 1000);
+        Scd4x sensor(Wire, 0x62);
+        SensorStateMachine ssm(&sensor, SensorKey{0, 0x62});
+        TEST_ASSERT_FALSE(runningWithin(ssm, 11000));
+        TEST_ASSERT_EQUAL(SensorStatus::INITIALIZING, ssm.getSensorState());
+        TEST_ASSERT_TRUE(runningWithin(ssm, 2000));
+    }
+}
+
+void test_split_phase_overlaps_conversions() {
+    // Conversion times of the models: SHT4x 8.3 ms, STC3x 66 ms
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+    manager.setInterval(1000, core::SHT4X());
+    runUntil(manager, 3000000);
+    manager.collectPendingMeasurements();
+
+    // Both sensors are due. The call only starts the measurements.
+    host::advanceMicros(2000000);
+    const unsigned long timeStampsMs[] = {readoutTimeStampMs(manager, 0),
+                                          readoutTimeStampMs(manager, 1)};
+    const uint64_t startUs = host::nowMicros();
+    TEST_ASSERT_LESS_THAN(8300, timedCommunicationUs(manager));
+    TEST_ASSERT_EQUAL(timeStampsMs[0], readoutTimeStampMs(manager, 0));
+    TEST_ASSERT_EQUAL(timeStampsMs[1], readoutTimeStampMs(manager, 1));
+
+    // The results are read out by the calls at the wakeups
+    while (readoutTimeStampMs(manager, 0) == timeStampsMs[0] ||
+           readoutTimeStampMs(manager, 1) == timeStampsMs[1]) {
+        TEST_ASSERT_LESS_THAN(startUs + 66000 + 8300, host::nowMicros());
+        sleepAndCommunicate(manager);
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(startUs + 66000, host::nowMicros());
+}
+
+void test_collect_pending_measurements_waits_for_the_results() {
+    host::Sht4xModel sht4x;
+    host::Stc3xModel stc3x;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(stc3x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+    manager.setInterval(1000, core::SHT4X());
+    runUntil(manager, 3000000);
+    manager.collectPendingMeasurements();
+
+    host::advanceMicros(2000000);
+    const unsigned long timeStampsMs[] = {readoutTimeStampMs(manager, 0),
+                                          readoutTimeStampMs(manager, 1)};
+    const uint64_t startUs = host::nowMicros();
+    manager.executeSensorCommunication();
+    manager.collectPendingMeasurements();
+    const uint64_t durationUs = host::nowMicros() - startUs;
+
+    TEST_ASSERT_GREATER_THAN(timeStampsMs[0], readoutTimeStampMs(manager, 0));
+    TEST_ASSERT_GREATER_THAN(timeStampsMs[1], readoutTimeStampMs(manager, 1));
+    TEST_ASSERT_GREATER_OR_EQUAL(66000, durationUs);
+    TEST_ASSERT_LESS_THAN(66000 + 8300, durationUs);
+
+    // Nothing is left to wait for
+    Wire.resetStatistics();
+    manager.collectPendingMeasurements();
+    TEST_ASSERT_EQUAL(0, Wire.getStatistics().transactions);
+}
+
+void test_resumable_initialization_attends_other_sensors() {
+    // The SEN66 waits 1.2 s after its reset
+    host::Sen66Model sen66;
+    host::Sht4xModel sht4x;
+    Wire.attachDevice(sen66);
+    Wire.attachDevice(sht4x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+
+    uint64_t longestCallUs = 0;
+    size_t sht4xReadouts = 0;
+    unsigned long sht4xTimeStampMs = 0;
+    while (host::nowMicros() < 1000000) {
+        const uint64_t durationUs = sleepAndCommunicate(manager);
+        longestCallUs = durationUs > longestCallUs ? durationUs : longestCallUs;
+        const unsigned long timeStampMs =
+            readoutTimeStampMs(manager, core::SHT4X());
+        sht4xReadouts += timeStampMs != sht4xTimeStampMs ? 1 : 0;
+        sht4xTimeStampMs = timeStampMs;
+    }
+    TEST_ASSERT_LESS_THAN(200000, longestCallUs);
+    TEST_ASSERT_GREATER_THAN(0, sht4xReadouts);
+    TEST_ASSERT_EQUAL(0, readoutTimeStampMs(manager, core::SEN66()));
+
+    runUntil(manager, 4000000);
+    TEST_ASSERT_GREATER_THAN(0, readoutTimeStampMs(manager, core::SEN66()));
+}
+
+void test_sensor_statistics_count_the_operations() {
+    host::Sht4xModel sht4x;
+    host::Sen66Model sen66;
+    Wire.attachDevice(sht4x);
+    Wire.attachDevice(sen66);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    runUntil(manager, 5000000);
+    manager.collectPendingMeasurements();
+
+    TEST_ASSERT_NULL(manager.getSensorStatistics(SensorKey{0, 0x45}));
+    const SensorStatistics* statistics =
+        manager.getSensorStatistics(SensorKey{0, 0x44});
+    TEST_ASSERT_NOT_NULL(statistics);
+    const OperationStatistics& trigger =
+        (*statistics)[SensorOperation::TRIGGER_MEASUREMENT];
+    const OperationStatistics& fetch =
+        (*statistics)[SensorOperation::FETCH_RESULT];
+    TEST_ASSERT_GREATER_THAN(0, fetch.successCount);
+    TEST_ASSERT_EQUAL(trigger.successCount, fetch.successCount);
+    TEST_ASSERT_EQUAL(0, fetch.errorCount);
+    TEST_ASSERT_EQUAL(fetch.successCount, fetch.latency.getCount());
+    // Reading two words with their CRCs takes 0.65 ms at 100 kHz
+    TEST_ASSERT_EQUAL(650, fetch.latency.getMaxUs());
+
+    // Failed triggers are counted separately
+    Wire.detachDevice(0x44);
+    runUntil(manager, 7000000);
+    TEST_ASSERT_GREATER_THAN(0, trigger.errorCount);
+    TEST_ASSERT_EQUAL(0, fetch.errorCount);
+
+    // The SEN66 is reset and then configured after its start-up time
+    TEST_ASSERT_GREATER_OR_EQUAL(
+        2, (*manager.getSensorStatistics(SensorKey{0, 0x6B}))
+               [SensorOperation::INITIALIZATION_STEP]
+                   .successCount);
+}
+
+void test_adaptive_interval_stretches_and_snaps_back() {
+    host::Environment environment;
+    environment.temperatureDegC = host::Waveform{20.0f, 0.0f, 0};
+    host::Sht4xModel sht4x(0x44, 0x12345678, environment);
+    Wire.attachDevice(sht4x);
+    DefaultI2cDetector detector(Wire);
+    SensorManager manager(detector);
+    manager.refreshConnectedSensors();
+    manager.executeSensorCommunication();
+
+    AdaptiveInterval adaptive;
+    adaptive.minIntervalMs = 1000;
+    adaptive.maxIntervalMs = 16000;
+    TEST_ASSERT_TRUE(
+        adaptive.setThreshold(core::SignalType::TEMPERATURE_DEGREES_CELSIUS,
+                              0.5f));
+    manager.setAdaptiveInterval(adaptive, core::SHT4X());
+
+    // Stable signals: after 1 + 2 + 4 + 8 s, the sensor is read every 16 s
+    runUntil(manager, 60000000);
+    const uint32_t stableFetches = fetchCount(manager, SensorKey{0, 0x44});
+    runUntil(manager, 60000000 + 32000000);
+    TEST_ASSERT_EQUAL(stableFetches + 2,
+                      fetchCount(manager, SensorKey{0, 0x44}));
+
+    // A step is seen at the next reading, which returns the interval to the
+    // minimum
+    environment.temperatureDegC.offset = 25.0f;
+    const uint32_t fetchesBeforeStep = fetchCount(manager, SensorKey{0, 0x44});
+    const uint64_t stepUs = host::nowMicros();
+    while (fetchCount(manager, SensorKey{0, 0x44}) == fetchesBeforeStep) {
+        TEST_ASSERT_LESS_THAN(stepUs + 16100000, host::nowMicros());
+        runUntil(manager, host::nowMicros() + 1);
+    }
+    runUntil(manager, host::nowMicros() + 1100000);
+    TEST_ASSERT_EQUAL(fetchesBeforeStep + 2,
+                      fetchCount(manager, SensorKey{0, 0x44}));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_next_wakeup_without_sensors_is_bounded);
+    RUN_TEST(test_no_bus_traffic_before_next_wakeup);
+    RUN_TEST(test_initialization_interval_is_kept_after_boot_and_wraparound);
+    RUN_TEST(test_split_phase_overlaps_conversions);
+    RUN_TEST(test_collect_pending_measurements_waits_for_the_results);
+    RUN_TEST(test_resumable_initialization_attends_other_sensors);
+    RUN_TEST(test_sensor_statistics_count_the_operations);
+    RUN_TEST(test_adaptive_interval_stretches_and_snaps_back);
+    return UNITY_END();
+}